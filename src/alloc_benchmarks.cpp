@@ -0,0 +1,122 @@
+#include <benchmark/benchmark.h>
+
+#include "test_utils.h"
+#include "tokens.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+
+// The benchmarks that count allocations. They are a target of their own
+// because counting replaces the global operator new, which would add an
+// atomic increment to every allocation of every other benchmark.
+
+// Count the allocations made through the global operator new, so benchmarks
+// can report the allocations per call. Not inlined: gcc would otherwise see
+// `free` called on memory from `operator new` and warn.
+static std::atomic<std::size_t> allocationCount{0};
+
+[[gnu::noinline]] void*
+operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+[[gnu::noinline]] void
+operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+#if !defined(_MSC_VER) && !defined(XRPL_B58_PORTABLE)
+// The legacy string interface, returning a `std::string` or (`Inline`) a
+// `Base58String`
+template <bool Inline>
+static void
+BM_string_encode(benchmark::State& state)
+{
+    constexpr std::size_t numToEncode = 256;
+    std::vector<std::array<std::uint8_t, 20>> accounts(numToEncode);
+    std::uniform_int_distribution<std::uint8_t> dist(0, 255);
+    for (auto& a : accounts)
+        std::generate(a.begin(), a.end(), [&] { return dist(randEngine()); });
+    auto const before = allocationCount.load();
+    for (auto _ : state)
+    {
+        for (auto const& a : accounts)
+        {
+            if constexpr (Inline)
+            {
+                auto r = ripple::b58_fast::encodeBase58TokenInline(
+                    ripple::TokenType::AccountID, a.data(), a.size());
+                benchmark::DoNotOptimize(r);
+            }
+            else
+            {
+                auto r = ripple::b58_fast::encodeBase58Token(
+                    ripple::TokenType::AccountID, a.data(), a.size());
+                benchmark::DoNotOptimize(r);
+            }
+        }
+    }
+    auto const calls = state.iterations() * numToEncode;
+    auto const allocs = allocationCount.load() - before;
+    state.counters["allocs_per_call"] = double(allocs) / double(calls);
+    if (Inline && allocs != 0)
+        state.SkipWithError("the inline interface allocated");
+    state.SetItemsProcessed(calls);
+}
+BENCHMARK_TEMPLATE(BM_string_encode, false);
+BENCHMARK_TEMPLATE(BM_string_encode, true);
+
+template <bool Inline>
+static void
+BM_string_decode(benchmark::State& state)
+{
+    constexpr std::size_t numToDecode = 256;
+    auto const tokens = account_id_tokens(numToDecode);
+    auto const before = allocationCount.load();
+    for (auto _ : state)
+    {
+        for (auto const& s : tokens)
+        {
+            if constexpr (Inline)
+            {
+                auto r = ripple::b58_fast::decodeBase58TokenInline(
+                    s, ripple::TokenType::AccountID);
+                benchmark::DoNotOptimize(r);
+            }
+            else
+            {
+                auto r = ripple::b58_fast::decodeBase58Token(
+                    s, ripple::TokenType::AccountID);
+                benchmark::DoNotOptimize(r);
+            }
+        }
+    }
+    auto const calls = state.iterations() * numToDecode;
+    auto const allocs = allocationCount.load() - before;
+    state.counters["allocs_per_call"] = double(allocs) / double(calls);
+    if (Inline && allocs != 0)
+        state.SkipWithError("the inline interface allocated");
+    state.SetItemsProcessed(calls);
+}
+BENCHMARK_TEMPLATE(BM_string_decode, false);
+BENCHMARK_TEMPLATE(BM_string_decode, true);
+#endif
+
+BENCHMARK_MAIN();
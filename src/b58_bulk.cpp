@@ -0,0 +1,390 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <b58_bulk.h>
+
+#include <boost/outcome/success_failure.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if !defined(_MSC_VER) && !defined(XRPL_B58_PORTABLE)
+namespace ripple {
+namespace b58_fast {
+
+namespace {
+
+// The lines of a chunk, without "\n" or "\r\n"
+std::vector<std::string_view>
+split_lines(std::string_view data)
+{
+    std::vector<std::string_view> lines;
+    lines.reserve(std::count(data.begin(), data.end(), '\n'));
+    while (!data.empty())
+    {
+        auto const nl = data.find('\n');
+        auto line = data.substr(0, nl);
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        lines.push_back(line);
+        data.remove_prefix(nl + 1);
+    }
+    return lines;
+}
+
+int
+hex_digit(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+TokenCodecErrc
+parse_hex(std::string_view hex, std::span<std::uint8_t> out)
+{
+    if (hex.size() < 2 * out.size())
+        return TokenCodecErrc::InputTooSmall;
+    if (hex.size() > 2 * out.size())
+        return TokenCodecErrc::InputTooLarge;
+    for (std::size_t i = 0; i < out.size(); ++i)
+    {
+        int const hi = hex_digit(hex[2 * i]);
+        int const lo = hex_digit(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0)
+            return TokenCodecErrc::InvalidEncodingChar;
+        out[i] = hi << 4 | lo;
+    }
+    return TokenCodecErrc::Success;
+}
+
+void
+append_hex(std::string& out, std::span<std::uint8_t const> bytes)
+{
+    constexpr char digits[] = "0123456789abcdef";
+    for (auto b : bytes)
+    {
+        out.push_back(digits[b >> 4]);
+        out.push_back(digits[b & 15]);
+    }
+}
+
+Result<BulkChunkResult>
+encode_chunk(BulkOptions const& o, BulkChunk const& chunk)
+{
+    BulkChunkResult result;
+    std::size_t const stride = o.stride;
+    auto const bytes = reinterpret_cast<std::uint8_t const*>(chunk.data.data());
+
+    std::vector<std::uint8_t> parsed;
+    std::vector<TokenCodecErrc> statuses;
+    std::vector<std::span<std::uint8_t const>> inputs;
+    if (o.inFormat == BulkFormat::raw)
+    {
+        std::size_t const n = chunk.data.size() / stride;
+        statuses.assign(n, TokenCodecErrc::Success);
+        inputs.reserve(n);
+        for (std::size_t i = 0; i < n; ++i)
+            inputs.emplace_back(bytes + i * stride, stride);
+    }
+    else
+    {
+        auto const lines = split_lines(chunk.data);
+        parsed.resize(lines.size() * stride);
+        statuses.resize(lines.size());
+        inputs.reserve(lines.size());
+        for (std::size_t i = 0; i < lines.size(); ++i)
+        {
+            std::span<std::uint8_t> payload(&parsed[i * stride], stride);
+            statuses[i] = parse_hex(lines[i], payload);
+            if (statuses[i] == TokenCodecErrc::Success)
+                inputs.push_back(payload);
+        }
+    }
+
+    std::vector<std::uint8_t> arena(
+        inputs.size() * encodedSizeUpperBound(stride));
+    std::vector<std::span<std::uint8_t>> tokens(inputs.size());
+    auto const r = encodeBase58TokenBatch(o.type, inputs, arena, tokens);
+    if (!r)
+        return boost::outcome_v2::failure(r.error());
+
+    result.records = statuses.size();
+    result.out.reserve(r.value().size() + statuses.size());
+    auto token = tokens.begin();
+    for (auto status : statuses)
+    {
+        if (status == TokenCodecErrc::Success)
+        {
+            result.out.append(token->begin(), token->end());
+            ++token;
+        }
+        else
+            result.fail(status);
+        result.out.push_back('\n');
+    }
+    return result;
+}
+
+// Decode or validate
+Result<BulkChunkResult>
+decode_chunk(BulkOptions const& o, BulkChunk const& chunk)
+{
+    BulkChunkResult result;
+    std::size_t const stride = o.stride;
+    auto const lines = split_lines(chunk.data);
+    std::vector<TokenType> types(lines.size(), o.type);
+    std::size_t arena_size = 0;
+    for (auto const& line : lines)
+        arena_size += decodedSizeUpperBound(line.size());
+    std::vector<std::uint8_t> arena(arena_size);
+    std::vector<std::span<std::uint8_t>> payloads(lines.size());
+    std::vector<TokenCodecErrc> statuses(lines.size());
+    auto const r =
+        decodeBase58TokenBatch(types, lines, arena, payloads, statuses);
+    if (!r)
+        return boost::outcome_v2::failure(r.error());
+
+    result.records = lines.size();
+    if (o.command == BulkCommand::decode)
+        result.out.reserve(
+            lines.size() *
+            (o.outFormat == BulkFormat::raw ? stride : 2 * stride + 1));
+    for (std::size_t i = 0; i < lines.size(); ++i)
+    {
+        auto status = statuses[i];
+        if (status == TokenCodecErrc::Success && payloads[i].size() != stride)
+            status = payloads[i].size() < stride
+                ? TokenCodecErrc::InputTooSmall
+                : TokenCodecErrc::InputTooLarge;
+        if (status != TokenCodecErrc::Success)
+            result.fail(status);
+
+        if (o.command == BulkCommand::validate)
+        {
+            if (status != TokenCodecErrc::Success)
+            {
+                result.out += std::to_string(chunk.first + i + 1);
+                result.out += '\t';
+                result.out += make_error_code(status).message();
+                result.out += '\n';
+            }
+        }
+        else if (o.outFormat == BulkFormat::raw)
+        {
+            if (status == TokenCodecErrc::Success)
+                result.out.append(payloads[i].begin(), payloads[i].end());
+            else
+                result.out.append(stride, '\0');
+        }
+        else
+        {
+            if (status == TokenCodecErrc::Success)
+                append_hex(result.out, payloads[i]);
+            result.out.push_back('\n');
+        }
+    }
+    return result;
+}
+
+// A fixed set of threads that run chunk conversions
+class WorkerPool
+{
+public:
+    using Task = std::packaged_task<Result<BulkChunkResult>()>;
+
+    explicit WorkerPool(unsigned threads)
+    {
+        for (unsigned i = 0; i < threads; ++i)
+            threads_.emplace_back([this] { run(); });
+    }
+
+    WorkerPool(WorkerPool const&) = delete;
+    WorkerPool&
+    operator=(WorkerPool const&) = delete;
+
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : threads_)
+            t.join();
+    }
+
+    template <class F>
+    std::future<Result<BulkChunkResult>>
+    submit(F&& f)
+    {
+        Task task(std::forward<F>(f));
+        auto future = task.get_future();
+        {
+            std::lock_guard lock(mutex_);
+            tasks_.push_back(std::move(task));
+        }
+        cv_.notify_one();
+        return future;
+    }
+
+private:
+    void
+    run()
+    {
+        for (;;)
+        {
+            Task task;
+            {
+                std::unique_lock lock(mutex_);
+                cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+                if (tasks_.empty())
+                    return;
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Task> tasks_;
+    bool stop_ = false;
+    std::vector<std::thread> threads_;
+};
+
+}  // namespace
+
+BulkChunkReader::BulkChunkReader(Source source, BulkOptions const& o)
+    : source_(std::move(source))
+    , raw_(o.inFormat == BulkFormat::raw)
+    , stride_(o.stride)
+    , blockSize_(o.chunkTokens * (raw_ ? o.stride : 64))
+{
+}
+
+Result<std::optional<BulkChunk>>
+BulkChunkReader::next()
+{
+    BulkChunk chunk;
+    chunk.first = records_;
+    chunk.data = std::move(carry_);
+    carry_.clear();
+    if (raw_)
+    {
+        chunk.data.resize(blockSize_);
+        chunk.data.resize(source_(chunk.data.data(), blockSize_));
+        if (chunk.data.size() % stride_)
+            return boost::outcome_v2::failure(TokenCodecErrc::InputTooSmall);
+        records_ += chunk.data.size() / stride_;
+        if (chunk.data.empty())
+            return boost::outcome_v2::success(std::optional<BulkChunk>());
+        return boost::outcome_v2::success(std::optional(std::move(chunk)));
+    }
+
+    // Read until the chunk holds at least one whole line
+    std::size_t end = chunk.data.npos;
+    while (!eof_ && end == chunk.data.npos)
+    {
+        auto const used = chunk.data.size();
+        chunk.data.resize(used + blockSize_);
+        auto const n = source_(chunk.data.data() + used, blockSize_);
+        chunk.data.resize(used + n);
+        eof_ = n < blockSize_;
+        end = chunk.data.rfind('\n');
+    }
+    if (!eof_)
+        carry_.assign(chunk.data, end + 1);
+    else if (!chunk.data.empty() && chunk.data.back() != '\n')
+        chunk.data.push_back('\n');
+    chunk.data.resize(chunk.data.size() - carry_.size());
+    records_ += std::count(chunk.data.begin(), chunk.data.end(), '\n');
+    if (chunk.data.empty())
+        return boost::outcome_v2::success(std::optional<BulkChunk>());
+    return boost::outcome_v2::success(std::optional(std::move(chunk)));
+}
+
+Result<BulkChunkResult>
+convertBulkChunk(BulkOptions const& o, BulkChunk const& chunk)
+{
+    auto r = o.command == BulkCommand::encode ? encode_chunk(o, chunk)
+                                              : decode_chunk(o, chunk);
+    if (r)
+        r.value().bytesIn = chunk.data.size();
+    return r;
+}
+
+Result<void>
+convertBulk(
+    BulkChunkReader& reader,
+    BulkOptions const& o,
+    unsigned threads,
+    std::function<void(BulkChunkResult const&)> const& sink)
+{
+    threads = std::max(threads, 1u);
+    WorkerPool pool(threads);
+    std::deque<std::future<Result<BulkChunkResult>>> inFlight;
+    auto sink_oldest = [&]() -> Result<void> {
+        auto const result = inFlight.front().get();
+        inFlight.pop_front();
+        if (!result)
+            return boost::outcome_v2::failure(result.error());
+        sink(result.value());
+        return boost::outcome_v2::success();
+    };
+    for (;;)
+    {
+        auto chunk = reader.next();
+        if (!chunk)
+            return boost::outcome_v2::failure(chunk.error());
+        if (!chunk.value())
+            break;
+        inFlight.push_back(
+            pool.submit([&o, chunk = std::move(*chunk.value())] {
+                return convertBulkChunk(o, chunk);
+            }));
+        if (inFlight.size() >= 2 * threads)
+        {
+            if (auto const r = sink_oldest(); !r)
+                return r;
+        }
+    }
+    while (!inFlight.empty())
+    {
+        if (auto const r = sink_oldest(); !r)
+            return r;
+    }
+    return boost::outcome_v2::success();
+}
+
+}  // namespace b58_fast
+}  // namespace ripple
+#endif
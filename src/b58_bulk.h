@@ -0,0 +1,162 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_PROTOCOL_B58_BULK_H_INCLUDED
+#define RIPPLE_PROTOCOL_B58_BULK_H_INCLUDED
+
+#include <token_errors.h>
+#include <tokens.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+
+// The conversions of the xrpl-b58 tool: a stream of records is cut into
+// chunks of whole records, the chunks are converted on a pool of threads
+// with the batch codecs, and the results come out in input order.
+#if !defined(_MSC_VER) && !defined(XRPL_B58_PORTABLE)
+namespace ripple {
+namespace b58_fast {
+
+/** What a bulk conversion does with each record */
+enum class BulkCommand : std::uint8_t {
+    // payloads (raw or hex) to base 58 lines
+    encode,
+    // base 58 lines to payloads (hex lines or raw)
+    decode,
+    // base 58 lines to "<line>\t<error>" for every bad token
+    validate
+};
+
+/** How the records of a bulk conversion are stored
+
+    `raw` records are `stride` bytes each; the others are one per line,
+    ending in "\n" or "\r\n".
+*/
+enum class BulkFormat : std::uint8_t { raw, hex, b58 };
+
+struct BulkOptions
+{
+    BulkCommand command = BulkCommand::encode;
+    TokenType type = TokenType::AccountID;
+    BulkFormat inFormat = BulkFormat::raw;
+    BulkFormat outFormat = BulkFormat::b58;
+    // Payload size in bytes, at most 33
+    std::size_t stride = 20;
+    // Records per chunk (about, for lines)
+    std::size_t chunkTokens = 1 << 14;
+};
+
+// Number of `TokenCodecErrc` values
+constexpr std::size_t numTokenCodecErrc =
+    static_cast<std::size_t>(TokenCodecErrc::Unknown) + 1;
+
+/** Whole records (raw) or whole lines (hex and b58) of the input */
+struct BulkChunk
+{
+    std::string data;
+    // Index of the first record of the chunk in the input
+    std::uint64_t first = 0;
+};
+
+/** The output of a chunk and what went wrong with its records
+
+    A record that fails converts to an empty line (hex and b58 output) or
+    `stride` zero bytes (raw output), so the output keeps one record per
+    input record. `validate` writes only the failures.
+*/
+struct BulkChunkResult
+{
+    std::string out;
+    std::uint64_t records = 0;
+    std::uint64_t bytesIn = 0;
+    std::array<std::uint64_t, numTokenCodecErrc> failures{};
+
+    void
+    fail(TokenCodecErrc e)
+    {
+        ++failures[static_cast<std::size_t>(e)];
+    }
+};
+
+/** Cuts an input into chunks of about `chunkTokens` records
+
+    A line that doesn't fit in a read is carried over to the next chunk, and
+    a last line without a newline gets one.
+*/
+class BulkChunkReader
+{
+public:
+    /** Read up to `size` bytes into `data`; fewer only at the end of the
+        input
+    */
+    using Source = std::function<std::size_t(char* data, std::size_t size)>;
+
+    BulkChunkReader(Source source, BulkOptions const& o);
+
+    /** The next chunk, or nothing at the end of the input
+
+        Fails with `InputTooSmall` if raw input ends in a partial record.
+    */
+    [[nodiscard]] Result<std::optional<BulkChunk>>
+    next();
+
+private:
+    Source source_;
+    bool const raw_;
+    std::size_t const stride_;
+    std::size_t const blockSize_;
+    // The start of a line that didn't fit in the last chunk
+    std::string carry_;
+    std::uint64_t records_ = 0;
+    bool eof_ = false;
+};
+
+/** Convert one chunk with the batch codecs
+
+    Fails only if the batch codecs do; bad records are counted in the
+    result.
+*/
+[[nodiscard]] Result<BulkChunkResult>
+convertBulkChunk(BulkOptions const& o, BulkChunk const& chunk);
+
+/** Convert every chunk of `reader` on `threads` threads
+
+    The results are passed to `sink` in input order, on the calling thread.
+    A few more chunks than there are threads are in flight, so every thread
+    stays busy while the oldest chunk is written.
+
+    @return the first error of the reader or the batch codecs, if any. The
+            chunks before it have been passed to `sink`.
+*/
+[[nodiscard]] Result<void>
+convertBulk(
+    BulkChunkReader& reader,
+    BulkOptions const& o,
+    unsigned threads,
+    std::function<void(BulkChunkResult const&)> const& sink);
+
+}  // namespace b58_fast
+}  // namespace ripple
+#endif
+
+#endif
@@ -0,0 +1,626 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <b58_cache.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <vector>
+
+#if !defined(_MSC_VER) && !defined(XRPL_B58_PORTABLE)
+namespace ripple {
+namespace b58_fast {
+
+namespace {
+
+// Tokens longer than this are never cached; they are longer than any token
+// with a fixed payload size
+constexpr std::size_t maxTokenChars = 52;
+
+constexpr std::size_t valueWords = 5;
+constexpr std::size_t maxValueSize = valueWords * 8;
+
+}  // namespace
+
+struct DecodeCache::Entry
+{
+    // Odd while the entry is being written
+    std::atomic<std::uint64_t> seq{0};
+    std::array<std::atomic<std::uint64_t>, std::tuple_size_v<Key>> key{};
+    std::array<std::atomic<std::uint64_t>, valueWords> value{};
+    std::atomic<std::uint8_t> size{0};
+    // CLOCK bit, set by hits
+    std::atomic<std::uint8_t> referenced{0};
+};
+
+// The tags of a set share a cache line, so a lookup reads the entries only
+// when a tag matches
+struct alignas(64) DecodeCache::Set
+{
+    // Hash of the key of each entry; zero if the entry is empty
+    std::array<std::atomic<std::uint64_t>, ways> tags{};
+    std::array<Entry, ways> entries;
+    // Guarded by the lock of the set's shard
+    std::uint8_t hand = 0;
+};
+
+struct alignas(64) DecodeCache::Shard
+{
+    std::mutex mutex;
+    std::atomic<std::uint64_t> hits{0};
+    std::atomic<std::uint64_t> misses{0};
+    std::atomic<std::uint64_t> insertions{0};
+    std::atomic<std::uint64_t> evictions{0};
+};
+
+namespace {
+
+// Pack a key into words. Returns false for strings that can't decode.
+//
+// Keys and values are only ever moved a whole word at a time, so a hit
+// doesn't stall on loads that span several smaller stores.
+template <class Key>
+bool
+pack_key(TokenType type, std::string_view s, Key& key)
+{
+    static_assert(sizeof(Key) >= 8 + maxTokenChars);
+    if (s.empty() || s.size() > maxTokenChars)
+        return false;
+    key.fill(0);
+    key[0] = static_cast<std::uint8_t>(type) | s.size() << 8;
+    std::size_t i = 0;
+    for (; i + 8 <= s.size(); i += 8)
+        std::memcpy(&key[1 + i / 8], s.data() + i, 8);
+    std::uint64_t tail = 0;
+    for (std::size_t j = i; j < s.size(); ++j)
+        tail |= std::uint64_t(static_cast<std::uint8_t>(s[j])) << 8 * (j - i);
+    key[1 + i / 8] |= tail;
+    return true;
+}
+
+std::uint64_t
+hash_mix(std::uint64_t h, std::uint64_t word)
+{
+    return std::rotl((h ^ word) * 0x9e3779b97f4a7c15ull, 29);
+}
+
+std::uint64_t
+hash_finish(std::uint64_t h)
+{
+    h ^= h >> 32;
+    h *= 0xd6e8feb86659fd93ull;
+    h ^= h >> 32;
+    return h;
+}
+
+// Only the words that hold characters contribute; the rest are zero
+template <class Key>
+std::uint64_t
+hash_key(Key const& key, std::size_t size)
+{
+    std::size_t const words = 1 + (size + 7) / 8;
+    std::uint64_t h = 0;
+    for (std::size_t i = 0; i < words; ++i)
+        h = hash_mix(h, key[i]);
+    return hash_finish(h);
+}
+
+// Copy the first `size` bytes of `words` to `out`
+void
+copy_words(std::uint64_t const* words, std::size_t size, std::uint8_t* out)
+{
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+        std::memcpy(out + i, &words[i / 8], 8);
+    if (i == size)
+        return;
+    std::array<std::uint8_t, 8> tail;
+    std::memcpy(tail.data(), &words[i / 8], 8);
+    for (std::size_t j = 0; i + j < size; ++j)
+        out[i + j] = tail[j];
+}
+
+}  // namespace
+
+DecodeCache::DecodeCache(std::size_t capacity, std::size_t shards)
+{
+    std::size_t const sets =
+        std::bit_ceil(std::max<std::size_t>(1, (capacity + ways - 1) / ways));
+    set_mask_ = sets - 1;
+    shard_mask_ =
+        std::min(std::bit_ceil(std::max<std::size_t>(1, shards)), sets) - 1;
+    sets_ = std::make_unique<Set[]>(sets);
+    shards_ = std::make_unique<Shard[]>(shard_mask_ + 1);
+}
+
+DecodeCache::~DecodeCache() = default;
+
+DecodeCache::Shard&
+DecodeCache::shard_of(std::size_t set) const
+{
+    return shards_[set & shard_mask_];
+}
+
+std::span<std::uint8_t>
+DecodeCache::lookup(
+    std::size_t set,
+    std::uint64_t tag,
+    Key const& key,
+    std::span<std::uint8_t> outBuf)
+{
+    Set& entries = sets_[set];
+    for (std::size_t w = 0; w < ways; ++w)
+    {
+        if (entries.tags[w].load(std::memory_order_relaxed) != tag)
+            continue;
+
+        Entry& e = entries.entries[w];
+        auto const seq = e.seq.load(std::memory_order_acquire);
+        if (seq & 1)
+            return {};
+        bool same = true;
+        for (std::size_t i = 0; i < key.size(); ++i)
+            same &= e.key[i].load(std::memory_order_relaxed) == key[i];
+        std::array<std::uint64_t, valueWords> value;
+        for (std::size_t i = 0; i < valueWords; ++i)
+            value[i] = e.value[i].load(std::memory_order_relaxed);
+        std::size_t const size = e.size.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (e.seq.load(std::memory_order_relaxed) != seq)
+            return {};
+        if (!same)
+            continue;
+
+        if (!e.referenced.load(std::memory_order_relaxed))
+            e.referenced.store(1, std::memory_order_relaxed);
+
+        if (size > outBuf.size())
+            return {};
+        copy_words(value.data(), size, outBuf.data());
+        return outBuf.first(size);
+    }
+    return {};
+}
+
+void
+DecodeCache::insert(
+    std::size_t set,
+    std::uint64_t tag,
+    Key const& key,
+    std::span<std::uint8_t const> decoded)
+{
+    // A hit returns the decoded bytes; an empty result would read as a miss
+    if (decoded.empty() || decoded.size() > maxValueSize)
+        return;
+
+    Shard& shard = shard_of(set);
+    std::lock_guard lock(shard.mutex);
+
+    Set& entries = sets_[set];
+    // Another thread may have inserted the token since our lookup
+    for (std::size_t w = 0; w < ways; ++w)
+    {
+        if (entries.tags[w].load(std::memory_order_relaxed) != tag)
+            continue;
+        Entry& e = entries.entries[w];
+        bool same = true;
+        for (std::size_t i = 0; i < key.size(); ++i)
+            same &= e.key[i].load(std::memory_order_relaxed) == key[i];
+        if (same)
+            return;
+    }
+
+    // Fill an empty entry if there is one, otherwise run the CLOCK hand until
+    // it finds an entry that wasn't hit since it last passed.
+    std::size_t victim = 0;
+    while (victim < ways &&
+           entries.tags[victim].load(std::memory_order_relaxed) != 0)
+        ++victim;
+    if (victim == ways)
+    {
+        for (;;)
+        {
+            Entry& e = entries.entries[entries.hand];
+            victim = entries.hand;
+            entries.hand = (entries.hand + 1) % ways;
+            if (!e.referenced.exchange(0, std::memory_order_relaxed))
+                break;
+        }
+        shard.evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::array<std::uint64_t, valueWords> value{};
+    std::memcpy(value.data(), decoded.data(), decoded.size());
+
+    Entry& e = entries.entries[victim];
+    auto const seq = e.seq.load(std::memory_order_relaxed);
+    e.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    entries.tags[victim].store(tag, std::memory_order_relaxed);
+    for (std::size_t i = 0; i < key.size(); ++i)
+        e.key[i].store(key[i], std::memory_order_relaxed);
+    for (std::size_t i = 0; i < valueWords; ++i)
+        e.value[i].store(value[i], std::memory_order_relaxed);
+    e.size.store(decoded.size(), std::memory_order_relaxed);
+    e.referenced.store(0, std::memory_order_relaxed);
+    e.seq.store(seq + 2, std::memory_order_release);
+
+    shard.insertions.fetch_add(1, std::memory_order_relaxed);
+}
+
+Result<std::span<std::uint8_t>>
+DecodeCache::decode(
+    TokenType type,
+    std::string_view s,
+    std::span<std::uint8_t> outBuf)
+{
+    Key key;
+    if (!pack_key(type, s, key))
+        return decodeBase58Token(type, s, outBuf);
+
+    std::uint64_t const hash = hash_key(key, s.size());
+    std::size_t const set = (hash >> 16) & set_mask_;
+    std::uint64_t const tag = hash | 1;
+    Shard& shard = shard_of(set);
+    if (auto const r = lookup(set, tag, key, outBuf); !r.empty())
+    {
+        shard.hits.fetch_add(1, std::memory_order_relaxed);
+        return r;
+    }
+    shard.misses.fetch_add(1, std::memory_order_relaxed);
+
+    // Decode into a buffer that is always large enough, so the token is
+    // cached even if `outBuf` is too small for it
+    std::array<std::uint8_t, maxTokenChars> buf;
+    auto const r = decodeBase58Token(type, s, buf);
+    if (!r)
+        return r;
+    insert(set, tag, key, r.value());
+
+    if (r.value().size() > outBuf.size())
+        return boost::outcome_v2::failure(TokenCodecErrc::OutputTooSmall);
+    std::copy(r.value().begin(), r.value().end(), outBuf.begin());
+    return boost::outcome_v2::success(outBuf.first(r.value().size()));
+}
+
+std::span<std::uint8_t>
+DecodeCache::find(
+    TokenType type,
+    std::string_view s,
+    std::span<std::uint8_t> outBuf)
+{
+    Key key;
+    if (!pack_key(type, s, key))
+        return {};
+
+    std::uint64_t const hash = hash_key(key, s.size());
+    std::size_t const set = (hash >> 16) & set_mask_;
+    auto const r = lookup(set, hash | 1, key, outBuf);
+    (r.empty() ? shard_of(set).misses : shard_of(set).hits)
+        .fetch_add(1, std::memory_order_relaxed);
+    return r;
+}
+
+void
+DecodeCache::clear()
+{
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(shard_mask_ + 1);
+    for (std::size_t i = 0; i <= shard_mask_; ++i)
+        locks.emplace_back(shards_[i].mutex);
+
+    for (std::size_t set = 0; set <= set_mask_; ++set)
+    {
+        Set& entries = sets_[set];
+        for (std::size_t w = 0; w < ways; ++w)
+        {
+            if (entries.tags[w].load(std::memory_order_relaxed) == 0)
+                continue;
+            Entry& e = entries.entries[w];
+            auto const seq = e.seq.load(std::memory_order_relaxed);
+            e.seq.store(seq + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            entries.tags[w].store(0, std::memory_order_relaxed);
+            e.key[0].store(0, std::memory_order_relaxed);
+            e.referenced.store(0, std::memory_order_relaxed);
+            e.seq.store(seq + 2, std::memory_order_release);
+        }
+        entries.hand = 0;
+    }
+}
+
+DecodeCache::Stats
+DecodeCache::stats() const
+{
+    Stats result;
+    for (std::size_t i = 0; i <= shard_mask_; ++i)
+    {
+        Shard const& shard = shards_[i];
+        result.hits += shard.hits.load(std::memory_order_relaxed);
+        result.misses += shard.misses.load(std::memory_order_relaxed);
+        result.insertions += shard.insertions.load(std::memory_order_relaxed);
+        result.evictions += shard.evictions.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+std::size_t
+DecodeCache::capacity() const
+{
+    return (set_mask_ + 1) * ways;
+}
+
+namespace {
+
+// Header of an encode cache entry: the sequence counter (low 32 bits, odd
+// while the entry is being written), the type (next 8 bits) and the size of
+// the encoded token (next 8 bits; zero if the entry is empty)
+constexpr std::uint64_t seqMask = 0xffff'ffff;
+
+std::uint64_t
+make_header(std::uint64_t seq, TokenType type, std::size_t size)
+{
+    return (seq & seqMask) | std::uint64_t(type) << 32 |
+        std::uint64_t(size) << 40;
+}
+
+TokenType
+header_type(std::uint64_t header)
+{
+    return static_cast<TokenType>((header >> 32) & 0xff);
+}
+
+std::size_t
+header_size(std::uint64_t header)
+{
+    return (header >> 40) & 0xff;
+}
+
+// The payload in words, the last one padded with zeros
+template <std::size_t N>
+std::array<std::uint64_t, (N + 7) / 8>
+payload_words(std::array<std::uint8_t, N> const& payload)
+{
+    std::array<std::uint64_t, (N + 7) / 8> words{};
+    for (std::size_t i = 0; i < N / 8; ++i)
+        std::memcpy(&words[i], payload.data() + i * 8, 8);
+    if constexpr (N % 8 != 0)
+        std::memcpy(&words[N / 8], payload.data() + N / 8 * 8, N % 8);
+    return words;
+}
+
+template <std::size_t W>
+std::uint64_t
+hash_payload(TokenType type, std::array<std::uint64_t, W> const& key)
+{
+    std::uint64_t h = static_cast<std::uint8_t>(type);
+    for (auto const word : key)
+        h = hash_mix(h, word);
+    return hash_finish(h);
+}
+
+// Compare the payload at the start of an entry's data with `key`. The last
+// word of the payload may also hold the first characters of the token.
+template <std::size_t N, std::size_t D>
+bool
+payload_matches(
+    std::array<std::uint64_t, D> const& data,
+    std::array<std::uint64_t, (N + 7) / 8> const& key)
+{
+    bool same = true;
+    for (std::size_t i = 0; i < N / 8; ++i)
+        same &= data[i] == key[i];
+    if constexpr (N % 8 != 0)
+    {
+        std::array<std::uint8_t, 8> maskBytes{};
+        std::fill_n(maskBytes.begin(), N % 8, 0xff);
+        auto const mask = std::bit_cast<std::uint64_t>(maskBytes);
+        same &= (data[N / 8] & mask) == key[N / 8];
+    }
+    return same;
+}
+
+// Copy the `size` characters that follow the payload in an entry's data to
+// `out`
+template <std::size_t N, std::size_t D>
+void
+copy_chars(
+    std::array<std::uint64_t, D> const& data,
+    std::size_t size,
+    std::uint8_t* out)
+{
+    if constexpr (N % 8 == 0)
+    {
+        copy_words(&data[N / 8], size, out);
+    }
+    else if constexpr (std::endian::native == std::endian::little)
+    {
+        // Realign the characters in registers
+        constexpr unsigned shift = N % 8 * 8;
+        std::array<std::uint64_t, D - N / 8> chars;
+        for (std::size_t i = 0; i < chars.size(); ++i)
+        {
+            std::size_t const w = N / 8 + i;
+            chars[i] = data[w] >> shift |
+                (w + 1 < D ? data[w + 1] << (64 - shift) : 0);
+        }
+        copy_words(chars.data(), size, out);
+    }
+    else
+    {
+        auto const bytes =
+            std::bit_cast<std::array<std::uint8_t, D * 8>>(data);
+        std::memcpy(out, bytes.data() + N, size);
+    }
+}
+
+}  // namespace
+
+template <std::size_t N>
+struct alignas(64) EncodeCache<N>::Entry
+{
+    static constexpr std::size_t maxChars = encodedSizeUpperBound(N);
+    static constexpr std::size_t dataWords = (N + maxChars + 7) / 8;
+
+    // See `make_header`
+    std::atomic<std::uint64_t> header{0};
+    // The payload, then the encoded token
+    std::array<std::atomic<std::uint64_t>, dataWords> data{};
+};
+
+template <std::size_t N>
+EncodeCache<N>::EncodeCache(std::size_t bytes)
+{
+    static_assert(N > 20 || sizeof(Entry) == 64);
+    std::size_t const entries =
+        std::bit_floor(std::max(bytes / sizeof(Entry), probes));
+    mask_ = entries - 1;
+    entries_ = std::make_unique<Entry[]>(entries);
+}
+
+template <std::size_t N>
+EncodeCache<N>::~EncodeCache() = default;
+
+template <std::size_t N>
+Result<std::span<std::uint8_t>>
+EncodeCache<N>::encode(
+    TokenType type,
+    std::array<std::uint8_t, N> const& payload,
+    std::span<std::uint8_t> out)
+{
+    auto const key = payload_words(payload);
+    std::uint64_t const hash = hash_payload(type, key);
+    for (std::size_t p = 0; p < probes; ++p)
+    {
+        Entry& e = entries_[(hash + p) & mask_];
+        auto const header = e.header.load(std::memory_order_acquire);
+        if (header & 1)
+            continue;
+        std::size_t const size = header_size(header);
+        // Entries are only emptied by `clear`, so the payload isn't further
+        // on either
+        if (size == 0)
+            break;
+        if (header_type(header) != type)
+            continue;
+
+        std::array<std::uint64_t, Entry::dataWords> data;
+        for (std::size_t i = 0; i < data.size(); ++i)
+            data[i] = e.data[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (e.header.load(std::memory_order_relaxed) != header)
+            continue;
+
+        if (!payload_matches<N>(data, key))
+            continue;
+        if (size > out.size())
+            return boost::outcome_v2::failure(TokenCodecErrc::OutputTooSmall);
+        copy_chars<N>(data, size, out.data());
+        return boost::outcome_v2::success(out.first(size));
+    }
+
+    std::array<std::uint8_t, Entry::maxChars> buf;
+    auto const r = encodeBase58Token<fast_sha256_hasher>(
+        type, payload, std::span<std::uint8_t>(buf));
+    if (!r)
+        return r;
+    std::size_t const size = r.value().size();
+
+    // Take the first empty entry, or else the next one in turn
+    std::size_t slot =
+        hash + next_victim_.fetch_add(1, std::memory_order_relaxed) % probes;
+    for (std::size_t p = 0; p < probes; ++p)
+    {
+        auto const header =
+            entries_[(hash + p) & mask_].header.load(std::memory_order_relaxed);
+        if (header_size(header) == 0 && !(header & 1))
+        {
+            slot = hash + p;
+            break;
+        }
+    }
+
+    // Skip the insert if another writer holds the entry
+    Entry& e = entries_[slot & mask_];
+    auto header = e.header.load(std::memory_order_relaxed);
+    if (!(header & 1) &&
+        e.header.compare_exchange_strong(
+            header, header + 1, std::memory_order_acquire))
+    {
+        std::array<std::uint8_t, Entry::dataWords * 8> bytes{};
+        std::copy(payload.begin(), payload.end(), bytes.begin());
+        std::copy(r.value().begin(), r.value().end(), bytes.begin() + N);
+        auto const data =
+            std::bit_cast<std::array<std::uint64_t, Entry::dataWords>>(bytes);
+
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < data.size(); ++i)
+            e.data[i].store(data[i], std::memory_order_relaxed);
+        e.header.store(
+            make_header(header + 2, type, size), std::memory_order_release);
+    }
+
+    if (size > out.size())
+        return boost::outcome_v2::failure(TokenCodecErrc::OutputTooSmall);
+    std::copy(r.value().begin(), r.value().end(), out.begin());
+    return boost::outcome_v2::success(out.first(size));
+}
+
+template <std::size_t N>
+void
+EncodeCache<N>::clear()
+{
+    for (std::size_t i = 0; i <= mask_; ++i)
+    {
+        Entry& e = entries_[i];
+        auto header = e.header.load(std::memory_order_relaxed);
+        // Wait for writers to finish
+        while ((header & 1) ||
+               !e.header.compare_exchange_weak(
+                   header, header + 1, std::memory_order_acquire))
+            header = e.header.load(std::memory_order_relaxed);
+        e.header.store(
+            make_header(header + 2, TokenType{}, 0),
+            std::memory_order_release);
+    }
+}
+
+template <std::size_t N>
+std::size_t
+EncodeCache<N>::capacity() const
+{
+    return mask_ + 1;
+}
+
+template <std::size_t N>
+std::size_t
+EncodeCache<N>::bytes() const
+{
+    return capacity() * sizeof(Entry);
+}
+
+template class EncodeCache<16>;
+template class EncodeCache<20>;
+template class EncodeCache<32>;
+template class EncodeCache<33>;
+
+}  // namespace b58_fast
+}  // namespace ripple
+#endif
@@ -0,0 +1,225 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_PROTOCOL_B58_CACHE_H_INCLUDED
+#define RIPPLE_PROTOCOL_B58_CACHE_H_INCLUDED
+
+#include <token_errors.h>
+#include <tokens.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string_view>
+
+#if !defined(_MSC_VER) && !defined(XRPL_B58_PORTABLE)
+namespace ripple {
+namespace b58_fast {
+
+/** A bounded cache of decoded tokens, keyed on (type, base 58 string)
+
+    Decoding through the cache gives exactly the same results as
+    `decodeBase58Token`, but a token that was decoded recently is copied out
+    of the cache instead of going through the base conversion and the
+    checksum. Only tokens that decode successfully are cached.
+
+    The cache is set associative: a key hashes to one set of `ways` entries
+    and, when the set is full, the entry to replace is picked with the CLOCK
+    algorithm (entries that were hit since the hand last passed get a second
+    chance). Sets are spread over `shards`, each with its own lock and
+    counters.
+
+    Lookups never take a lock: every entry is guarded by a sequence counter
+    (a seqlock), and a lookup that races with a writer is counted as a miss.
+    Inserting takes the lock of the shard. The cache may be shared by any
+    number of threads.
+*/
+class DecodeCache
+{
+public:
+    struct Stats
+    {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t insertions = 0;
+        std::uint64_t evictions = 0;
+    };
+
+    // Number of entries in a set
+    static constexpr std::size_t ways = 8;
+
+    /** Create an empty cache
+
+        @param capacity The number of tokens to hold. Rounded up to a power of
+                        two multiple of `ways`.
+        @param shards The number of locks (and counters) the sets are spread
+                      over. Rounded up to a power of two, and down to the
+                      number of sets.
+    */
+    explicit DecodeCache(std::size_t capacity, std::size_t shards = 16);
+
+    DecodeCache(DecodeCache const&) = delete;
+    DecodeCache&
+    operator=(DecodeCache const&) = delete;
+
+    ~DecodeCache();
+
+    /** Decode a token, through the cache
+
+        Same results as `decodeBase58Token(type, s, outBuf)`.
+    */
+    [[nodiscard]] Result<std::span<std::uint8_t>>
+    decode(TokenType type, std::string_view s, std::span<std::uint8_t> outBuf);
+
+    /** Look up a token without decoding it on a miss
+
+        @return the decoded token in `outBuf`, or an empty span if the token
+                isn't in the cache (or `outBuf` is too small for it).
+    */
+    [[nodiscard]] std::span<std::uint8_t>
+    find(TokenType type, std::string_view s, std::span<std::uint8_t> outBuf);
+
+    /** Remove every token. Counters are not reset. */
+    void
+    clear();
+
+    /** Sum of the counters of all the shards */
+    [[nodiscard]] Stats
+    stats() const;
+
+    /** The number of tokens the cache can hold */
+    [[nodiscard]] std::size_t
+    capacity() const;
+
+private:
+    struct Entry;
+    struct Set;
+    struct Shard;
+
+    // A key packed into words: type and size, then the base 58 characters
+    using Key = std::array<std::uint64_t, 8>;
+
+    Shard&
+    shard_of(std::size_t set) const;
+
+    std::span<std::uint8_t>
+    lookup(
+        std::size_t set,
+        std::uint64_t tag,
+        Key const& key,
+        std::span<std::uint8_t> outBuf);
+
+    void
+    insert(
+        std::size_t set,
+        std::uint64_t tag,
+        Key const& key,
+        std::span<std::uint8_t const> decoded);
+
+    std::size_t set_mask_;
+    std::size_t shard_mask_;
+    std::unique_ptr<Set[]> sets_;
+    std::unique_ptr<Shard[]> shards_;
+};
+
+/** A bounded cache of encoded tokens, keyed on (type, payload of `N` bytes)
+
+    Encoding through the cache gives exactly the same results as
+    `encodeBase58Token(type, payload, out)`, but a payload that was encoded
+    recently is copied out of the cache instead of going through the checksum
+    and the base conversion.
+
+    The cache is an open addressing table that fits in a fixed number of
+    bytes. An entry holds the payload and its encoding, and is one cache line
+    for payloads of up to 20 bytes (an AccountID) and two for larger ones. A
+    payload is looked for in the `probes` entries that follow its hash; a new
+    payload takes the first empty one of them, or else replaces one of them in
+    turn.
+
+    Every entry is guarded by a sequence counter (a seqlock). Lookups never
+    wait, and a lookup that races with a writer is a miss. Writers claim an
+    entry by making its counter odd, and skip the insert if another writer
+    holds it. The cache may be shared by any number of threads.
+
+    Available for payloads of 16, 20, 32 and 33 bytes.
+*/
+template <std::size_t N>
+class EncodeCache
+{
+public:
+    // Number of entries a payload may be stored in
+    static constexpr std::size_t probes = 4;
+
+    /** Create an empty cache
+
+        @param bytes The memory budget. The cache holds the largest power of
+                     two number of entries that fits, and at least `probes`.
+    */
+    explicit EncodeCache(std::size_t bytes);
+
+    EncodeCache(EncodeCache const&) = delete;
+    EncodeCache&
+    operator=(EncodeCache const&) = delete;
+
+    ~EncodeCache();
+
+    /** Encode a token, through the cache
+
+        Same results as `encodeBase58Token(type, payload, out)`.
+    */
+    [[nodiscard]] Result<std::span<std::uint8_t>>
+    encode(
+        TokenType type,
+        std::array<std::uint8_t, N> const& payload,
+        std::span<std::uint8_t> out);
+
+    /** Remove every token */
+    void
+    clear();
+
+    /** The number of tokens the cache can hold */
+    [[nodiscard]] std::size_t
+    capacity() const;
+
+    /** The number of bytes used by the entries */
+    [[nodiscard]] std::size_t
+    bytes() const;
+
+private:
+    struct Entry;
+
+    std::size_t mask_;
+    std::unique_ptr<Entry[]> entries_;
+    // Picks the entry to replace when all the probed entries are in use
+    std::atomic<std::size_t> next_victim_{0};
+};
+
+extern template class EncodeCache<16>;
+extern template class EncodeCache<20>;
+extern template class EncodeCache<32>;
+extern template class EncodeCache<33>;
+
+}  // namespace b58_fast
+}  // namespace ripple
+#endif
+
+#endif
@@ -0,0 +1,97 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <b58_index.h>
+
+#include <algorithm>
+
+#if !defined(_MSC_VER) && !defined(XRPL_B58_PORTABLE)
+namespace ripple {
+namespace b58_fast {
+
+template <TokenType Type>
+Base58PrefixIndex<Type>::Base58PrefixIndex(std::vector<Payload> payloads)
+    : payloads_(std::move(payloads))
+{
+    std::sort(payloads_.begin(), payloads_.end());
+    payloads_.erase(
+        std::unique(payloads_.begin(), payloads_.end()), payloads_.end());
+}
+
+template <TokenType Type>
+Result<typename Base58PrefixIndex<Type>::Matches>
+Base58PrefixIndex<Type>::find(std::string_view prefix) const
+{
+    auto const ranges = base58PrefixRanges<Type>(prefix);
+    if (!ranges)
+        return boost::outcome_v2::failure(ranges.error());
+
+    auto const matches = [&](Payload const& payload) {
+        auto const r = base58TokenStartsWith(Type, payload, prefix);
+        return r && r.value();
+    };
+    Matches result;
+    // Ranges that are close enough may share the payload at their ends
+    auto from = payloads_.begin();
+    for (auto const& range : ranges.value())
+    {
+        auto first = std::lower_bound(from, payloads_.end(), range.low);
+        auto last = std::upper_bound(first, payloads_.end(), range.high);
+        // Only the ends of the range may not match
+        if (first != last && *first == range.low && !matches(*first))
+            ++first;
+        if (first != last && last[-1] == range.high && !matches(last[-1]))
+            --last;
+        if (first != last)
+            result.emplace_back(&*first, last - first);
+        from = last;
+    }
+    return boost::outcome_v2::success(result);
+}
+
+template <TokenType Type>
+Result<std::size_t>
+Base58PrefixIndex<Type>::count(std::string_view prefix) const
+{
+    auto const matches = find(prefix);
+    if (!matches)
+        return boost::outcome_v2::failure(matches.error());
+    std::size_t result = 0;
+    for (auto const& run : matches.value())
+        result += run.size();
+    return result;
+}
+
+template <TokenType Type>
+std::span<typename Base58PrefixIndex<Type>::Payload const>
+Base58PrefixIndex<Type>::payloads() const
+{
+    return payloads_;
+}
+
+template class Base58PrefixIndex<TokenType::FamilySeed>;
+template class Base58PrefixIndex<TokenType::AccountID>;
+template class Base58PrefixIndex<TokenType::NodePrivate>;
+template class Base58PrefixIndex<TokenType::AccountSecret>;
+template class Base58PrefixIndex<TokenType::NodePublic>;
+template class Base58PrefixIndex<TokenType::AccountPublic>;
+
+}  // namespace b58_fast
+}  // namespace ripple
+#endif
@@ -0,0 +1,93 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_PROTOCOL_B58_INDEX_H_INCLUDED
+#define RIPPLE_PROTOCOL_B58_INDEX_H_INCLUDED
+
+#include <token_errors.h>
+#include <tokens.h>
+
+#include <boost/container/static_vector.hpp>
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#if !defined(_MSC_VER) && !defined(XRPL_B58_PORTABLE)
+namespace ripple {
+namespace b58_fast {
+
+/** A sorted set of payloads that finds those whose tokens start with a prefix
+
+    The tokens that start with a prefix are at most three ranges of payloads
+    (see `base58PrefixRanges`), so a query is two binary searches per range
+    instead of encoding every payload. Only the payloads at the ends of a
+    range are encoded, since their checksums decide whether they match.
+
+    Available for the token types with a fixed payload size. The index is
+    immutable once built, so it may be shared by any number of threads.
+*/
+template <TokenType Type>
+class Base58PrefixIndex
+{
+public:
+    using Payload = TokenPayload<Type>;
+
+    // The matching payloads: runs of `payloads()`, in payload order
+    using Matches =
+        boost::container::static_vector<std::span<Payload const>, 3>;
+
+    /** Index the payloads. Duplicates are dropped. */
+    explicit Base58PrefixIndex(std::vector<Payload> payloads);
+
+    /** The payloads whose tokens start with `prefix`
+
+        It is an error if the prefix has a character that is not in the
+        alphabet.
+    */
+    [[nodiscard]] Result<Matches>
+    find(std::string_view prefix) const;
+
+    /** The number of payloads whose tokens start with `prefix` */
+    [[nodiscard]] Result<std::size_t>
+    count(std::string_view prefix) const;
+
+    /** Every payload, sorted */
+    [[nodiscard]] std::span<Payload const>
+    payloads() const;
+
+private:
+    std::vector<Payload> payloads_;
+};
+
+using AccountIDPrefixIndex = Base58PrefixIndex<TokenType::AccountID>;
+
+extern template class Base58PrefixIndex<TokenType::FamilySeed>;
+extern template class Base58PrefixIndex<TokenType::AccountID>;
+extern template class Base58PrefixIndex<TokenType::NodePrivate>;
+extern template class Base58PrefixIndex<TokenType::AccountSecret>;
+extern template class Base58PrefixIndex<TokenType::NodePublic>;
+extern template class Base58PrefixIndex<TokenType::AccountPublic>;
+
+}  // namespace b58_fast
+}  // namespace ripple
+#endif
+
+#endif
@@ -0,0 +1,455 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <b58_kernels.h>
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#if !defined(_MSC_VER) && !defined(XRPL_B58_PORTABLE)
+namespace ripple {
+namespace b58_fast {
+namespace detail {
+
+// Digit value of every byte, 0xff for bytes not in the alphabet
+constexpr std::array<std::uint8_t, 256> digitTable = []() {
+    std::array<std::uint8_t, 256> table{};
+    table.fill(0xff);
+    for (std::size_t i = 0; i < b58Alphabet.size(); ++i)
+        table[static_cast<unsigned char>(b58Alphabet[i])] = i;
+    return table;
+}();
+
+// Bits [0, n) set
+constexpr std::uint64_t
+low_mask(std::size_t n)
+{
+    return n >= 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << n) - 1;
+}
+
+static bool
+b58_to_digits_scalar(
+    std::string_view in,
+    std::span<std::uint8_t, 64> digits,
+    std::size_t& leading_zeros)
+{
+    assert(in.size() <= digits.size());
+    // invalid chars map to 0xff; check them all at once at the end
+    std::uint8_t invalid = 0;
+    for (std::size_t i = 0; i < in.size(); ++i)
+    {
+        auto const d = digitTable[static_cast<unsigned char>(in[i])];
+        invalid |= d;
+        digits[i] = d;
+    }
+    if (invalid & 0x80)
+        return false;
+    std::fill(digits.begin() + in.size(), digits.end(), 0);
+    leading_zeros = std::find_if(
+                        digits.begin(),
+                        digits.begin() + in.size(),
+                        [](std::uint8_t d) { return d != 0; }) -
+        digits.begin();
+    return true;
+}
+
+// The kernels are compiled with target attributes rather than per file
+// compiler flags, so the rest of the library still runs on any x86-64 cpu.
+// They are only called after `kernelSupported` checks the cpu.
+#if defined(__x86_64__)
+
+// Adding and subtracting 1.5 * 2^52 rounds a double less than 2^51 in
+// magnitude to the nearest integer. Fusing the add with the multiply by the
+// reciprocal gives the quotient rounded to nearest from the exact product.
+constexpr double round_magic = 6755399441055744.0;
+
+__attribute__((target("avx2,fma"))) static void
+div_rem_lanes_avx2(
+    std::span<DoubleLanes> num,
+    double radix,
+    double divisor,
+    DoubleLanes& rem)
+{
+    constexpr std::size_t width = 4;
+    // Use several registers so independent division chains overlap
+    constexpr std::size_t regs = kernelLanes / width;
+    __m256d const vradix = _mm256_set1_pd(radix);
+    __m256d const vdiv = _mm256_set1_pd(divisor);
+    __m256d const vinv = _mm256_set1_pd(1.0 / divisor);
+    __m256d const magic = _mm256_set1_pd(round_magic);
+    __m256d r[regs];
+    std::fill(std::begin(r), std::end(r), _mm256_setzero_pd());
+    for (std::size_t i = num.size(); i-- > 0;)
+    {
+        for (std::size_t j = 0; j < regs; ++j)
+        {
+            __m256d const n = _mm256_fmadd_pd(
+                r[j], vradix, _mm256_loadu_pd(&num[i][j * width]));
+            __m256d const q =
+                _mm256_sub_pd(_mm256_fmadd_pd(n, vinv, magic), magic);
+            r[j] = _mm256_fnmadd_pd(q, vdiv, n);
+            _mm256_storeu_pd(&num[i][j * width], q);
+        }
+    }
+    for (std::size_t j = 0; j < regs; ++j)
+    {
+        // Move the remainder into [0, divisor) and borrow from the quotient
+        __m256d const borrow =
+            _mm256_cmp_pd(r[j], _mm256_setzero_pd(), _CMP_LT_OQ);
+        _mm256_storeu_pd(
+            &rem[j * width],
+            _mm256_add_pd(r[j], _mm256_and_pd(borrow, vdiv)));
+        _mm256_storeu_pd(
+            &num[0][j * width],
+            _mm256_sub_pd(
+                _mm256_loadu_pd(&num[0][j * width]),
+                _mm256_and_pd(borrow, _mm256_set1_pd(1.0))));
+    }
+}
+
+__attribute__((target("avx2"))) static void
+mul_add_lanes_avx2(
+    std::span<U64Lanes> num,
+    std::uint64_t mul,
+    U64Lanes const& add)
+{
+    constexpr std::size_t width = 4;
+    constexpr std::size_t regs = kernelLanes / width;
+    __m256i const vmul = _mm256_set1_epi64x(mul);
+    __m256i const low_mask = _mm256_set1_epi64x(0xffffffff);
+    __m256i carry[regs];
+    for (std::size_t j = 0; j < regs; ++j)
+    {
+        carry[j] = _mm256_loadu_si256(
+            reinterpret_cast<__m256i const*>(&add[j * width]));
+    }
+    for (auto& coeffs : num)
+    {
+        for (std::size_t j = 0; j < regs; ++j)
+        {
+            auto const p = reinterpret_cast<__m256i*>(&coeffs[j * width]);
+            __m256i const t = _mm256_add_epi64(
+                _mm256_mul_epu32(_mm256_loadu_si256(p), vmul), carry[j]);
+            _mm256_storeu_si256(p, _mm256_and_si256(t, low_mask));
+            carry[j] = _mm256_srli_epi64(t, 32);
+        }
+    }
+}
+
+__attribute__((target("avx512f"))) static void
+div_rem_lanes_avx512(
+    std::span<DoubleLanes> num,
+    double radix,
+    double divisor,
+    DoubleLanes& rem)
+{
+    constexpr std::size_t width = 8;
+    constexpr std::size_t regs = kernelLanes / width;
+    __m512d const vradix = _mm512_set1_pd(radix);
+    __m512d const vdiv = _mm512_set1_pd(divisor);
+    __m512d const vinv = _mm512_set1_pd(1.0 / divisor);
+    __m512d const magic = _mm512_set1_pd(round_magic);
+    __m512d r[regs];
+    std::fill(std::begin(r), std::end(r), _mm512_setzero_pd());
+    for (std::size_t i = num.size(); i-- > 0;)
+    {
+        for (std::size_t j = 0; j < regs; ++j)
+        {
+            __m512d const n = _mm512_fmadd_pd(
+                r[j], vradix, _mm512_loadu_pd(&num[i][j * width]));
+            __m512d const q =
+                _mm512_sub_pd(_mm512_fmadd_pd(n, vinv, magic), magic);
+            r[j] = _mm512_fnmadd_pd(q, vdiv, n);
+            _mm512_storeu_pd(&num[i][j * width], q);
+        }
+    }
+    for (std::size_t j = 0; j < regs; ++j)
+    {
+        // Move the remainder into [0, divisor) and borrow from the quotient
+        __mmask8 const borrow =
+            _mm512_cmp_pd_mask(r[j], _mm512_setzero_pd(), _CMP_LT_OQ);
+        _mm512_storeu_pd(
+            &rem[j * width], _mm512_mask_add_pd(r[j], borrow, r[j], vdiv));
+        __m512d const low = _mm512_loadu_pd(&num[0][j * width]);
+        _mm512_storeu_pd(
+            &num[0][j * width],
+            _mm512_mask_sub_pd(low, borrow, low, _mm512_set1_pd(1.0)));
+    }
+}
+
+__attribute__((target("avx512f"))) static void
+mul_add_lanes_avx512(
+    std::span<U64Lanes> num,
+    std::uint64_t mul,
+    U64Lanes const& add)
+{
+    constexpr std::size_t width = 8;
+    constexpr std::size_t regs = kernelLanes / width;
+    __m512i const vmul = _mm512_set1_epi64(mul);
+    __m512i const low_mask = _mm512_set1_epi64(0xffffffff);
+    // `_mm512_mul_epu32` and `_mm512_srli_epi64` merge into an undefined
+    // vector, which gcc reports as maybe uninitialized; merge into zeros
+    // instead (all lanes are set)
+    __m512i const zero = _mm512_setzero_si512();
+    __m512i carry[regs];
+    for (std::size_t j = 0; j < regs; ++j)
+    {
+        carry[j] = _mm512_loadu_si512(&add[j * width]);
+    }
+    for (auto& coeffs : num)
+    {
+        for (std::size_t j = 0; j < regs; ++j)
+        {
+            auto const p = &coeffs[j * width];
+            __m512i const t = _mm512_add_epi64(
+                _mm512_mask_mul_epu32(
+                    zero, 0xff, _mm512_loadu_si512(p), vmul),
+                carry[j]);
+            _mm512_storeu_si512(p, _mm512_and_si512(t, low_mask));
+            carry[j] = _mm512_mask_srli_epi64(zero, 0xff, t, 32);
+        }
+    }
+}
+
+// Every alphabet character is in [0x30, 0x80), so the digit of a character is
+// looked up by its low nibble in one of five 16 entry tables, picked by its
+// high nibble. Bytes with any other high nibble stay invalid.
+__attribute__((target("avx2"))) static bool
+b58_to_digits_avx2(
+    std::string_view in,
+    std::span<std::uint8_t, 64> digits,
+    std::size_t& leading_zeros)
+{
+    assert(in.size() <= digits.size());
+    constexpr std::size_t width = 32;
+    constexpr std::uint8_t first_high = 3;
+    constexpr std::size_t num_high = 5;
+    // Load the input without reading past its end. Copying it to a buffer
+    // first would stall the vector loads on the byte stores. Whole dwords
+    // are loaded with masked loads; the last partial dword is assembled in a
+    // register.
+    std::size_t const num_dwords = in.size() / 4;
+    std::uint32_t tail = 0;
+    for (std::size_t k = num_dwords * 4; k < in.size(); ++k)
+        tail |= static_cast<std::uint32_t>(static_cast<unsigned char>(in[k]))
+            << (8 * (k % 4));
+    __m256i const dword_index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    __m256i luts[num_high];
+    for (std::size_t h = 0; h < num_high; ++h)
+    {
+        auto const lut = _mm_loadu_si128(reinterpret_cast<__m128i const*>(
+            &digitTable[(first_high + h) * 16]));
+        luts[h] = _mm256_broadcastsi128_si256(lut);
+    }
+    __m256i const nibble = _mm256_set1_epi8(0x0f);
+    __m256i const index = _mm256_setr_epi8(
+        0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15,
+        16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31);
+
+    std::uint64_t invalid = 0;
+    std::uint64_t zeros = 0;
+    for (std::size_t i = 0; i < digits.size(); i += width)
+    {
+        // dwords of the input left before this block
+        __m256i const dwords_left = _mm256_set1_epi32(num_dwords - i / 4);
+        __m256i const c = _mm256_blendv_epi8(
+            _mm256_maskload_epi32(
+                reinterpret_cast<int const*>(in.data() + i),
+                _mm256_cmpgt_epi32(dwords_left, dword_index)),
+            _mm256_set1_epi32(tail),
+            _mm256_cmpeq_epi32(dwords_left, dword_index));
+        __m256i const low = _mm256_and_si256(c, nibble);
+        __m256i const high = _mm256_and_si256(_mm256_srli_epi16(c, 4), nibble);
+        __m256i d = _mm256_set1_epi8(-1);
+        for (std::size_t h = 0; h < num_high; ++h)
+        {
+            __m256i const sel =
+                _mm256_cmpeq_epi8(high, _mm256_set1_epi8(first_high + h));
+            d = _mm256_blendv_epi8(d, _mm256_shuffle_epi8(luts[h], low), sel);
+        }
+        // Zero the digits past the end of the input
+        __m256i const in_range = _mm256_cmpgt_epi8(
+            _mm256_set1_epi8(static_cast<char>(in.size() - i)), index);
+        d = _mm256_and_si256(d, in_range);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&digits[i]), d);
+        invalid |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(
+                       _mm256_movemask_epi8(d)))
+            << i;
+        zeros |= static_cast<std::uint64_t>(
+                     static_cast<std::uint32_t>(_mm256_movemask_epi8(
+                         _mm256_cmpeq_epi8(d, _mm256_setzero_si256()))))
+            << i;
+    }
+    if (invalid)
+        return false;
+    leading_zeros = std::min<std::size_t>(std::countr_one(zeros), in.size());
+    return true;
+}
+
+// With avx512vbmi the digit of every byte below 0x80 is a single two
+// register permute of the first half of `digitTable`
+__attribute__((target("avx512f,avx512bw,avx512vbmi"))) static bool
+b58_to_digits_avx512(
+    std::string_view in,
+    std::span<std::uint8_t, 64> digits,
+    std::size_t& leading_zeros)
+{
+    assert(in.size() <= digits.size());
+    __mmask64 const in_mask = low_mask(in.size());
+    // masked bytes are not read, so this never reads past the input
+    __m512i const c = _mm512_maskz_loadu_epi8(in_mask, in.data());
+    __m512i const d = _mm512_maskz_mov_epi8(
+        in_mask,
+        _mm512_permutex2var_epi8(
+            _mm512_loadu_si512(&digitTable[0]),
+            c,
+            _mm512_loadu_si512(&digitTable[64])));
+    // invalid digits and bytes >= 0x80 have the high bit set
+    if (_mm512_movepi8_mask(_mm512_or_si512(c, d)) & in_mask)
+        return false;
+    _mm512_storeu_si512(digits.data(), d);
+    leading_zeros = std::countr_one(_mm512_testn_epi8_mask(d, d) & in_mask);
+    return true;
+}
+#endif
+
+B58ToDigitsFn
+b58ToDigits(CodecKernel kernel)
+{
+#if defined(__x86_64__)
+    switch (kernel)
+    {
+        case CodecKernel::avx512:
+            if (__builtin_cpu_supports("avx512vbmi") &&
+                __builtin_cpu_supports("avx512bw"))
+                return b58_to_digits_avx512;
+            [[fallthrough]];
+        case CodecKernel::avx2:
+            if (__builtin_cpu_supports("avx2"))
+                return b58_to_digits_avx2;
+            break;
+        default:
+            break;
+    }
+#endif
+    return b58_to_digits_scalar;
+}
+
+bool
+b58_to_digits(
+    std::string_view in,
+    std::span<std::uint8_t, 64> digits,
+    std::size_t& leading_zeros)
+{
+    static B58ToDigitsFn const fn = b58ToDigits(activeKernel());
+    return fn(in, digits, leading_zeros);
+}
+
+DivRemLanesFn
+divRemLanes(CodecKernel kernel)
+{
+#if defined(__x86_64__)
+    switch (kernel)
+    {
+        case CodecKernel::avx2:
+            return div_rem_lanes_avx2;
+        case CodecKernel::avx512:
+            return div_rem_lanes_avx512;
+        default:
+            break;
+    }
+#endif
+    return nullptr;
+}
+
+MulAddLanesFn
+mulAddLanes(CodecKernel kernel)
+{
+#if defined(__x86_64__)
+    switch (kernel)
+    {
+        case CodecKernel::avx2:
+            return mul_add_lanes_avx2;
+        case CodecKernel::avx512:
+            return mul_add_lanes_avx512;
+        default:
+            break;
+    }
+#endif
+    return nullptr;
+}
+
+}  // namespace detail
+
+bool
+kernelSupported(CodecKernel kernel)
+{
+    switch (kernel)
+    {
+        case CodecKernel::scalar:
+            return true;
+#if defined(__x86_64__)
+        case CodecKernel::avx2:
+            return __builtin_cpu_supports("avx2") &&
+                __builtin_cpu_supports("fma");
+        case CodecKernel::avx512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return false;
+    }
+}
+
+CodecKernel
+activeKernel()
+{
+    static CodecKernel const kernel = []() {
+        if (char const* forced = std::getenv("XRPL_B58_KERNEL"))
+        {
+            for (auto [name, k] :
+                 {std::pair{"scalar", CodecKernel::scalar},
+                  std::pair{"avx2", CodecKernel::avx2},
+                  std::pair{"avx512", CodecKernel::avx512}})
+            {
+                if (std::strcmp(forced, name) == 0 && kernelSupported(k))
+                    return k;
+            }
+        }
+        for (auto k : {CodecKernel::avx512, CodecKernel::avx2})
+        {
+            if (kernelSupported(k))
+                return k;
+        }
+        return CodecKernel::scalar;
+    }();
+    return kernel;
+}
+
+}  // namespace b58_fast
+}  // namespace ripple
+#endif
@@ -0,0 +1,173 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_PROTOCOL_B58_KERNELS_H_INCLUDED
+#define RIPPLE_PROTOCOL_B58_KERNELS_H_INCLUDED
+
+#include <token_errors.h>
+#include <tokens.h>
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#if !defined(_MSC_VER) && !defined(XRPL_B58_PORTABLE)
+namespace ripple {
+namespace b58_fast {
+
+/** Implementations of the multi-token base conversions
+
+    The vector kernels convert `detail::kernelLanes` tokens at once. They
+    produce exactly the same results as the scalar kernel.
+*/
+enum class CodecKernel : std::uint8_t { scalar, avx2, avx512 };
+
+/** Return true if the kernel can run on this cpu */
+[[nodiscard]] bool
+kernelSupported(CodecKernel kernel);
+
+/** The kernel used by the batch codecs
+
+    This is the fastest kernel the cpu supports. Setting the environment
+    variable `XRPL_B58_KERNEL` to `scalar`, `avx2` or `avx512` forces a kernel
+    instead; a forced kernel the cpu can't run is ignored. The choice is made
+    once, on first use.
+*/
+[[nodiscard]] CodecKernel
+activeKernel();
+
+namespace detail {
+
+// The XRPL base 58 alphabet; the index of a character is its digit value
+constexpr std::string_view b58Alphabet = b58_portable::detail::alphabet;
+
+// Translate at most 64 base 58 characters to their digit values in one pass.
+// Returns false if any character is not in the alphabet. Otherwise
+// `digits[i]` is the value of `in[i]` (the rest of `digits` is zero) and
+// `leading_zeros` is the number of leading zero digits.
+using B58ToDigitsFn = bool (*)(
+    std::string_view in,
+    std::span<std::uint8_t, 64> digits,
+    std::size_t& leading_zeros);
+
+// Character translation for a kernel. The avx512 version needs avx512vbmi;
+// on cpus without it the avx2 version is used instead.
+[[nodiscard]] B58ToDigitsFn
+b58ToDigits(CodecKernel kernel);
+
+// Character translation with the active kernel
+[[nodiscard]] bool
+b58_to_digits(
+    std::string_view in,
+    std::span<std::uint8_t, 64> digits,
+    std::size_t& leading_zeros);
+
+// Number of tokens converted by one call of a vector kernel
+constexpr std::size_t kernelLanes = 32;
+
+using DoubleLanes = std::array<double, kernelLanes>;
+using U64Lanes = std::array<std::uint64_t, kernelLanes>;
+
+// Divide, in place, `kernelLanes` independent "big int" values by `divisor`
+// and store the remainders in `rem`. The values are stored structure-of-arrays
+// (num[i][lane]) as base `radix` coeffs, smallest coeffs first.
+//
+// To keep the dependency chain between coeffs short, each quotient coeff is
+// rounded to the nearest integer instead of down, so the quotient coeffs may
+// be negative; only the final remainder is moved into [0, divisor), with a
+// borrow from the smallest quotient coeff. The identity
+// num = quotient * divisor + rem holds exactly, and the coeffs of a value
+// that went through this stay within about radix/2 of zero. Every
+// intermediate `rem * radix + coeff` must be less than 2^52 in magnitude.
+using DivRemLanesFn = void (*)(
+    std::span<DoubleLanes> num,
+    double radix,
+    double divisor,
+    DoubleLanes& rem);
+
+// Compute, in place, `num * mul + add` for `kernelLanes` independent "big
+// uint" values. The values are stored structure-of-arrays (num[i][lane]) as
+// base 2^32 coeffs held in u64s, smallest coeffs first. `mul` and `add` must
+// be less than 2^32, and the most significant coeff must have room for the
+// carry.
+using MulAddLanesFn =
+    void (*)(std::span<U64Lanes> num, std::uint64_t mul, U64Lanes const& add);
+
+// Vector primitives for a kernel. Null for the scalar kernel.
+[[nodiscard]] DivRemLanesFn
+divRemLanes(CodecKernel kernel);
+
+[[nodiscard]] MulAddLanesFn
+mulAddLanes(CodecKernel kernel);
+
+// Write the ten alphabet characters of a base 58^10 coeff to `out`, largest
+// digit first (see tokens.cpp)
+void
+b58_10_to_alphabet_be(std::uint64_t coeff, std::uint8_t* out);
+
+// Translate base 58^10 coeffs (smallest coeff first) into the alphabet, after
+// `input_zeros` zero digits. Leading zero digits of the coeffs are skipped.
+[[nodiscard]] Result<std::span<std::uint8_t>>
+b58_10_to_alphabet(
+    std::span<std::uint64_t const> base_58_10_coeff,
+    std::size_t input_zeros,
+    std::span<std::uint8_t> out);
+
+// The largest expanded token (type + payload + checksum) the single token
+// conversions encode, and the most base 58 digits they decode: the length of
+// the longest encoding of that many bytes
+constexpr std::size_t maxExpandedTokenSize = 128;
+constexpr std::size_t maxEncodedTokenChars = maxBase58TokenChars;
+
+// Single token conversions (see tokens.cpp)
+[[nodiscard]] Result<std::span<std::uint8_t>>
+b256_to_b58(std::span<std::uint8_t const> input, std::span<std::uint8_t> out);
+
+[[nodiscard]] Result<std::span<std::uint8_t>>
+b58_to_b256(std::string_view input, std::span<std::uint8_t> out);
+
+// Encode up to `kernelLanes` expanded tokens (type + payload + checksum)
+// with `kernel`. On return each `out[i]` is shrunk to the encoded token.
+// Results are bit identical to `b256_to_b58`; tokens of more than 38 bytes
+// are converted one at a time with it.
+void
+b256_to_b58_kernel(
+    CodecKernel kernel,
+    std::span<std::span<std::uint8_t const> const> in,
+    std::span<std::span<std::uint8_t>> out,
+    std::span<TokenCodecErrc> status);
+
+// Decode up to `kernelLanes` base 58 strings into expanded tokens with
+// `kernel`. On return each `out[i]` is shrunk to the decoded bytes. Results
+// are bit identical to `b58_to_b256`; strings of more than 52 characters are
+// converted one at a time with it.
+void
+b58_to_b256_kernel(
+    CodecKernel kernel,
+    std::span<std::string_view const> in,
+    std::span<std::span<std::uint8_t>> out,
+    std::span<TokenCodecErrc> status);
+
+}  // namespace detail
+}  // namespace b58_fast
+}  // namespace ripple
+#endif
+
+#endif
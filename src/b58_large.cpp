@@ -0,0 +1,529 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <b58_large.h>
+
+#include <b58_kernels.h>
+#include <b58_utils.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#if !defined(_MSC_VER) && !defined(XRPL_B58_PORTABLE)
+namespace ripple {
+namespace b58_fast {
+
+namespace {
+
+// Big values are base 2^64 coeffs, smallest coeff first
+using Limbs = std::vector<std::uint64_t>;
+
+constexpr std::uint64_t B_58_10 = 430804206899405824;  // 58^10
+
+// Below these sizes the quadratic algorithms are faster: multiplies with a
+// factor of fewer base 2^64 coeffs, encodes of values with fewer base 2^64
+// coeffs, and decodes of fewer base 58^10 coeffs
+constexpr std::size_t karatsubaLimbs = 48;
+constexpr std::size_t encodeBasecaseLimbs = 32;
+constexpr std::size_t decodeBasecaseCoeffs = 32;
+
+// Reciprocals of divisors with at most this many coeffs are computed by
+// long division
+constexpr std::size_t reciprocalBasecaseLimbs = 6;
+
+// Digit value of every byte, -1 for bytes not in the alphabet
+constexpr auto const& digitOf = b58_portable::detail::alphabetReverse;
+
+void
+trim(Limbs& a)
+{
+    while (!a.empty() && a.back() == 0)
+        a.pop_back();
+}
+
+std::span<std::uint64_t const>
+trimmed(std::span<std::uint64_t const> a)
+{
+    std::size_t n = a.size();
+    while (n > 0 && a[n - 1] == 0)
+        --n;
+    return a.first(n);
+}
+
+// Compare the values of `a` and `b`, which may have different sizes
+int
+compare(std::span<std::uint64_t const> a, std::span<std::uint64_t const> b)
+{
+    a = trimmed(a);
+    b = trimmed(b);
+    if (a.size() != b.size())
+        return a.size() < b.size() ? -1 : 1;
+    for (std::size_t i = a.size(); i-- > 0;)
+    {
+        if (a[i] != b[i])
+            return a[i] < b[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+// r += x. Returns the carry out of `r`.
+std::uint64_t
+add_in(std::span<std::uint64_t> r, std::span<std::uint64_t const> x)
+{
+    x = trimmed(x);
+    assert(x.size() <= r.size());
+    std::uint64_t carry = 0;
+    std::size_t i = 0;
+    for (; i < x.size(); ++i)
+    {
+        auto const sum = static_cast<unsigned __int128>(r[i]) + x[i] + carry;
+        r[i] = static_cast<std::uint64_t>(sum);
+        carry = static_cast<std::uint64_t>(sum >> 64);
+    }
+    for (; carry && i < r.size(); ++i)
+        carry = ++r[i] == 0;
+    return carry;
+}
+
+// r -= x. Returns the borrow out of `r`.
+std::uint64_t
+sub_in(std::span<std::uint64_t> r, std::span<std::uint64_t const> x)
+{
+    x = trimmed(x);
+    assert(x.size() <= r.size());
+    std::uint64_t borrow = 0;
+    std::size_t i = 0;
+    for (; i < x.size(); ++i)
+    {
+        auto const d = static_cast<unsigned __int128>(r[i]) - x[i] - borrow;
+        r[i] = static_cast<std::uint64_t>(d);
+        borrow = static_cast<std::uint64_t>(d >> 64) & 1;
+    }
+    for (; borrow && i < r.size(); ++i)
+        borrow = r[i]-- == 0;
+    return borrow;
+}
+
+// r = a * b, where r has a.size() + b.size() coeffs
+void
+mul_basecase(
+    std::span<std::uint64_t const> a,
+    std::span<std::uint64_t const> b,
+    std::span<std::uint64_t> r)
+{
+    std::fill(r.begin(), r.end(), 0);
+    for (std::size_t j = 0; j < b.size(); ++j)
+    {
+        std::uint64_t carry = 0;
+        for (std::size_t i = 0; i < a.size(); ++i)
+        {
+            auto const p = static_cast<unsigned __int128>(a[i]) * b[j] +
+                r[i + j] + carry;
+            r[i + j] = static_cast<std::uint64_t>(p);
+            carry = static_cast<std::uint64_t>(p >> 64);
+        }
+        r[j + a.size()] = carry;
+    }
+}
+
+// r = a * b, where r has a.size() + b.size() coeffs
+void
+mul(std::span<std::uint64_t const> a,
+    std::span<std::uint64_t const> b,
+    std::span<std::uint64_t> r)
+{
+    assert(r.size() == a.size() + b.size());
+    if (a.size() < b.size())
+        std::swap(a, b);
+    if (b.size() < karatsubaLimbs)
+    {
+        mul_basecase(a, b, r);
+        return;
+    }
+
+    std::size_t const h = (a.size() + 1) / 2;
+    if (b.size() <= h)
+    {
+        // Unbalanced: multiply slices of `a` the size of `b`
+        std::fill(r.begin(), r.end(), 0);
+        Limbs t(2 * b.size());
+        for (std::size_t i = 0; i < a.size(); i += b.size())
+        {
+            auto const slice = a.subspan(i, std::min(b.size(), a.size() - i));
+            auto const product = std::span(t).first(slice.size() + b.size());
+            mul(slice, b, product);
+            add_in(r.subspan(i), product);
+        }
+        return;
+    }
+
+    // Karatsuba: with a = a1 B^h + a0 and b = b1 B^h + b0,
+    // a b = a1 b1 B^2h + ((a0 + a1) (b0 + b1) - a0 b0 - a1 b1) B^h + a0 b0
+    auto const a0 = a.first(h);
+    auto const a1 = a.subspan(h);
+    auto const b0 = b.first(h);
+    auto const b1 = b.subspan(h);
+    mul(a0, b0, r.first(2 * h));
+    mul(a1, b1, r.subspan(2 * h));
+    Limbs sa(a0.begin(), a0.end());
+    Limbs sb(b0.begin(), b0.end());
+    sa.push_back(add_in(sa, a1));
+    sb.push_back(add_in(sb, b1));
+    Limbs z1(sa.size() + sb.size());
+    mul(sa, sb, z1);
+    sub_in(z1, r.first(2 * h));
+    sub_in(z1, r.subspan(2 * h));
+    add_in(r.subspan(h), z1);
+}
+
+// floor(B^(2n) / p), where B = 2^64 and `p` has n coeffs, by long division
+// one bit at a time. Only for small divisors.
+Limbs
+reciprocal_basecase(std::span<std::uint64_t const> p)
+{
+    std::size_t const n = p.size();
+    Limbs q(n + 2);
+    Limbs rem(n + 1);
+    for (std::size_t bit = 128 * n + 1; bit-- > 0;)
+    {
+        // rem = 2 rem + (the bit of B^(2n))
+        for (std::size_t i = rem.size(); i-- > 1;)
+            rem[i] = rem[i] << 1 | rem[i - 1] >> 63;
+        rem[0] = rem[0] << 1 | (bit == 128 * n);
+        if (compare(rem, p) >= 0)
+        {
+            sub_in(rem, p);
+            assert(bit / 64 < q.size());
+            q[bit / 64] |= std::uint64_t{1} << (bit % 64);
+        }
+    }
+    trim(q);
+    return q;
+}
+
+// Within a few units of B^(2n) / p, where B = 2^64 and `p` has n coeffs with
+// a non-zero top coeff. The reciprocal of the top m coeffs of `p`, scaled,
+// is good to about m - 1 coeffs; one Newton step, r + r (B^(2n) - p r) /
+// B^(2n), doubles that. The cost is a few multiplies of the size of `p`.
+Limbs
+reciprocal(std::span<std::uint64_t const> p)
+{
+    std::size_t const n = p.size();
+    assert(n > 0 && p[n - 1] != 0);
+    if (n <= reciprocalBasecaseLimbs)
+        return reciprocal_basecase(p);
+
+    std::size_t const m = (n + 1) / 2 + 2;
+    auto const rm = reciprocal(p.last(m));
+
+    // r0 = rm B^(n-m) and B^(2n) - p r0 = (B^(n+m) - p rm) B^(n-m)
+    Limbs e(n + rm.size());
+    mul(p, rm, e);
+    bool const under = std::all_of(
+        e.begin() + n + m, e.end(), [](std::uint64_t c) { return c == 0; });
+    if (under)
+    {
+        // e = B^(n+m) - p rm
+        e.resize(n + m);
+        for (auto& c : e)
+            c = ~c;
+        Limbs const one{1};
+        add_in(e, one);
+    }
+    else
+    {
+        // e = p rm - B^(n+m)
+        Limbs const top{1};
+        sub_in(std::span(e).subspan(n + m), top);
+    }
+    trim(e);
+
+    // r1 = r0 +- rm e / B^(2m)
+    Limbs r(n + 2);
+    std::copy(rm.begin(), rm.end(), r.begin() + (n - m));
+    if (!e.empty())
+    {
+        Limbs c(rm.size() + e.size());
+        mul(rm, e, c);
+        if (c.size() > 2 * m)
+        {
+            auto const correction = std::span(c).subspan(2 * m);
+            if (under)
+                add_in(r, correction);
+            else
+                sub_in(r, correction);
+        }
+    }
+    trim(r);
+    return r;
+}
+
+// 58^(10 * 2^j), and its reciprocal when it's needed
+struct Power
+{
+    Limbs value;
+    Limbs reciprocal;
+};
+
+// The powers used by the conversions, computed on first use and kept. They
+// may be shared by any number of threads.
+class PowerCache
+{
+public:
+    Power const&
+    value(std::size_t j)
+    {
+        std::lock_guard lock(mutex_);
+        return extend(j);
+    }
+
+    Power const&
+    withReciprocal(std::size_t j)
+    {
+        std::lock_guard lock(mutex_);
+        Power& power = extend(j);
+        if (power.reciprocal.empty())
+            power.reciprocal = reciprocal(power.value);
+        return power;
+    }
+
+private:
+    Power&
+    extend(std::size_t j)
+    {
+        if (powers_.empty())
+            powers_.push_back(Power{Limbs{B_58_10}, {}});
+        while (powers_.size() <= j)
+        {
+            // References to the elements of a deque stay valid as it grows
+            auto const& last = powers_.back().value;
+            Limbs square(2 * last.size());
+            mul(last, last, square);
+            trim(square);
+            powers_.push_back(Power{std::move(square), {}});
+        }
+        return powers_[j];
+    }
+
+    std::mutex mutex_;
+    std::deque<Power> powers_;
+};
+
+PowerCache&
+powerCache()
+{
+    static PowerCache cache;
+    return cache;
+}
+
+// q = floor(x / p) and r = x mod p, for x < p^2
+void
+div_rem(
+    std::span<std::uint64_t const> x,
+    Power const& p,
+    Limbs& q,
+    Limbs& r)
+{
+    std::size_t const n = p.value.size();
+    // Estimate x * reciprocal / B^(2n), which is off by a few units at most.
+    // The quotient has about k = x.size() - n + 1 coeffs, so only the top
+    // k + 2 coeffs of x and of the reciprocal change the estimate by more
+    // than a unit.
+    constexpr std::size_t guard = 2;
+    std::size_t const x_skip =
+        std::min(x.size(), n > guard ? n - 1 - guard : 0);
+    std::size_t const r_skip = std::min(
+        p.reciprocal.size(),
+        2 * n > x.size() + guard ? 2 * n - x.size() - guard : 0);
+    auto const x_top = x.subspan(x_skip);
+    auto const r_top = std::span(p.reciprocal).subspan(r_skip);
+    Limbs product(x_top.size() + r_top.size());
+    mul(x_top, r_top, product);
+    std::size_t const shift = 2 * n - x_skip - r_skip;
+    q.assign(
+        product.begin() + std::min(shift, product.size()), product.end());
+    trim(q);
+    q.push_back(0);
+
+    Limbs qp(q.size() + n);
+    mul(q, p.value, qp);
+    Limbs const one{1};
+    while (compare(qp, x) > 0)
+    {
+        sub_in(qp, p.value);
+        sub_in(q, one);
+    }
+    r.assign(x.begin(), x.end());
+    sub_in(r, qp);
+    while (compare(r, p.value) >= 0)
+    {
+        sub_in(r, p.value);
+        add_in(q, one);
+    }
+    trim(q);
+    trim(r);
+}
+
+// Write the 2^level base 58^10 coeffs of x (smallest first) to `out`
+void
+to_b58_10_coeffs(Limbs x, std::size_t level, std::span<std::uint64_t> out)
+{
+    assert(out.size() == std::size_t{1} << level);
+    trim(x);
+    if (level == 0 || x.size() <= encodeBasecaseLimbs)
+    {
+        std::size_t used = x.size();
+        std::size_t i = 0;
+        while (used)
+        {
+            assert(i < out.size());
+            out[i++] = ::b58_fast::detail::inplace_bigint_div_rem_by<B_58_10>(
+                std::span(x.data(), used));
+            while (used && x[used - 1] == 0)
+                --used;
+        }
+        std::fill(out.begin() + i, out.end(), 0);
+        return;
+    }
+
+    Limbs q;
+    Limbs r;
+    div_rem(x, powerCache().withReciprocal(level - 1), q, r);
+    std::size_t const half = out.size() / 2;
+    to_b58_10_coeffs(std::move(r), level - 1, out.first(half));
+    to_b58_10_coeffs(std::move(q), level - 1, out.subspan(half));
+}
+
+// The value of base 58^10 coeffs (smallest first)
+Limbs
+from_b58_10_coeffs(std::span<std::uint64_t const> coeffs)
+{
+    if (coeffs.size() <= decodeBasecaseCoeffs)
+    {
+        Limbs x(::b58_fast::detail::b256_limbs_for_58_10_coeffs(
+            coeffs.size()));
+        std::size_t used = 0;
+        for (std::size_t i = coeffs.size(); i-- > 0;)
+        {
+            std::uint64_t carry = coeffs[i];
+            for (std::size_t j = 0; j < used; ++j)
+            {
+                auto const p =
+                    static_cast<unsigned __int128>(x[j]) * B_58_10 + carry;
+                x[j] = static_cast<std::uint64_t>(p);
+                carry = static_cast<std::uint64_t>(p >> 64);
+            }
+            if (carry)
+                x[used++] = carry;
+        }
+        trim(x);
+        return x;
+    }
+
+    // Split at the largest power of two below the size
+    std::size_t const level = std::bit_width(coeffs.size() - 1) - 1;
+    std::size_t const m = std::size_t{1} << level;
+    auto const lo = from_b58_10_coeffs(coeffs.first(m));
+    auto const hi = from_b58_10_coeffs(coeffs.subspan(m));
+    auto const& p = powerCache().value(level).value;
+    Limbs x(hi.size() + p.size() + 1);
+    mul(hi, p, std::span(x).first(hi.size() + p.size()));
+    add_in(x, lo);
+    trim(x);
+    return x;
+}
+
+}  // namespace
+
+Result<std::span<std::uint8_t>>
+encodeBase58Raw(
+    std::span<std::uint8_t const> input,
+    std::span<std::uint8_t> out)
+{
+    std::size_t const zeros =
+        std::find_if(
+            input.begin(), input.end(), [](std::uint8_t c) { return c != 0; }) -
+        input.begin();
+    auto const rest = input.subspan(zeros);
+
+    // Big endian bytes to base 2^64 coeffs
+    Limbs x((rest.size() + 7) / 8);
+    for (std::size_t i = 0; i < rest.size(); ++i)
+    {
+        std::size_t const bit = 8 * (rest.size() - 1 - i);
+        x[bit / 64] |= static_cast<std::uint64_t>(rest[i]) << (bit % 64);
+    }
+
+    std::size_t const num_coeffs =
+        (::b58_fast::detail::b58_digits_for_size(rest.size()) + 9) / 10;
+    std::size_t const level =
+        num_coeffs > 1 ? std::bit_width(num_coeffs - 1) : 0;
+    std::vector<std::uint64_t> coeffs(std::size_t{1} << level);
+    to_b58_10_coeffs(std::move(x), level, coeffs);
+    return detail::b58_10_to_alphabet(coeffs, zeros, out);
+}
+
+Result<std::span<std::uint8_t>>
+decodeBase58Raw(std::string_view input, std::span<std::uint8_t> out)
+{
+    for (auto c : input)
+    {
+        if (digitOf[static_cast<unsigned char>(c)] < 0)
+            return boost::outcome_v2::failure(
+                TokenCodecErrc::InvalidEncodingChar);
+    }
+    std::size_t const zeros =
+        std::min(input.find_first_not_of(detail::b58Alphabet[0]), input.size());
+    auto const digits = input.substr(zeros);
+
+    // Ten digits a coeff, smallest coeff first; the largest may have fewer
+    std::vector<std::uint64_t> coeffs((digits.size() + 9) / 10);
+    for (std::size_t i = 0; i < coeffs.size(); ++i)
+    {
+        std::size_t const end = digits.size() - 10 * i;
+        std::size_t const begin = end > 10 ? end - 10 : 0;
+        std::uint64_t coeff = 0;
+        for (std::size_t j = begin; j < end; ++j)
+            coeff = coeff * 58 + digitOf[static_cast<unsigned char>(digits[j])];
+        coeffs[i] = coeff;
+    }
+    auto const x = from_b58_10_coeffs(coeffs);
+
+    std::size_t const bytes =
+        x.empty() ? 0 : 8 * x.size() - std::countl_zero(x.back()) / 8;
+    std::size_t const out_size = zeros + bytes;
+    if (out.size() < out_size)
+        return boost::outcome_v2::failure(TokenCodecErrc::OutputTooSmall);
+    std::fill_n(out.begin(), zeros, 0);
+    for (std::size_t i = 0; i < bytes; ++i)
+    {
+        std::size_t const bit = 8 * (bytes - 1 - i);
+        out[zeros + i] = static_cast<std::uint8_t>(x[bit / 64] >> (bit % 64));
+    }
+    return boost::outcome_v2::success(out.first(out_size));
+}
+
+}  // namespace b58_fast
+}  // namespace ripple
+#endif
@@ -0,0 +1,86 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_PROTOCOL_B58_LARGE_H_INCLUDED
+#define RIPPLE_PROTOCOL_B58_LARGE_H_INCLUDED
+
+#include <token_errors.h>
+#include <tokens.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#if !defined(_MSC_VER) && !defined(XRPL_B58_PORTABLE)
+namespace ripple {
+namespace b58_fast {
+
+/** Upper bound on the size of the base 58 encoding of `size` bytes
+
+    The raw codecs below have no type byte and no checksum.
+*/
+[[nodiscard]] constexpr std::size_t
+rawEncodedSizeUpperBound(std::size_t size)
+{
+    // log(256) / log(58) is bounded by 138 / 100
+    return size * 138 / 100 + 1;
+}
+
+/** Upper bound on the size of the data in `size` base 58 characters */
+[[nodiscard]] constexpr std::size_t
+rawDecodedSizeUpperBound(std::size_t size)
+{
+    // A leading zero digit is a whole byte; the other digits are less than
+    // one byte each
+    return size;
+}
+
+/** Encode data of any size, with no type byte and no checksum
+
+    Each leading zero byte is one zero digit, as with tokens. The conversion
+    splits the value in halves by dividing it by cached powers 58^(10 * 2^j),
+    with a cached reciprocal of each power, and multiplies with Karatsuba, so
+    it takes O(n^1.6 log n) time instead of O(n^2). Small values take the
+    quadratic path, which is faster for them.
+
+    @return the encoded data, at the start of `out`. It needs at most
+            `rawEncodedSizeUpperBound(input.size())` bytes.
+*/
+[[nodiscard]] Result<std::span<std::uint8_t>>
+encodeBase58Raw(
+    std::span<std::uint8_t const> input,
+    std::span<std::uint8_t> out);
+
+/** Decode data of any size, with no type byte and no checksum
+
+    The halves of the digits are converted separately and combined with a
+    multiply by a cached power 58^(10 * 2^j).
+
+    @return the decoded data, at the start of `out`. It needs at most
+            `rawDecodedSizeUpperBound(input.size())` bytes.
+*/
+[[nodiscard]] Result<std::span<std::uint8_t>>
+decodeBase58Raw(std::string_view input, std::span<std::uint8_t> out);
+
+}  // namespace b58_fast
+}  // namespace ripple
+#endif
+
+#endif
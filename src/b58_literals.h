@@ -0,0 +1,85 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_PROTOCOL_B58_LITERALS_H_INCLUDED
+#define RIPPLE_PROTOCOL_B58_LITERALS_H_INCLUDED
+
+#include <tokens.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/** Literals for tokens known at compile time
+
+    They decode in constant evaluation (`consteval`), so a literal costs
+    nothing at run time, and one that isn't a valid token of its type (a bad
+    character, size, type or checksum) doesn't compile:
+
+        using namespace ripple::b58_literals;
+        constexpr auto genesis = "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh"_account;
+*/
+namespace ripple {
+namespace b58_literals {
+
+namespace detail {
+
+// Not constexpr: a literal that reaches it is not a constant expression, so
+// the compiler reports this name at the bad literal
+inline void
+invalid_base58_literal()
+{
+}
+
+template <std::size_t N>
+consteval std::array<std::uint8_t, N>
+decode_literal(TokenType type, std::string_view s)
+{
+    auto const payload = b58_portable::decodeBase58Token<N>(type, s);
+    if (!payload)
+        invalid_base58_literal();
+    return *payload;
+}
+
+}  // namespace detail
+
+/** The 20 byte account ID of an address, like `"r..."_account` */
+consteval std::array<std::uint8_t, 20>
+operator""_account(char const* s, std::size_t size)
+{
+    return detail::decode_literal<20>(
+        TokenType::AccountID, std::string_view(s, size));
+}
+
+/** The 33 byte public key of a node, like `"n..."_node_public`
+
+    For the keys of validators, in validator lists for example.
+*/
+consteval std::array<std::uint8_t, 33>
+operator""_node_public(char const* s, std::size_t size)
+{
+    return detail::decode_literal<33>(
+        TokenType::NodePublic, std::string_view(s, size));
+}
+
+}  // namespace b58_literals
+}  // namespace ripple
+
+#endif
@@ -0,0 +1,307 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <b58_parallel.h>
+
+#include <algorithm>
+#include <cassert>
+#include <optional>
+#include <utility>
+
+#if !defined(_MSC_VER) && !defined(XRPL_B58_PORTABLE)
+namespace ripple {
+namespace b58_fast {
+
+namespace {
+
+constexpr std::uint64_t
+pack_range(std::uint64_t begin, std::uint64_t end)
+{
+    return begin | end << 32;
+}
+
+constexpr std::pair<std::uint64_t, std::uint64_t>
+unpack_range(std::uint64_t range)
+{
+    return {range & 0xffffffff, range >> 32};
+}
+
+// Take the first task of a range
+std::optional<std::uint64_t>
+pop_front(std::atomic<std::uint64_t>& range)
+{
+    auto v = range.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        auto const [begin, end] = unpack_range(v);
+        if (begin >= end)
+            return std::nullopt;
+        if (range.compare_exchange_weak(
+                v, pack_range(begin + 1, end), std::memory_order_relaxed))
+            return begin;
+    }
+}
+
+// Take the back half of a range (all of it if it has one task)
+std::optional<std::pair<std::uint64_t, std::uint64_t>>
+steal_back(std::atomic<std::uint64_t>& range)
+{
+    auto v = range.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        auto const [begin, end] = unpack_range(v);
+        if (begin >= end)
+            return std::nullopt;
+        auto const mid = begin + (end - begin) / 2;
+        if (range.compare_exchange_weak(
+                v, pack_range(begin, mid), std::memory_order_relaxed))
+            return std::pair{mid, end};
+    }
+}
+
+}  // namespace
+
+WorkStealingPool::WorkStealingPool(std::size_t concurrency)
+{
+    if (!concurrency)
+        concurrency = std::max(1u, std::thread::hardware_concurrency());
+    ranges_storage_ = std::make_unique<Range[]>(concurrency);
+    ranges_ = std::span(ranges_storage_.get(), concurrency);
+    threads_.reserve(concurrency - 1);
+    // The caller of `parallelFor` works on range 0
+    for (std::size_t i = 1; i < concurrency; ++i)
+        threads_.emplace_back([this, i] { run(i); });
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& t : threads_)
+        t.join();
+}
+
+void
+WorkStealingPool::parallelFor(
+    std::size_t count,
+    std::function<void(std::size_t)> const& task)
+{
+    assert(count <= 0xffffffff);
+    if (count == 0)
+        return;
+    std::lock_guard call(call_mutex_);
+    std::size_t const n = ranges_.size();
+    if (n == 1 || count == 1)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            task(i);
+        return;
+    }
+
+    for (std::size_t t = 0; t < n; ++t)
+        ranges_[t].tasks.store(
+            pack_range(count * t / n, count * (t + 1) / n),
+            std::memory_order_relaxed);
+    remaining_.store(count, std::memory_order_relaxed);
+    {
+        std::lock_guard lock(mutex_);
+        task_ = &task;
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    work(0, task);
+
+    // Threads that joined late may still be looking for tasks; `task` must
+    // outlive them
+    std::unique_lock lock(mutex_);
+    done_.wait(lock, [this] {
+        return active_ == 0 &&
+            remaining_.load(std::memory_order_acquire) == 0;
+    });
+    task_ = nullptr;
+}
+
+void
+WorkStealingPool::run(std::size_t self)
+{
+    std::uint64_t seen = 0;
+    std::unique_lock lock(mutex_);
+    for (;;)
+    {
+        wake_.wait(lock, [&] {
+            return stop_ || (task_ && generation_ != seen);
+        });
+        if (stop_)
+            return;
+        seen = generation_;
+        auto const& task = *task_;
+        ++active_;
+        lock.unlock();
+        work(self, task);
+        lock.lock();
+        if (--active_ == 0)
+            done_.notify_all();
+    }
+}
+
+void
+WorkStealingPool::work(
+    std::size_t self,
+    std::function<void(std::size_t)> const& task)
+{
+    std::size_t const n = ranges_.size();
+    auto& own = ranges_[self].tasks;
+    std::size_t done = 0;
+    for (;;)
+    {
+        if (auto const i = pop_front(own))
+        {
+            task(*i);
+            ++done;
+            continue;
+        }
+        std::optional<std::pair<std::uint64_t, std::uint64_t>> stolen;
+        for (std::size_t k = 1; k < n && !stolen; ++k)
+            stolen = steal_back(ranges_[(self + k) % n].tasks);
+        if (!stolen)
+            break;
+        // Own range is empty, so no other thread changes it until this store
+        // makes the rest of the stolen tasks visible
+        own.store(
+            pack_range(stolen->first + 1, stolen->second),
+            std::memory_order_relaxed);
+        task(stolen->first);
+        ++done;
+    }
+    if (done &&
+        remaining_.fetch_sub(done, std::memory_order_acq_rel) == done)
+    {
+        std::lock_guard lock(mutex_);
+        done_.notify_all();
+    }
+}
+
+TaskExecutor&
+defaultExecutor()
+{
+    static WorkStealingPool pool;
+    return pool;
+}
+
+Result<std::span<std::uint8_t>>
+encodeBase58TokenParallel(
+    TokenType token_type,
+    std::span<std::span<std::uint8_t const> const> inputs,
+    std::span<std::uint8_t> outArena,
+    std::span<std::span<std::uint8_t>> outTokens,
+    TaskExecutor& executor)
+{
+    if (outTokens.size() < inputs.size())
+        return boost::outcome_v2::failure(TokenCodecErrc::OutputTooSmall);
+
+    // The part of the arena of every task: the sum of the worst case
+    // encodings of its tokens
+    std::size_t const tasks =
+        (inputs.size() + parallelTaskTokens - 1) / parallelTaskTokens;
+    std::vector<std::size_t> offsets(tasks + 1);
+    for (std::size_t i = 0; i < inputs.size(); ++i)
+    {
+        auto const size = inputs[i].size();
+        if (size > maxBase58TokenPayload)
+            return boost::outcome_v2::failure(TokenCodecErrc::InputTooLarge);
+        if (size == 0)
+            return boost::outcome_v2::failure(TokenCodecErrc::InputTooSmall);
+        offsets[i / parallelTaskTokens + 1] += encodedSizeUpperBound(size);
+    }
+    for (std::size_t t = 0; t < tasks; ++t)
+        offsets[t + 1] += offsets[t];
+    if (offsets.back() > outArena.size())
+        return boost::outcome_v2::failure(TokenCodecErrc::OutputTooSmall);
+
+    std::vector<std::optional<Result<std::span<std::uint8_t>>>> results(tasks);
+    executor.parallelFor(tasks, [&](std::size_t t) {
+        std::size_t const first = t * parallelTaskTokens;
+        std::size_t const n =
+            std::min(parallelTaskTokens, inputs.size() - first);
+        results[t] = encodeBase58TokenBatch(
+            token_type,
+            inputs.subspan(first, n),
+            outArena.subspan(offsets[t], offsets[t + 1] - offsets[t]),
+            outTokens.subspan(first, n));
+    });
+    for (auto const& r : results)
+    {
+        if (!*r)
+            return boost::outcome_v2::failure(r->error());
+    }
+    return boost::outcome_v2::success(outArena.first(offsets.back()));
+}
+
+Result<std::span<std::uint8_t>>
+decodeBase58TokenParallel(
+    std::span<TokenType const> types,
+    std::span<std::string_view const> inputs,
+    std::span<std::uint8_t> outArena,
+    std::span<std::span<std::uint8_t>> outTokens,
+    std::span<TokenCodecErrc> statuses,
+    TaskExecutor& executor)
+{
+    if (types.size() < inputs.size())
+        return boost::outcome_v2::failure(TokenCodecErrc::InputTooSmall);
+    if (outTokens.size() < inputs.size() || statuses.size() < inputs.size())
+        return boost::outcome_v2::failure(TokenCodecErrc::OutputTooSmall);
+
+    std::size_t const tasks =
+        (inputs.size() + parallelTaskTokens - 1) / parallelTaskTokens;
+    std::vector<std::size_t> offsets(tasks + 1);
+    for (std::size_t i = 0; i < inputs.size(); ++i)
+        offsets[i / parallelTaskTokens + 1] +=
+            decodedSizeUpperBound(inputs[i].size());
+    for (std::size_t t = 0; t < tasks; ++t)
+        offsets[t + 1] += offsets[t];
+    if (offsets.back() > outArena.size())
+        return boost::outcome_v2::failure(TokenCodecErrc::OutputTooSmall);
+
+    std::vector<std::optional<Result<std::span<std::uint8_t>>>> results(tasks);
+    executor.parallelFor(tasks, [&](std::size_t t) {
+        std::size_t const first = t * parallelTaskTokens;
+        std::size_t const n =
+            std::min(parallelTaskTokens, inputs.size() - first);
+        results[t] = decodeBase58TokenBatch(
+            types.subspan(first, n),
+            inputs.subspan(first, n),
+            outArena.subspan(offsets[t], offsets[t + 1] - offsets[t]),
+            outTokens.subspan(first, n),
+            statuses.subspan(first, n));
+    });
+    for (auto const& r : results)
+    {
+        if (!*r)
+            return boost::outcome_v2::failure(r->error());
+    }
+    return boost::outcome_v2::success(outArena.first(offsets.back()));
+}
+
+}  // namespace b58_fast
+}  // namespace ripple
+#endif
@@ -0,0 +1,173 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_PROTOCOL_B58_PARALLEL_H_INCLUDED
+#define RIPPLE_PROTOCOL_B58_PARALLEL_H_INCLUDED
+
+#include <token_errors.h>
+#include <tokens.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if !defined(_MSC_VER) && !defined(XRPL_B58_PORTABLE)
+namespace ripple {
+namespace b58_fast {
+
+/** Runs the tasks of the parallel codecs
+
+    Implement this to run the codecs on an existing thread pool.
+*/
+class TaskExecutor
+{
+public:
+    virtual ~TaskExecutor() = default;
+
+    /** Call `task(i)` for every `i` in [0, count), in any order and on any
+        threads, and return once every call has returned.
+    */
+    virtual void
+    parallelFor(
+        std::size_t count,
+        std::function<void(std::size_t)> const& task) = 0;
+};
+
+/** A fixed set of threads that share out tasks by work stealing
+
+    `parallelFor` splits the tasks into one contiguous range per thread. A
+    thread takes tasks from the front of its own range and, once that is
+    empty, steals the back half of the range of another thread. The calling
+    thread works too, so `concurrency` threads run the tasks.
+*/
+class WorkStealingPool final : public TaskExecutor
+{
+public:
+    /** @param concurrency The number of threads running tasks, including the
+                           caller of `parallelFor`. 0 means one per core.
+    */
+    explicit WorkStealingPool(std::size_t concurrency = 0);
+
+    WorkStealingPool(WorkStealingPool const&) = delete;
+    WorkStealingPool&
+    operator=(WorkStealingPool const&) = delete;
+
+    ~WorkStealingPool() override;
+
+    // Calls of `parallelFor` on the same pool run one at a time. `count`
+    // must be less than 2^32.
+    void
+    parallelFor(
+        std::size_t count,
+        std::function<void(std::size_t)> const& task) override;
+
+    [[nodiscard]] std::size_t
+    concurrency() const
+    {
+        return ranges_.size();
+    }
+
+private:
+    // The tasks left to a thread: [begin, end) packed as begin | end << 32
+    struct alignas(64) Range
+    {
+        std::atomic<std::uint64_t> tasks{0};
+    };
+
+    void
+    run(std::size_t self);
+
+    // Run tasks until no range has any left
+    void
+    work(std::size_t self, std::function<void(std::size_t)> const& task);
+
+    std::unique_ptr<Range[]> ranges_storage_;
+    std::span<Range> ranges_;
+    std::atomic<std::size_t> remaining_{0};
+
+    std::mutex call_mutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::function<void(std::size_t)> const* task_ = nullptr;
+    std::uint64_t generation_ = 0;
+    std::size_t active_ = 0;
+    bool stop_ = false;
+    std::vector<std::thread> threads_;
+};
+
+/** A pool with one thread per core, created on first use */
+[[nodiscard]] TaskExecutor&
+defaultExecutor();
+
+// Number of tokens in a task of the parallel codecs
+constexpr std::size_t parallelTaskTokens = 1024;
+
+/** Encode a large batch of tokens on many threads
+
+    Works like `encodeBase58TokenBatch`, with the inputs split into tasks of
+    `parallelTaskTokens` tokens. Every task encodes with the batch codec into
+    its own part of `outArena`, at an offset computed up front from the
+    input sizes, so tasks never share output.
+
+    @param outArena Storage for the encoded tokens, as for
+                    `encodeBase58TokenBatch`.
+    @param executor Runs the tasks.
+
+    @return the part of `outArena` holding all the encoded tokens. Unlike the
+            batch codec the tokens aren't contiguous: there may be unused
+            bytes after the last token of every task.
+*/
+[[nodiscard]] Result<std::span<std::uint8_t>>
+encodeBase58TokenParallel(
+    TokenType token_type,
+    std::span<std::span<std::uint8_t const> const> inputs,
+    std::span<std::uint8_t> outArena,
+    std::span<std::span<std::uint8_t>> outTokens,
+    TaskExecutor& executor = defaultExecutor());
+
+/** Decode a large batch of tokens on many threads
+
+    Works like `decodeBase58TokenBatch`, split into tasks like
+    `encodeBase58TokenParallel`.
+
+    @return the part of `outArena` holding all the decoded tokens, which
+            aren't contiguous.
+*/
+[[nodiscard]] Result<std::span<std::uint8_t>>
+decodeBase58TokenParallel(
+    std::span<TokenType const> types,
+    std::span<std::string_view const> inputs,
+    std::span<std::uint8_t> outArena,
+    std::span<std::span<std::uint8_t>> outTokens,
+    std::span<TokenCodecErrc> statuses,
+    TaskExecutor& executor = defaultExecutor());
+
+}  // namespace b58_fast
+}  // namespace ripple
+#endif
+
+#endif
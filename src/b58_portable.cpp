@@ -0,0 +1,111 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <b58_portable.h>
+#include <tokens.h>
+
+#include <digest.h>
+
+#include <boost/outcome/success_failure.hpp>
+
+#include <array>
+
+namespace ripple {
+namespace b58_portable {
+
+namespace {
+
+using detail::maxEncodedChars;
+
+// The checksum of a token at run time
+std::array<std::uint8_t, 4>
+fast_checksum(std::span<std::uint8_t const> message)
+{
+    std::array<std::uint8_t, 4> sum;
+    tokenChecksum<fast_sha256_hasher>(
+        sum.data(), message.data(), message.size());
+    return sum;
+}
+
+}  // namespace
+
+Result<std::span<std::uint8_t>>
+encodeBase58Token(
+    TokenType token_type,
+    std::span<std::uint8_t const> input,
+    std::span<std::uint8_t> out)
+{
+    std::size_t size = 0;
+    auto const ec = detail::encode_token(
+        static_cast<std::uint8_t>(token_type),
+        input,
+        out,
+        size,
+        fast_checksum);
+    if (ec != TokenCodecErrc::Success)
+        return boost::outcome_v2::failure(ec);
+    return boost::outcome_v2::success(out.subspan(0, size));
+}
+
+Result<std::span<std::uint8_t>>
+decodeBase58Token(
+    TokenType type,
+    std::string_view s,
+    std::span<std::uint8_t> outBuf)
+{
+    std::size_t size = 0;
+    auto const ec = detail::decode_token(
+        static_cast<std::uint8_t>(type), s, outBuf, size, fast_checksum);
+    if (ec != TokenCodecErrc::Success)
+        return boost::outcome_v2::failure(ec);
+    return boost::outcome_v2::success(outBuf.subspan(0, size));
+}
+
+std::string
+encodeBase58Token(TokenType type, void const* token, std::size_t size)
+{
+    std::string sr(maxEncodedChars, 0);
+    auto r = encodeBase58Token(
+        type,
+        std::span(reinterpret_cast<std::uint8_t const*>(token), size),
+        std::span(reinterpret_cast<std::uint8_t*>(sr.data()), sr.size()));
+    if (!r)
+        return {};
+    sr.resize(r.value().size());
+    return sr;
+}
+
+std::string
+decodeBase58Token(std::string const& s, TokenType type)
+{
+    // The payload is the decoded bytes, at most one per character plus one,
+    // without the type and the checksum
+    std::string sr(s.size() < 5 ? 0 : s.size() - 4, 0);
+    auto r = decodeBase58Token(
+        type,
+        s,
+        std::span(reinterpret_cast<std::uint8_t*>(sr.data()), sr.size()));
+    if (!r)
+        return {};
+    sr.resize(r.value().size());
+    return sr;
+}
+
+}  // namespace b58_portable
+}  // namespace ripple
@@ -0,0 +1,322 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_PROTOCOL_B58_PORTABLE_H_INCLUDED
+#define RIPPLE_PROTOCOL_B58_PORTABLE_H_INCLUDED
+
+#include <token_errors.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+// The cores of the `b58_portable` codecs. Everything here is 64 bit
+// arithmetic, so it builds without `unsigned __int128`, and is constexpr, so
+// constant evaluation can run it: the same code decodes tokens at run time
+// and at compile time.
+namespace ripple {
+namespace b58_portable {
+namespace detail {
+
+// The XRPL base 58 alphabet, for every codec: the index of a character is
+// its digit value
+inline constexpr std::string_view alphabet =
+    "rpshnaf39wBUDNEGHJKLM4PQRST7VWXYZ2bcdeCg65jkm8oFqi1tuvAxyz";
+
+// Digit value of every byte, -1 for bytes not in the alphabet
+inline constexpr std::array<int, 256> alphabetReverse = []() {
+    std::array<int, 256> map{};
+    for (auto& m : map)
+        m = -1;
+    for (std::size_t i = 0; i < alphabet.size(); ++i)
+        map[static_cast<unsigned char>(alphabet[i])] = i;
+    return map;
+}();
+
+// The largest expanded token (type + payload + checksum) and the most
+// characters a token decodes from, the same as `b58_fast`
+inline constexpr std::size_t maxExpandedSize = 128;
+inline constexpr std::size_t maxEncodedChars = 175;
+
+inline constexpr std::uint32_t B_58_5 = 656356768;  // 58^5
+
+// Number of base 58^5 coeffs needed to hold a value of `size` bytes
+// (58^5 > 2^29)
+constexpr std::size_t
+b58_5_coeffs_for_size(std::size_t size)
+{
+    return (size * 8 + 28) / 29;
+}
+
+// Number of base 2^32 coeffs needed to hold a value of `n` base 58 digits
+// (58 < 2^5.858)
+constexpr std::size_t
+b256_limbs_for_digits(std::size_t n)
+{
+    return (n * 5858 / 1000 + 1 + 31) / 32;
+}
+
+// Write the five alphabet characters of a base 58^5 coeff, largest first
+constexpr void
+b58_5_to_alphabet(std::uint32_t coeff, std::uint8_t* out)
+{
+    for (std::size_t i = 5; i-- > 0;)
+    {
+        out[i] = alphabet[coeff % 58];
+        coeff /= 58;
+    }
+}
+
+// Same as `b58_fast::detail::b256_to_b58`. The encoded size is stored in
+// `out_size`.
+constexpr TokenCodecErrc
+b256_to_b58(
+    std::span<std::uint8_t const> input,
+    std::span<std::uint8_t> out,
+    std::size_t& out_size)
+{
+    if (input.size() > maxExpandedSize)
+        return TokenCodecErrc::InputTooLarge;
+
+    std::size_t const input_zeros =
+        std::find_if(
+            input.begin(), input.end(), [](std::uint8_t c) { return c != 0; }) -
+        input.begin();
+    input = input.subspan(input_zeros);
+
+    // convert from big endian bytes to base 2^32, lowest coeff first
+    std::array<std::uint32_t, maxExpandedSize / 4> limbs{};
+    std::size_t num_limbs = (input.size() + 3) / 4;
+    for (std::size_t i = 0; i < input.size(); ++i)
+    {
+        limbs[i / 4] |= std::uint32_t{input[input.size() - 1 - i]}
+            << (8 * (i % 4));
+    }
+
+    // Divide the base 58^5 coeffs out, smallest first. Each step is a 64 by
+    // 32 bit divide by a constant, which compilers turn into a multiply. A
+    // divide removes less than 32 bits, so the top coeff becomes zero at most
+    // once per divide.
+    std::array<std::uint32_t, b58_5_coeffs_for_size(maxExpandedSize)>
+        base_58_5_coeff;
+    std::size_t num_coeffs = 0;
+    while (num_limbs > 0)
+    {
+        std::uint64_t rem = 0;
+        for (std::size_t i = num_limbs; i-- > 0;)
+        {
+            std::uint64_t const cur = rem << 32 | limbs[i];
+            limbs[i] = static_cast<std::uint32_t>(cur / B_58_5);
+            rem = cur % B_58_5;
+        }
+        base_58_5_coeff[num_coeffs++] = static_cast<std::uint32_t>(rem);
+        if (limbs[num_limbs - 1] == 0)
+            num_limbs -= 1;
+    }
+
+    // Don't write the leading zero digits of the most significant coeff
+    std::array<std::uint8_t, 5> top{};
+    std::size_t top_digits = 0;
+    if (num_coeffs)
+    {
+        b58_5_to_alphabet(base_58_5_coeff[num_coeffs - 1], top.data());
+        top_digits = top.end() -
+            std::find_if(top.begin(), top.end(), [](std::uint8_t c) {
+                         return c != alphabet[0];
+                     });
+    }
+    out_size = input_zeros + top_digits +
+        (num_coeffs ? (num_coeffs - 1) * 5 : 0);
+    if (out.size() < out_size)
+        return TokenCodecErrc::OutputTooSmall;
+    auto out_i = std::fill_n(out.begin(), input_zeros, alphabet[0]);
+    out_i = std::copy(top.end() - top_digits, top.end(), out_i);
+    for (std::size_t i = num_coeffs ? num_coeffs - 1 : 0; i-- > 0;)
+    {
+        b58_5_to_alphabet(base_58_5_coeff[i], &*out_i);
+        out_i += 5;
+    }
+    return TokenCodecErrc::Success;
+}
+
+// Same as `b58_fast::detail::b58_to_b256`: a zero byte for each leading zero
+// digit, then the value without leading zero bytes (a zero value is a single
+// zero byte). The decoded size is stored in `out_size`.
+constexpr TokenCodecErrc
+b58_to_b256(
+    std::string_view input,
+    std::span<std::uint8_t> out,
+    std::size_t& out_size)
+{
+    if (input.size() > maxEncodedChars)
+        return TokenCodecErrc::InputTooLarge;
+
+    // Translate and validate all the characters up front. Invalid characters
+    // map to -1; or all the values together so they are checked once.
+    std::array<std::uint8_t, maxEncodedChars> digits;
+    int invalid = 0;
+    for (std::size_t i = 0; i < input.size(); ++i)
+    {
+        int const d = alphabetReverse[static_cast<unsigned char>(input[i])];
+        invalid |= d;
+        digits[i] = static_cast<std::uint8_t>(d);
+    }
+    if (invalid < 0)
+        return TokenCodecErrc::InvalidEncodingChar;
+    std::size_t const input_zeros =
+        std::find_if(
+            digits.begin(),
+            digits.begin() + input.size(),
+            [](std::uint8_t d) { return d != 0; }) -
+        digits.begin();
+
+    // result = result * 58^k + coeff, base 2^32, smallest coeff first. The
+    // products are less than 2^62, and the carries less than 2^30.
+    std::array<std::uint32_t, b256_limbs_for_digits(maxEncodedChars)> limbs;
+    std::size_t num_limbs = 0;
+    auto mul_add = [&](std::uint32_t mul, std::uint32_t add) {
+        std::uint64_t carry = add;
+        for (std::size_t i = 0; i < num_limbs; ++i)
+        {
+            std::uint64_t const cur = std::uint64_t{limbs[i]} * mul + carry;
+            limbs[i] = static_cast<std::uint32_t>(cur);
+            carry = cur >> 32;
+        }
+        if (carry)
+            limbs[num_limbs++] = static_cast<std::uint32_t>(carry);
+    };
+    // The first base 58^5 coeff takes the digits left over
+    std::size_t const partial = input.size() % 5;
+    std::uint32_t coeff = 0;
+    std::uint32_t scale = 1;
+    for (std::size_t i = 0; i < partial; ++i)
+    {
+        coeff = coeff * 58 + digits[i];
+        scale *= 58;
+    }
+    mul_add(scale, coeff);
+    for (std::size_t i = partial; i < input.size(); i += 5)
+    {
+        coeff = 0;
+        for (std::size_t j = 0; j < 5; ++j)
+            coeff = coeff * 58 + digits[i + j];
+        mul_add(B_58_5, coeff);
+    }
+
+    // convert to big endian bytes, without the leading zeros (a zero value
+    // is a single zero byte)
+    std::array<std::uint8_t, limbs.size() * 4> b256_be{};
+    for (std::size_t i = 0; i < num_limbs; ++i)
+    {
+        for (std::size_t j = 0; j < 4; ++j)
+        {
+            b256_be[b256_be.size() - 1 - (i * 4 + j)] =
+                static_cast<std::uint8_t>(limbs[i] >> (8 * j));
+        }
+    }
+    std::size_t const value_size = num_limbs
+        ? num_limbs * 4 - std::countl_zero(limbs[num_limbs - 1]) / 8
+        : 1;
+
+    out_size = input_zeros + value_size;
+    if (out.size() < out_size)
+        return TokenCodecErrc::OutputTooSmall;
+    auto out_i = std::fill_n(out.begin(), input_zeros, 0);
+    std::copy(b256_be.end() - value_size, b256_be.end(), out_i);
+    return TokenCodecErrc::Success;
+}
+
+// Encode <type (1 byte)><payload><checksum (4 bytes)>. `checksum` computes
+// the checksum of a message, so the run time codecs use the fast hasher and
+// constant evaluation the constexpr one.
+template <class Checksum>
+constexpr TokenCodecErrc
+encode_token(
+    std::uint8_t type,
+    std::span<std::uint8_t const> input,
+    std::span<std::uint8_t> out,
+    std::size_t& out_size,
+    Checksum checksum)
+{
+    std::array<std::uint8_t, maxExpandedSize> buf;
+    if (input.size() > buf.size() - 5)
+        return TokenCodecErrc::InputTooLarge;
+    if (input.size() == 0)
+        return TokenCodecErrc::InputTooSmall;
+    buf[0] = type;
+    std::copy(input.begin(), input.end(), buf.begin() + 1);
+    auto const sum =
+        checksum(std::span<std::uint8_t const>(buf.data(), input.size() + 1));
+    std::copy(sum.begin(), sum.end(), buf.begin() + input.size() + 1);
+    return b256_to_b58(
+        std::span<std::uint8_t const>(buf.data(), input.size() + 5),
+        out,
+        out_size);
+}
+
+// Decode a token and check its type and checksum. The payload is stored at
+// the start of `out` and its size in `out_size`.
+template <class Checksum>
+constexpr TokenCodecErrc
+decode_token(
+    std::uint8_t type,
+    std::string_view s,
+    std::span<std::uint8_t> out,
+    std::size_t& out_size,
+    Checksum checksum)
+{
+    // Every digit decodes to at most one byte, plus one for a zero value
+    std::array<std::uint8_t, maxEncodedChars + 1> buf;
+    std::size_t size = 0;
+    if (auto const ec = b58_to_b256(s, buf, size);
+        ec != TokenCodecErrc::Success)
+        return ec;
+    std::span<std::uint8_t const> const ret(buf.data(), size);
+
+    // Reject zero length tokens
+    if (ret.size() < 6)
+        return TokenCodecErrc::InputTooSmall;
+
+    // The type must match.
+    if (ret[0] != type)
+        return TokenCodecErrc::MismatchedTokenType;
+
+    // And the checksum must as well.
+    constexpr std::size_t guardSize = 4;
+    auto const guard = checksum(ret.first(ret.size() - guardSize));
+    if (!std::equal(guard.begin(), guard.end(), ret.end() - guardSize))
+        return TokenCodecErrc::MismatchedChecksum;
+
+    out_size = ret.size() - 1 - guardSize;
+    if (out.size() < out_size)
+        return TokenCodecErrc::OutputTooSmall;
+    // Skip the leading type byte and the trailing checksum.
+    std::copy(ret.begin() + 1, ret.begin() + 1 + out_size, out.begin());
+    return TokenCodecErrc::Success;
+}
+
+}  // namespace detail
+}  // namespace b58_portable
+}  // namespace ripple
+
+#endif
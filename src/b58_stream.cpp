@@ -0,0 +1,440 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <b58_stream.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if !defined(_MSC_VER) && !defined(XRPL_B58_PORTABLE)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ripple {
+namespace b58_fast {
+
+namespace {
+
+std::error_code
+last_error()
+{
+    return {errno, std::generic_category()};
+}
+
+// A read only memory map of a whole file
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    MappedFile(MappedFile const&) = delete;
+    MappedFile&
+    operator=(MappedFile const&) = delete;
+
+    ~MappedFile()
+    {
+        if (size_)
+            ::munmap(const_cast<char*>(data_), size_);
+    }
+
+    std::error_code
+    open(std::filesystem::path const& path)
+    {
+        int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return last_error();
+        struct stat st;
+        std::error_code ec;
+        if (::fstat(fd, &st) != 0)
+        {
+            ec = last_error();
+        }
+        else if (st.st_size > 0)
+        {
+            void* const p =
+                ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED)
+            {
+                ec = last_error();
+            }
+            else
+            {
+                data_ = static_cast<char const*>(p);
+                size_ = st.st_size;
+                ::madvise(p, size_, MADV_SEQUENTIAL);
+            }
+        }
+        ::close(fd);
+        return ec;
+    }
+
+    std::string_view
+    view() const
+    {
+        return {data_, size_};
+    }
+
+    // Ask the kernel to start reading [offset, offset + size) before it is
+    // used, so reading overlaps the conversion of the current chunk
+    void
+    prefetch(std::size_t offset, std::size_t size) const
+    {
+        if (offset >= size_ || size == 0)
+            return;
+        static std::size_t const page = ::sysconf(_SC_PAGESIZE);
+        std::size_t const begin = offset / page * page;
+        size = std::min(size, size_ - offset) + (offset - begin);
+        ::madvise(const_cast<char*>(data_) + begin, size, MADV_WILLNEED);
+    }
+
+private:
+    char const* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+class OutputFile
+{
+public:
+    OutputFile() = default;
+    OutputFile(OutputFile const&) = delete;
+    OutputFile&
+    operator=(OutputFile const&) = delete;
+
+    ~OutputFile()
+    {
+        if (fd_ >= 0)
+            ::close(fd_);
+    }
+
+    std::error_code
+    open(std::filesystem::path const& path)
+    {
+        fd_ = ::open(
+            path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        return fd_ < 0 ? last_error() : std::error_code();
+    }
+
+    std::error_code
+    close()
+    {
+        int const fd = std::exchange(fd_, -1);
+        return ::close(fd) != 0 ? last_error() : std::error_code();
+    }
+
+    int
+    fd() const
+    {
+        return fd_;
+    }
+
+private:
+    int fd_ = -1;
+};
+
+// Writes filled buffers to a file on a thread of its own, so the conversion
+// of the next chunk overlaps the write of the last one. At most two buffers
+// are in use: the one being filled and the one being written.
+class DoubleBufferWriter
+{
+public:
+    DoubleBufferWriter(int fd, std::size_t capacity) : fd_(fd)
+    {
+        for (auto& buffer : buffers_)
+            buffer.reserve(capacity);
+        thread_ = std::thread([this] { run(); });
+    }
+
+    DoubleBufferWriter(DoubleBufferWriter const&) = delete;
+    DoubleBufferWriter&
+    operator=(DoubleBufferWriter const&) = delete;
+
+    ~DoubleBufferWriter()
+    {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+
+    // The buffer to fill, empty and with room for `capacity` bytes
+    std::vector<char>&
+    buffer()
+    {
+        return buffers_[filling_];
+    }
+
+    // Hand the filled buffer to the writer thread, once it is done with the
+    // previous one
+    void
+    submit()
+    {
+        std::unique_lock lock(mutex_);
+        cv_.wait(lock, [this] { return !pending_; });
+        pending_ = true;
+        filling_ ^= 1;
+        buffers_[filling_].clear();
+        cv_.notify_all();
+    }
+
+    // Wait for the last write. Returns the first error, if any.
+    std::error_code
+    finish()
+    {
+        std::unique_lock lock(mutex_);
+        cv_.wait(lock, [this] { return !pending_; });
+        return error_;
+    }
+
+private:
+    void
+    run()
+    {
+        std::unique_lock lock(mutex_);
+        for (;;)
+        {
+            cv_.wait(lock, [this] { return pending_ || stop_; });
+            if (!pending_)
+                return;
+            auto const& buffer = buffers_[filling_ ^ 1];
+            lock.unlock();
+            auto const ec = write_all(buffer);
+            lock.lock();
+            if (ec && !error_)
+                error_ = ec;
+            pending_ = false;
+            cv_.notify_all();
+        }
+    }
+
+    std::error_code
+    write_all(std::vector<char> const& buffer) const
+    {
+        std::size_t done = 0;
+        while (done < buffer.size())
+        {
+            auto const n =
+                ::write(fd_, buffer.data() + done, buffer.size() - done);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return last_error();
+            }
+            done += n;
+        }
+        return {};
+    }
+
+    int const fd_;
+    std::array<std::vector<char>, 2> buffers_;
+    std::size_t filling_ = 0;
+    bool pending_ = false;
+    bool stop_ = false;
+    std::error_code error_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread thread_;
+};
+
+double
+seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+}  // namespace
+
+Result<StreamStats>
+encodeBase58File(
+    TokenType type,
+    std::size_t stride,
+    std::filesystem::path const& input,
+    std::filesystem::path const& output,
+    StreamOptions const& options)
+{
+    auto const start = std::chrono::steady_clock::now();
+    if (stride == 0)
+        return boost::outcome_v2::failure(TokenCodecErrc::InputTooSmall);
+    if (stride > 33)
+        return boost::outcome_v2::failure(TokenCodecErrc::InputTooLarge);
+
+    MappedFile in;
+    if (auto const ec = in.open(input))
+        return boost::outcome_v2::failure(ec);
+    auto const data = in.view();
+    // The last payload would be cut short
+    if (data.size() % stride != 0)
+        return boost::outcome_v2::failure(TokenCodecErrc::InputTooSmall);
+
+    OutputFile out;
+    if (auto const ec = out.open(output))
+        return boost::outcome_v2::failure(ec);
+
+    std::size_t const chunk = std::max<std::size_t>(options.chunkTokens, 1);
+    std::size_t const max_chars = encodedSizeUpperBound(stride);
+    std::vector<std::span<std::uint8_t const>> inputs(chunk);
+    std::vector<std::uint8_t> arena(chunk * max_chars);
+    std::vector<std::span<std::uint8_t>> outTokens(chunk);
+
+    StreamStats stats;
+    stats.bytesIn = data.size();
+    {
+        DoubleBufferWriter writer(out.fd(), chunk * (max_chars + 1));
+        auto const bytes = reinterpret_cast<std::uint8_t const*>(data.data());
+        std::size_t const total = data.size() / stride;
+        for (std::size_t first = 0; first < total; first += chunk)
+        {
+            std::size_t const n = std::min(chunk, total - first);
+            in.prefetch((first + n) * stride, chunk * stride);
+            for (std::size_t i = 0; i < n; ++i)
+                inputs[i] = {bytes + (first + i) * stride, stride};
+
+            auto const r = encodeBase58TokenBatch(
+                type,
+                std::span(inputs).first(n),
+                arena,
+                std::span(outTokens).first(n));
+            if (!r)
+                return boost::outcome_v2::failure(r.error());
+
+            auto& buffer = writer.buffer();
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                buffer.insert(
+                    buffer.end(), outTokens[i].begin(), outTokens[i].end());
+                buffer.push_back('\n');
+            }
+            stats.bytesOut += buffer.size();
+            writer.submit();
+        }
+        stats.tokens = total;
+        if (auto const ec = writer.finish())
+            return boost::outcome_v2::failure(ec);
+    }
+    if (auto const ec = out.close())
+        return boost::outcome_v2::failure(ec);
+
+    stats.seconds = seconds_since(start);
+    return boost::outcome_v2::success(stats);
+}
+
+Result<StreamStats>
+decodeBase58File(
+    TokenType type,
+    std::size_t stride,
+    std::filesystem::path const& input,
+    std::filesystem::path const& output,
+    StreamOptions const& options)
+{
+    auto const start = std::chrono::steady_clock::now();
+    if (stride == 0)
+        return boost::outcome_v2::failure(TokenCodecErrc::InputTooSmall);
+
+    MappedFile in;
+    if (auto const ec = in.open(input))
+        return boost::outcome_v2::failure(ec);
+    auto const text = in.view();
+
+    OutputFile out;
+    if (auto const ec = out.open(output))
+        return boost::outcome_v2::failure(ec);
+
+    std::size_t const chunk = std::max<std::size_t>(options.chunkTokens, 1);
+    std::vector<TokenType> types(chunk, type);
+    std::vector<std::string_view> inputs(chunk);
+    std::vector<std::uint8_t> arena(
+        chunk * decodedSizeUpperBound(maxBase58TokenChars));
+    std::vector<std::span<std::uint8_t>> outTokens(chunk);
+    std::vector<TokenCodecErrc> statuses(chunk);
+
+    StreamStats stats;
+    stats.bytesIn = text.size();
+    {
+        DoubleBufferWriter writer(out.fd(), chunk * stride);
+        std::size_t pos = 0;
+        while (pos < text.size())
+        {
+            std::size_t const chunk_start = pos;
+            std::size_t n = 0;
+            for (; n < chunk && pos < text.size(); ++n)
+            {
+                auto const nl = text.find('\n', pos);
+                auto const end = nl == text.npos ? text.size() : nl;
+                auto line = text.substr(pos, end - pos);
+                if (!line.empty() && line.back() == '\r')
+                    line.remove_suffix(1);
+                inputs[n] = line;
+                pos = nl == text.npos ? text.size() : nl + 1;
+            }
+            in.prefetch(pos, pos - chunk_start);
+
+            auto const r = decodeBase58TokenBatch(
+                std::span(types).first(n),
+                std::span(inputs).first(n),
+                arena,
+                std::span(outTokens).first(n),
+                std::span(statuses).first(n));
+            if (!r)
+                return boost::outcome_v2::failure(r.error());
+
+            auto& buffer = writer.buffer();
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                if (statuses[i] == TokenCodecErrc::Success &&
+                    outTokens[i].size() == stride)
+                {
+                    buffer.insert(
+                        buffer.end(), outTokens[i].begin(), outTokens[i].end());
+                }
+                else
+                {
+                    buffer.insert(buffer.end(), stride, 0);
+                    ++stats.failed;
+                }
+            }
+            stats.tokens += n;
+            stats.bytesOut += buffer.size();
+            writer.submit();
+        }
+        if (auto const ec = writer.finish())
+            return boost::outcome_v2::failure(ec);
+    }
+    if (auto const ec = out.close())
+        return boost::outcome_v2::failure(ec);
+
+    stats.seconds = seconds_since(start);
+    return boost::outcome_v2::success(stats);
+}
+
+}  // namespace b58_fast
+}  // namespace ripple
+#endif
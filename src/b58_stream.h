@@ -0,0 +1,112 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_PROTOCOL_B58_STREAM_H_INCLUDED
+#define RIPPLE_PROTOCOL_B58_STREAM_H_INCLUDED
+
+#include <token_errors.h>
+#include <tokens.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+#if !defined(_MSC_VER) && !defined(XRPL_B58_PORTABLE)
+namespace ripple {
+namespace b58_fast {
+
+/** Options of the file codecs */
+struct StreamOptions
+{
+    // Number of tokens converted per chunk. The output buffers hold one chunk
+    // each.
+    std::size_t chunkTokens = 1 << 14;
+};
+
+/** What a file codec did, and how fast */
+struct StreamStats
+{
+    // Tokens read, including the ones that failed to decode
+    std::uint64_t tokens = 0;
+    std::uint64_t failed = 0;
+    std::uint64_t bytesIn = 0;
+    std::uint64_t bytesOut = 0;
+    double seconds = 0;
+
+    [[nodiscard]] double
+    tokensPerSecond() const
+    {
+        return seconds > 0 ? tokens / seconds : 0;
+    }
+
+    // Of the input
+    [[nodiscard]] double
+    megabytesPerSecond() const
+    {
+        return seconds > 0 ? bytesIn / seconds / 1e6 : 0;
+    }
+};
+
+/** Encode a file of fixed size payloads as base 58 text, one token per line
+
+    The input is memory mapped and converted in chunks with the batch codecs,
+    and each chunk is written on another thread while the next one is
+    converted (through two bounded buffers). Nothing is allocated per token.
+
+    @param type The type of the tokens.
+    @param stride The size of each payload, from 1 to 33 bytes. The input size
+                  must be a multiple of it.
+    @param input The file of payloads.
+    @param output The text file to write; it is replaced.
+*/
+[[nodiscard]] Result<StreamStats>
+encodeBase58File(
+    TokenType type,
+    std::size_t stride,
+    std::filesystem::path const& input,
+    std::filesystem::path const& output,
+    StreamOptions const& options = {});
+
+/** Decode a file of base 58 tokens, one per line, into fixed size payloads
+
+    Lines may end with "\n" or "\r\n". The input is memory mapped and
+    converted in chunks like `encodeBase58File`.
+
+    @param type The expected type of the tokens.
+    @param stride The size of each payload.
+    @param input The text file of tokens.
+    @param output The file of payloads to write; it is replaced.
+
+    @return the stats. A token that fails to decode to `stride` bytes is
+            written as `stride` zero bytes and counted as failed, so the
+            payload of line `i` is always at offset `i * stride`.
+*/
+[[nodiscard]] Result<StreamStats>
+decodeBase58File(
+    TokenType type,
+    std::size_t stride,
+    std::filesystem::path const& input,
+    std::filesystem::path const& output,
+    StreamOptions const& options = {});
+
+}  // namespace b58_fast
+}  // namespace ripple
+#endif
+
+#endif
@@ -0,0 +1,141 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_PROTOCOL_B58_STRING_H_INCLUDED
+#define RIPPLE_PROTOCOL_B58_STRING_H_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace ripple {
+
+/** A string of at most `capacity` characters, stored inline
+
+    The codecs return it instead of a `std::string` so they don't allocate.
+    It holds the encoding of any token with a payload of up to 33 bytes (all
+    the token types), and the payload of any token of up to 60 characters.
+    Longer tokens, with payloads of more than `capacity` bytes, don't fit.
+    It is a literal type, so `b58_portable::encodeBase58Token` can build one
+    at compile time.
+*/
+class Base58String
+{
+public:
+    static constexpr std::size_t capacity = 56;
+
+    Base58String() = default;
+
+    /** Copy `s`, which must be at most `capacity` characters */
+    explicit constexpr Base58String(std::string_view s) : size_(s.size())
+    {
+        assert(s.size() <= capacity);
+        std::copy(s.begin(), s.end(), data_.begin());
+    }
+
+    [[nodiscard]] constexpr char const*
+    data() const
+    {
+        return data_.data();
+    }
+
+    [[nodiscard]] constexpr std::size_t
+    size() const
+    {
+        return size_;
+    }
+
+    [[nodiscard]] constexpr bool
+    empty() const
+    {
+        return size_ == 0;
+    }
+
+    [[nodiscard]] constexpr char const*
+    begin() const
+    {
+        return data_.data();
+    }
+
+    [[nodiscard]] constexpr char const*
+    end() const
+    {
+        return data_.data() + size_;
+    }
+
+    [[nodiscard]] constexpr std::string_view
+    view() const
+    {
+        return {data_.data(), size_};
+    }
+
+    constexpr operator std::string_view() const
+    {
+        return view();
+    }
+
+    /** Copy into a `std::string` (which allocates past its inline size) */
+    [[nodiscard]] std::string
+    str() const
+    {
+        return std::string(view());
+    }
+
+    friend constexpr bool
+    operator==(Base58String const& lhs, Base58String const& rhs)
+    {
+        return lhs.view() == rhs.view();
+    }
+
+    friend constexpr std::strong_ordering
+    operator<=>(Base58String const& lhs, Base58String const& rhs)
+    {
+        return lhs.view() <=> rhs.view();
+    }
+
+private:
+    std::uint8_t size_ = 0;
+    // Zeroed so a `constexpr` string is fully initialized
+    std::array<char, capacity> data_{};
+};
+
+namespace b58_fast {
+// The name the inline codecs first returned it under
+using Base58String = ripple::Base58String;
+}  // namespace b58_fast
+
+}  // namespace ripple
+
+template <>
+struct std::hash<ripple::Base58String>
+{
+    std::size_t
+    operator()(ripple::Base58String const& s) const noexcept
+    {
+        return std::hash<std::string_view>{}(s.view());
+    }
+};
+
+#endif
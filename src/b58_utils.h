@@ -1,13 +1,18 @@
+#include <boost/endian/conversion.hpp>
 #include <boost/outcome.hpp>
 #include <boost/outcome/result.hpp>
 
+#include <array>
+#include <bit>
 #include <cassert>
 #include <cinttypes>
+#include <cstring>
 #include <span>
 #include <string>  // for logic error
 #include <tuple>
+#include <utility>
 
-#ifndef _MSC_VER
+#if !defined(_MSC_VER) && !defined(XRPL_B58_PORTABLE)
 namespace b58_fast {
 namespace detail {
 template <class T>
@@ -101,54 +106,425 @@ inplace_bigint_mul(std::span<std::uint64_t> a, std::uint64_t b)
     }
     a[last_index] = carry;
 }
+// divide the 128 bit value `high:low` by a 64 bit value. The caller must
+// ensure the quotient fits in 64 bits (i.e. `high` is less than `denom`)
+[[nodiscard]] inline std::tuple<std::uint64_t, std::uint64_t>
+div_rem_64(std::uint64_t high, std::uint64_t low, std::uint64_t denom)
+{
+#if defined(__x86_64__)
+    // The compiler can't prove the quotient fits in 64 bits, so it calls a
+    // 128 bit division routine instead of using a single divide instruction
+    std::uint64_t q, r;
+    asm("divq %4" : "=a"(q), "=d"(r) : "a"(low), "d"(high), "rm"(denom));
+    return {q, r};
+#else
+    unsigned __int128 num = high;
+    num = (num << 64) | low;
+    unsigned __int128 denom128 = denom;
+    unsigned __int128 d = num / denom128;
+    unsigned __int128 r = num % denom128;
+    return {static_cast<std::uint64_t>(d), static_cast<std::uint64_t>(r)};
+#endif
+}
+
 // divide a "big uint" value inplace and return the mod
 // numerator is stored so smallest coefficients come first
 [[nodiscard]] inline std::uint64_t
 inplace_bigint_div_rem(std::span<uint64_t> numerator, std::uint64_t divisor)
 {
-    auto to_u128 = [](std::uint64_t high,
-                      std::uint64_t low) -> unsigned __int128 {
-        unsigned __int128 result = high;
-        unsigned __int128 low128 = low;
-        return ((result << 64) | low128);
-    };
-    auto div_rem_64 =
-        [](unsigned __int128 num,
-           std::uint64_t denom) -> std::tuple<std::uint64_t, std::uint64_t> {
-        unsigned __int128 denom128 = denom;
-        unsigned __int128 d = num / denom128;
-        unsigned __int128 r = num % denom128;
-        return {static_cast<std::uint64_t>(d), static_cast<std::uint64_t>(r)};
-    };
-
     std::uint64_t prev_rem;
     std::size_t const last_index = numerator.size() - 1;
     std::tie(numerator[last_index], prev_rem) =
         div_rem(numerator[last_index], divisor);
     for (int i = last_index - 1; i >= 0; --i)
     {
-        unsigned __int128 cur_num = to_u128(prev_rem, numerator[i]);
-        std::tie(numerator[i], prev_rem) = div_rem_64(cur_num, divisor);
+        std::tie(numerator[i], prev_rem) =
+            div_rem_64(prev_rem, numerator[i], divisor);
     }
     return prev_rem;
 }
 
+// divide a fixed size "big uint" value inplace and return the mod. The number
+// of coefficients is known at compile time, so the loop is fully unrolled.
+template <std::size_t N>
+    requires(N != std::dynamic_extent)
+[[nodiscard]] inline std::uint64_t
+inplace_bigint_div_rem(
+    std::span<std::uint64_t, N> numerator,
+    std::uint64_t divisor)
+{
+    static_assert(N > 0);
+    std::uint64_t prev_rem;
+    std::tie(numerator[N - 1], prev_rem) = div_rem(numerator[N - 1], divisor);
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+        ((std::tie(numerator[N - 2 - I], prev_rem) =
+              div_rem_64(prev_rem, numerator[N - 2 - I], divisor)),
+         ...);
+    }(std::make_index_sequence<N - 1>{});
+    return prev_rem;
+}
+
+// Compute `a * b + c` inplace for a fixed size "big uint" value and return
+// the carry out of the most significant coefficient. The loop is fully
+// unrolled.
+template <std::size_t N>
+[[nodiscard]] inline std::uint64_t
+inplace_bigint_mul_add(
+    std::span<std::uint64_t, N> a,
+    std::uint64_t b,
+    std::uint64_t c)
+{
+    static_assert(N != std::dynamic_extent);
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+        ((std::tie(a[I], c) = carrying_mul(a[I], b, c)), ...);
+    }(std::make_index_sequence<N>{});
+    return c;
+}
+
+// Division by a constant with a precomputed reciprocal instead of a divide
+// instruction. Hardware divides are slow and can't be pipelined; this takes
+// two multiplies and a few adds. See Moller and Granlund, "Improved division
+// by invariant integers" (2011).
+template <std::uint64_t Divisor>
+struct invariant_divisor
+{
+    static_assert(Divisor != 0);
+
+    // The divisor shifted so its high bit is set
+    static constexpr int shift = std::countl_zero(Divisor);
+    static constexpr std::uint64_t normalized = Divisor << shift;
+    // floor((2^128 - 1) / normalized) - 2^64
+    static constexpr std::uint64_t reciprocal = static_cast<std::uint64_t>(
+        ~static_cast<unsigned __int128>(0) / normalized);
+
+    // divide the normalized 128 bit value `u1:u0` by the normalized divisor.
+    // `u1` must be less than `normalized`. The remainder is normalized too.
+    [[nodiscard]] static std::tuple<std::uint64_t, std::uint64_t>
+    div_rem_normalized(std::uint64_t u1, std::uint64_t u0)
+    {
+        unsigned __int128 const q = static_cast<unsigned __int128>(reciprocal) *
+                u1 +
+            ((static_cast<unsigned __int128>(u1) << 64) | u0);
+        std::uint64_t q1 = static_cast<std::uint64_t>(q >> 64) + 1;
+        std::uint64_t const q0 = static_cast<std::uint64_t>(q);
+        std::uint64_t r = u0 - q1 * normalized;
+        // The estimate is at most one too large or one too small. The first
+        // correction is unpredictable, so keep it branch free.
+        std::uint64_t const too_large = -static_cast<std::uint64_t>(r > q0);
+        q1 += too_large;
+        r += normalized & too_large;
+        if (r >= normalized) [[unlikely]]
+        {
+            q1 += 1;
+            r -= normalized;
+        }
+        return {q1, r};
+    }
+
+    // divide the 128 bit value `high:low` by the divisor. The caller must
+    // ensure the quotient fits in 64 bits (i.e. `high` is less than the
+    // divisor)
+    [[nodiscard]] static std::tuple<std::uint64_t, std::uint64_t>
+    div_rem(std::uint64_t high, std::uint64_t low)
+    {
+        auto const [q, r] = div_rem_normalized(
+            (high << shift) | low_bits(low), low << shift);
+        return {q, r >> shift};
+    }
+
+    // The bits of `low` shifted into the high word by normalization
+    [[nodiscard]] static std::uint64_t
+    low_bits(std::uint64_t low)
+    {
+        if constexpr (shift == 0)
+            return 0;
+        else
+            return low >> (64 - shift);
+    }
+};
+
+// divide a "big uint" value inplace by a constant and return the mod
+// numerator is stored so smallest coefficients come first. A fixed size
+// numerator is fully unrolled.
+template <std::uint64_t Divisor, std::size_t N>
+[[nodiscard]] inline std::uint64_t
+inplace_bigint_div_rem_by(std::span<std::uint64_t, N> numerator)
+{
+    using divisor = invariant_divisor<Divisor>;
+    // The remainder is kept normalized between coefficients, which keeps the
+    // normalization shifts off the dependency chain
+    std::uint64_t prev_rem = 0;
+    auto step = [&](std::uint64_t& coeff) {
+        std::tie(coeff, prev_rem) = divisor::div_rem_normalized(
+            prev_rem | divisor::low_bits(coeff), coeff << divisor::shift);
+    };
+    if constexpr (N == std::dynamic_extent)
+    {
+        for (std::size_t i = numerator.size(); i-- > 0;)
+            step(numerator[i]);
+    }
+    else
+    {
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (step(numerator[N - 1 - I]), ...);
+        }(std::make_index_sequence<N>{});
+    }
+    return prev_rem >> divisor::shift;
+}
+
+// divide `Lanes` independent "big uint" values inplace by a constant and
+// return the mods. The values are stored structure-of-arrays:
+// numerator[i][lane] is the 2^(64*i) coefficient of the value in `lane`
+// (smallest coefficients first). Each lane is its own chain of dependent
+// divides; stepping all the lanes together lets the cpu overlap the chains
+// instead of waiting on one.
+template <std::uint64_t Divisor, std::size_t Lanes>
+[[nodiscard]] inline std::array<std::uint64_t, Lanes>
+inplace_bigint_div_rem_lanes(
+    std::span<std::array<std::uint64_t, Lanes>> numerator)
+{
+    using divisor = invariant_divisor<Divisor>;
+    // remainders are kept normalized, see `inplace_bigint_div_rem_by`
+    std::array<std::uint64_t, Lanes> prev_rem{};
+    for (std::size_t i = numerator.size(); i-- > 0;)
+    {
+        for (std::size_t lane = 0; lane < Lanes; ++lane)
+        {
+            auto& coeff = numerator[i][lane];
+            std::tie(coeff, prev_rem[lane]) = divisor::div_rem_normalized(
+                prev_rem[lane] | divisor::low_bits(coeff),
+                coeff << divisor::shift);
+        }
+    }
+    for (auto& r : prev_rem)
+        r >>= divisor::shift;
+    return prev_rem;
+}
+
+// A "big uint" of exactly `N` base 2^64 coeffs (smallest coeff first). The
+// width is known at compile time, so every operation is fully unrolled; the
+// codecs pick the smallest width that holds their input.
+template <std::size_t N>
+struct fixed_bigint
+{
+    static_assert(N > 0 && N != std::dynamic_extent);
+    static constexpr std::size_t num_limbs = N;
+
+    std::array<std::uint64_t, N> limbs{};
+
+    // Load a big endian value of at most `N * 8` bytes
+    [[nodiscard]] static fixed_bigint
+    from_be_bytes(std::span<std::uint8_t const> bytes)
+    {
+        assert(bytes.size() <= N * 8);
+        // right align the value so the unused high bytes are zero
+        std::array<std::uint8_t, N * 8> buf{};
+        std::memcpy(
+            &buf[buf.size() - bytes.size()], bytes.data(), bytes.size());
+        fixed_bigint result;
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            ((result.limbs[I] = boost::endian::load_big_u64(
+                  &buf[buf.size() - (I + 1) * 8])),
+             ...);
+        }(std::make_index_sequence<N>{});
+        return result;
+    }
+
+    // Store the value as `N * 8` big endian bytes
+    void
+    to_be_bytes(std::span<std::uint8_t, N * 8> out) const
+    {
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (boost::endian::store_big_u64(&out[(N - 1 - I) * 8], limbs[I]),
+             ...);
+        }(std::make_index_sequence<N>{});
+    }
+
+    // this = this * b + c. Returns the carry out of the top coeff.
+    [[nodiscard]] std::uint64_t
+    mul_add(std::uint64_t b, std::uint64_t c)
+    {
+        return inplace_bigint_mul_add(std::span(limbs), b, c);
+    }
+
+    // Divide the lowest `Limbs` coeffs by a constant and return the mod. The
+    // caller must ensure the coeffs above `Limbs` are zero.
+    template <std::uint64_t Divisor, std::size_t Limbs = N>
+    [[nodiscard]] std::uint64_t
+    div_rem_by()
+    {
+        static_assert(Limbs > 0 && Limbs <= N);
+        return inplace_bigint_div_rem_by<Divisor>(
+            std::span(limbs).template first<Limbs>());
+    }
+};
+
+// Call `f.template operator()<N>()` with the runtime value `n` in [1, Max]
+// as a compile time constant. This dispatches to the smallest instantiation
+// of a fixed width conversion that holds a value.
+template <std::size_t Max, class F>
+decltype(auto)
+with_fixed_width(std::size_t n, F&& f)
+{
+    assert(n > 0 && n <= Max);
+    using R = decltype(f.template operator()<1>());
+    return [&]<std::size_t... I>(std::index_sequence<I...>) -> R {
+        using Fn = R (*)(F&);
+        static constexpr std::array<Fn, Max> table{
+            [](F& g) -> R { return g.template operator()<I + 1>(); }...};
+        return table[n - 1](f);
+    }(std::make_index_sequence<Max>{});
+}
+
+// Max number of base 58 digits in the encoding of `size` bytes:
+// ceil(size * 8 / log(58, 2)). A leading zero byte is encoded as a single
+// digit, so leading zeros never make the encoding longer.
+constexpr std::size_t
+b58_digits_for_size(std::size_t size)
+{
+    // log(58, 2) ~= 5.857981
+    return (size * 8 * 1000000 + 5857980) / 5857981;
+}
+
+// Number of base 2^64 coeffs needed to hold a value with `n` base 58^10
+// coeffs (58^10 < 2^59)
+constexpr std::size_t
+b256_limbs_for_58_10_coeffs(std::size_t n)
+{
+    return (n * 59 + 63) / 64;
+}
+
+// 58^(10 * k) in base 2^64 (smallest coeff first), for k in [0, 6). Enough
+// for the largest fixed size token: 38 bytes need 6 base 58^10 coeffs.
+inline constexpr std::array<std::array<std::uint64_t, 5>, 6> b58_10_powers =
+    []() {
+        constexpr std::uint64_t B_58_10 = 430804206899405824;  // 58^10;
+        std::array<std::array<std::uint64_t, 5>, 6> powers{};
+        powers[0][0] = 1;
+        for (std::size_t k = 1; k < powers.size(); ++k)
+        {
+            unsigned __int128 carry = 0;
+            for (std::size_t i = 0; i < powers[k].size(); ++i)
+            {
+                carry += static_cast<unsigned __int128>(powers[k - 1][i]) *
+                    B_58_10;
+                powers[k][i] = static_cast<std::uint64_t>(carry);
+                carry >>= 64;
+            }
+        }
+        return powers;
+    }();
+
+// 58^e in base 2^64 (smallest coeff first), for e in [0, 52]. A value of at
+// most 38 bytes is less than 58^52, so comparing it with these gives its
+// number of base 58 digits.
+inline constexpr std::array<std::array<std::uint64_t, 5>, 53> b58_powers =
+    []() {
+        std::array<std::array<std::uint64_t, 5>, 53> powers{};
+        powers[0][0] = 1;
+        for (std::size_t e = 1; e < powers.size(); ++e)
+        {
+            unsigned __int128 carry = 0;
+            for (std::size_t i = 0; i < powers[e].size(); ++i)
+            {
+                carry += static_cast<unsigned __int128>(powers[e - 1][i]) * 58;
+                powers[e][i] = static_cast<std::uint64_t>(carry);
+                carry >>= 64;
+            }
+        }
+        return powers;
+    }();
+
+// Convert base 58^10 coeffs (largest coeff first) to base 2^64 (smallest
+// coeff first) with Horner's rule: multiply the value so far by 58^10 and add
+// the next coeff. Every step depends on the one before.
+template <std::size_t NumCoeffs>
+[[nodiscard]] inline std::array<
+    std::uint64_t,
+    b256_limbs_for_58_10_coeffs(NumCoeffs)>
+b58_10_to_b256_horner(std::span<std::uint64_t const, NumCoeffs> coeffs)
+{
+    static_assert(NumCoeffs > 0);
+    constexpr std::uint64_t B_58_10 = 430804206899405824;  // 58^10;
+    std::array<std::uint64_t, b256_limbs_for_58_10_coeffs(NumCoeffs)> result{};
+    result[0] = coeffs[0];
+    [[maybe_unused]] std::uint64_t carry = 0;
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+        ((carry |= inplace_bigint_mul_add(
+              std::span(result)
+                  .template first<b256_limbs_for_58_10_coeffs(I + 2)>(),
+              B_58_10,
+              coeffs[I + 1])),
+         ...);
+    }(std::make_index_sequence<NumCoeffs - 1>{});
+    assert(carry == 0);
+    return result;
+}
+
+// Convert base 58^10 coeffs (largest coeff first) to base 2^64 (smallest
+// coeff first) by multiplying each coeff by its power of 58^10 and summing
+// the products. Unlike Horner's rule the multiplies are independent, so the
+// cpu can overlap them. Each product is less than 2^123, so a column sum of
+// at most six products fits in 128 bits; carries are propagated once, at the
+// end.
+template <std::size_t NumCoeffs>
+[[nodiscard]] inline std::array<
+    std::uint64_t,
+    b256_limbs_for_58_10_coeffs(NumCoeffs)>
+b58_10_to_b256_powers(std::span<std::uint64_t const, NumCoeffs> coeffs)
+{
+    static_assert(NumCoeffs > 0 && NumCoeffs <= b58_10_powers.size());
+    constexpr std::size_t num_limbs = b256_limbs_for_58_10_coeffs(NumCoeffs);
+    std::array<unsigned __int128, num_limbs> columns{};
+    auto add_product = [&]<std::size_t K>() {
+        constexpr std::size_t power = NumCoeffs - 1 - K;
+        constexpr std::size_t power_limbs =
+            power ? b256_limbs_for_58_10_coeffs(power) : 1;
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            ((columns[I] += static_cast<unsigned __int128>(coeffs[K]) *
+                  b58_10_powers[power][I]),
+             ...);
+        }(std::make_index_sequence<power_limbs>{});
+    };
+    [&]<std::size_t... K>(std::index_sequence<K...>) {
+        (add_product.template operator()<K>(), ...);
+    }(std::make_index_sequence<NumCoeffs>{});
+
+    std::array<std::uint64_t, num_limbs> result;
+    unsigned __int128 carry = 0;
+    for (std::size_t i = 0; i < num_limbs; ++i)
+    {
+        carry += columns[i];
+        result[i] = static_cast<std::uint64_t>(carry);
+        carry >>= 64;
+    }
+    assert(carry == 0);
+    return result;
+}
+
 // convert from base 58^10 to base 58
 // put largest coeffs first
 [[nodiscard]] inline std::array<std::uint8_t, 10>
 b58_10_to_b58_be(std::uint64_t input)
 {
+    assert(input < 430804206899405824);  // 58^10
+    // The input is less than 2^59, so multiplying by ceil(2^69 / 58) and
+    // shifting right by 69 gives the exact quotient (Granlund and Montgomery,
+    // "Division by invariant integers using multiplication").
+    constexpr std::uint64_t reciprocal_58 = static_cast<std::uint64_t>(
+        ((static_cast<unsigned __int128>(1) << 69) + 57) / 58);
     constexpr std::size_t resultSize = 10;
-    std::array<std::uint8_t, resultSize> result{};
-    int i = 0;
-    while (input > 0)
+    std::array<std::uint8_t, resultSize> result;
+    for (std::size_t i = resultSize; i-- > 0;)
     {
-        std::uint64_t rem;
-        std::tie(input, rem) = div_rem(input, 58);
-        result[resultSize - 1 - i] = rem;
-        i += 1;
+        std::uint64_t const q = static_cast<std::uint64_t>(
+                                    (static_cast<unsigned __int128>(input) *
+                                     reciprocal_58) >>
+                                    64) >>
+            5;
+        result[i] = input - q * 58;
+        input = q;
     }
-    assert(i <= 10);
 
     return result;
 }
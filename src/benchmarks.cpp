@@ -1,12 +1,30 @@
 #include <benchmark/benchmark.h>
 
+#include "b58_cache.h"
+#include "b58_index.h"
+#include "b58_kernels.h"
+#include "b58_large.h"
+#include "b58_parallel.h"
+#include "b58_stream.h"
+#include "b58_utils.h"
+#include "digest.h"
 #include "test_utils.h"
 #include "tokens.h"
 
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <memory>
 #include <random>
 #include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
 
 static void
 BM_ref_encode(benchmark::State& state)
@@ -32,7 +50,35 @@ BM_ref_encode(benchmark::State& state)
 }
 BENCHMARK(BM_ref_encode);
 
-#ifndef _MSC_VER
+// The 32-bit limb codecs, for platforms without unsigned __int128
+static void
+BM_portable_encode(benchmark::State& state)
+{
+    constexpr std::size_t numToEncode = 256;
+    std::array<std::array<std::uint8_t, numToEncode>, numToEncode> b256DataBufs;
+    std::array<std::tuple<ripple::TokenType, std::span<uint8_t>>, numToEncode>
+        toEncode;
+    std::array<std::uint8_t, 128> outBuf{};
+    for (int i = 0; i < numToEncode; ++i)
+    {
+        toEncode[i] = random_b256_test_data(
+            std::span(b256DataBufs[i].data(), b256DataBufs[i].size()));
+    }
+    for (auto _ : state)
+    {
+        for (int i = 0; i < numToEncode; ++i)
+        {
+            auto& [tokType, inSpan] = toEncode[i];
+            auto r = ripple::b58_portable::encodeBase58Token(
+                tokType, inSpan, outBuf);
+            benchmark::DoNotOptimize(r);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numToEncode);
+}
+BENCHMARK(BM_portable_encode);
+
+#if !defined(_MSC_VER) && !defined(XRPL_B58_PORTABLE)
 static void
 BM_encode_non_ms(benchmark::State& state)
 {
@@ -83,6 +129,293 @@ BM_new_encode(benchmark::State& state)
     }
 }
 BENCHMARK(BM_new_encode);
+
+static void
+BM_fixed_encode(benchmark::State& state)
+{
+    constexpr std::size_t numToEncode = 256;
+    using AccountIDPayload =
+        ripple::b58_fast::TokenPayload<ripple::TokenType::AccountID>;
+    std::array<AccountIDPayload, numToEncode> toEncode;
+    std::array<std::uint8_t, 128> outBuf{};
+    std::span<std::uint8_t> outSpan(outBuf.data(), outBuf.size());
+    auto& rng = randEngine();
+    std::uniform_int_distribution<std::uint8_t> dist(0, 255);
+    for (auto& payload : toEncode)
+    {
+        std::generate(
+            payload.begin(), payload.end(), [&] { return dist(rng); });
+    }
+    for (auto _ : state)
+    {
+        for (auto const& payload : toEncode)
+        {
+            auto r = ripple::b58_fast::encode<ripple::TokenType::AccountID>(
+                payload, outSpan);
+            benchmark::DoNotOptimize(r);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numToEncode);
+}
+BENCHMARK(BM_fixed_encode);
+
+static void
+BM_new_encode_loop(benchmark::State& state)
+{
+    std::size_t const numToEncode = state.range(0);
+    std::vector<std::array<std::uint8_t, 33>> b256DataBufs(numToEncode);
+    std::vector<std::span<std::uint8_t const>> toEncode;
+    auto const tokType = ripple::TokenType::AccountID;
+    std::uniform_int_distribution<std::uint8_t> dist(0, 255);
+    for (auto& b : b256DataBufs)
+    {
+        std::generate(b.begin(), b.end(), [&] { return dist(randEngine()); });
+        toEncode.emplace_back(b.data(), 20);
+    }
+    std::array<std::uint8_t, 128> outBuf{};
+    std::span<std::uint8_t> outSpan(outBuf.data(), outBuf.size());
+    for (auto _ : state)
+    {
+        for (auto const& inSpan : toEncode)
+        {
+            auto r =
+                ripple::b58_fast::encodeBase58Token(tokType, inSpan, outSpan);
+            benchmark::DoNotOptimize(r);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numToEncode);
+}
+BENCHMARK(BM_new_encode_loop)->Arg(1)->Arg(8)->Arg(64)->Arg(1024);
+
+static void
+BM_new_encode_batch(benchmark::State& state)
+{
+    std::size_t const numToEncode = state.range(0);
+    std::vector<std::array<std::uint8_t, 33>> b256DataBufs(numToEncode);
+    std::vector<std::span<std::uint8_t const>> toEncode;
+    auto const tokType = ripple::TokenType::AccountID;
+    std::uniform_int_distribution<std::uint8_t> dist(0, 255);
+    for (auto& b : b256DataBufs)
+    {
+        std::generate(b.begin(), b.end(), [&] { return dist(randEngine()); });
+        toEncode.emplace_back(b.data(), 20);
+    }
+    std::vector<std::uint8_t> arena(
+        numToEncode * ripple::b58_fast::encodedSizeUpperBound(20));
+    std::vector<std::span<std::uint8_t>> outTokens(numToEncode);
+    for (auto _ : state)
+    {
+        auto r = ripple::b58_fast::encodeBase58TokenBatch(
+            tokType, toEncode, arena, outTokens);
+        if (!r)
+            state.SkipWithError(r.error().message().c_str());
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetItemsProcessed(state.iterations() * numToEncode);
+}
+BENCHMARK(BM_new_encode_batch)->Arg(1)->Arg(8)->Arg(64)->Arg(1024);
+
+// Expanded tokens (type + payload + checksum) and their encodings, for the
+// kernel benchmarks
+static auto
+kernel_test_data(std::size_t n)
+{
+    std::vector<std::string> encoded;
+    std::vector<std::vector<std::uint8_t>> expanded;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        std::array<std::uint8_t, 64> b256DataBuf;
+        auto [tokType, span] = random_b256_test_data(b256DataBuf);
+        encoded.push_back(ripple::b58_fast::encodeBase58Token(
+            tokType, span.data(), span.size()));
+        std::vector<std::uint8_t> e(64);
+        auto const r = ripple::b58_fast::detail::b58_to_b256(encoded.back(), e);
+        e.resize(r.value().size());
+        expanded.push_back(std::move(e));
+    }
+    return std::make_tuple(std::move(encoded), std::move(expanded));
+}
+
+// The last stage of every encode: base 58^10 coeffs to alphabet characters
+static void
+BM_digits_to_alphabet(benchmark::State& state)
+{
+    namespace detail = ripple::b58_fast::detail;
+    constexpr std::size_t numToEncode = 256;
+    // AccountIDs need five base 58^10 coeffs
+    constexpr std::size_t numCoeffs = 5;
+    auto& rng = randEngine();
+    std::uniform_int_distribution<std::uint64_t> dist(
+        1, 430804206899405823);  // [1, 58^10)
+    std::array<std::array<std::uint64_t, numCoeffs>, numToEncode> coeffs;
+    for (auto& c : coeffs)
+        std::generate(c.begin(), c.end(), [&] { return dist(rng); });
+    std::array<std::uint8_t, 64> outBuf;
+    for (auto _ : state)
+    {
+        for (auto const& c : coeffs)
+        {
+            auto r = detail::b58_10_to_alphabet(c, 0, outBuf);
+            benchmark::DoNotOptimize(r);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numToEncode);
+}
+BENCHMARK(BM_digits_to_alphabet);
+
+static void
+BM_b58_to_digits(benchmark::State& state)
+{
+    using namespace ripple::b58_fast;
+    namespace detail = ripple::b58_fast::detail;
+    auto const kernel = static_cast<CodecKernel>(state.range(0));
+    if (!kernelSupported(kernel))
+    {
+        state.SkipWithError("kernel not supported");
+        return;
+    }
+    auto const translate = detail::b58ToDigits(kernel);
+    constexpr std::size_t numToDecode = 256;
+    auto const [encoded, _] = kernel_test_data(numToDecode);
+    std::array<std::uint8_t, 64> digits;
+    std::size_t leadingZeros;
+    for (auto _ : state)
+    {
+        for (auto const& s : encoded)
+        {
+            auto r = translate(s, digits, leadingZeros);
+            benchmark::DoNotOptimize(r);
+            benchmark::DoNotOptimize(digits);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numToDecode);
+}
+BENCHMARK(BM_b58_to_digits)
+    ->Arg(static_cast<int>(ripple::b58_fast::CodecKernel::scalar))
+    ->Arg(static_cast<int>(ripple::b58_fast::CodecKernel::avx2))
+    ->Arg(static_cast<int>(ripple::b58_fast::CodecKernel::avx512));
+
+// Base 58^10 to base 2^64 conversion of a decode, by payload size
+enum class DecodeEngine { horner, powers };
+
+template <std::size_t PayloadSize, DecodeEngine Engine>
+static void
+BM_b58_10_to_b256(benchmark::State& state)
+{
+    namespace detail = ::b58_fast::detail;
+    // type + payload + checksum
+    constexpr std::size_t numCoeffs =
+        (detail::b58_digits_for_size(PayloadSize + 5) + 9) / 10;
+    constexpr std::size_t numToDecode = 256;
+    auto& rng = randEngine();
+    std::uniform_int_distribution<std::uint64_t> dist(
+        0, 430804206899405823);  // [0, 58^10)
+    std::array<std::array<std::uint64_t, numCoeffs>, numToDecode> coeffs;
+    for (auto& c : coeffs)
+        std::generate(c.begin(), c.end(), [&] { return dist(rng); });
+    for (auto _ : state)
+    {
+        for (auto const& c : coeffs)
+        {
+            std::span<std::uint64_t const, numCoeffs> const in(c);
+            if constexpr (Engine == DecodeEngine::horner)
+            {
+                auto r = detail::b58_10_to_b256_horner(in);
+                benchmark::DoNotOptimize(r);
+            }
+            else
+            {
+                auto r = detail::b58_10_to_b256_powers(in);
+                benchmark::DoNotOptimize(r);
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numToDecode);
+}
+BENCHMARK_TEMPLATE(BM_b58_10_to_b256, 16, DecodeEngine::horner);
+BENCHMARK_TEMPLATE(BM_b58_10_to_b256, 16, DecodeEngine::powers);
+BENCHMARK_TEMPLATE(BM_b58_10_to_b256, 20, DecodeEngine::horner);
+BENCHMARK_TEMPLATE(BM_b58_10_to_b256, 20, DecodeEngine::powers);
+BENCHMARK_TEMPLATE(BM_b58_10_to_b256, 32, DecodeEngine::horner);
+BENCHMARK_TEMPLATE(BM_b58_10_to_b256, 32, DecodeEngine::powers);
+BENCHMARK_TEMPLATE(BM_b58_10_to_b256, 33, DecodeEngine::horner);
+BENCHMARK_TEMPLATE(BM_b58_10_to_b256, 33, DecodeEngine::powers);
+
+static void
+BM_kernel_encode(benchmark::State& state)
+{
+    using namespace ripple::b58_fast;
+    namespace detail = ripple::b58_fast::detail;
+    constexpr std::size_t lanes = detail::kernelLanes;
+    auto const kernel = static_cast<CodecKernel>(state.range(0));
+    if (!kernelSupported(kernel))
+    {
+        state.SkipWithError("kernel not supported");
+        return;
+    }
+    constexpr std::size_t numToEncode = 256;
+    auto const [_, expanded] = kernel_test_data(numToEncode);
+    std::array<std::span<std::uint8_t const>, numToEncode> in;
+    for (std::size_t i = 0; i < numToEncode; ++i)
+        in[i] = expanded[i];
+    std::array<std::array<std::uint8_t, 64>, lanes> outBufs;
+    std::array<std::span<std::uint8_t>, lanes> out;
+    std::array<TokenCodecErrc, lanes> status;
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0; i < numToEncode; i += lanes)
+        {
+            for (std::size_t lane = 0; lane < lanes; ++lane)
+                out[lane] = outBufs[lane];
+            detail::b256_to_b58_kernel(
+                kernel, std::span(&in[i], lanes), out, status);
+            benchmark::DoNotOptimize(out);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numToEncode);
+}
+BENCHMARK(BM_kernel_encode)
+    ->Arg(static_cast<int>(ripple::b58_fast::CodecKernel::scalar))
+    ->Arg(static_cast<int>(ripple::b58_fast::CodecKernel::avx2))
+    ->Arg(static_cast<int>(ripple::b58_fast::CodecKernel::avx512));
+
+static void
+BM_kernel_decode(benchmark::State& state)
+{
+    using namespace ripple::b58_fast;
+    namespace detail = ripple::b58_fast::detail;
+    constexpr std::size_t lanes = detail::kernelLanes;
+    auto const kernel = static_cast<CodecKernel>(state.range(0));
+    if (!kernelSupported(kernel))
+    {
+        state.SkipWithError("kernel not supported");
+        return;
+    }
+    constexpr std::size_t numToDecode = 256;
+    auto const [encoded, _] = kernel_test_data(numToDecode);
+    std::array<std::string_view, numToDecode> in;
+    for (std::size_t i = 0; i < numToDecode; ++i)
+        in[i] = encoded[i];
+    std::array<std::array<std::uint8_t, 64>, lanes> outBufs;
+    std::array<std::span<std::uint8_t>, lanes> out;
+    std::array<TokenCodecErrc, lanes> status;
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0; i < numToDecode; i += lanes)
+        {
+            for (std::size_t lane = 0; lane < lanes; ++lane)
+                out[lane] = outBufs[lane];
+            detail::b58_to_b256_kernel(
+                kernel, std::span(&in[i], lanes), out, status);
+            benchmark::DoNotOptimize(out);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numToDecode);
+}
+BENCHMARK(BM_kernel_decode)
+    ->Arg(static_cast<int>(ripple::b58_fast::CodecKernel::scalar))
+    ->Arg(static_cast<int>(ripple::b58_fast::CodecKernel::avx2))
+    ->Arg(static_cast<int>(ripple::b58_fast::CodecKernel::avx512));
 #endif
 
 static void
@@ -112,7 +445,37 @@ BM_ref_decode(benchmark::State& state)
 }
 BENCHMARK(BM_ref_decode);
 
-#ifndef _MSC_VER
+static void
+BM_portable_decode(benchmark::State& state)
+{
+    constexpr std::size_t numToDecode = 256;
+    std::array<std::tuple<ripple::TokenType, std::string>, numToDecode>
+        toDecode;
+    std::array<std::uint8_t, 128> outBuf{};
+    for (int i = 0; i < numToDecode; ++i)
+    {
+        std::array<std::uint8_t, numToDecode> b256DataBuf;
+        auto [tokType, span] = random_b256_test_data(
+            std::span(b256DataBuf.data(), b256DataBuf.size()));
+        auto s = ripple::b58_ref::encodeBase58Token(
+            tokType, span.data(), span.size());
+        toDecode[i] = std::tie(tokType, s);
+    }
+    for (auto _ : state)
+    {
+        for (int i = 0; i < numToDecode; ++i)
+        {
+            auto& [tokType, s] = toDecode[i];
+            auto r =
+                ripple::b58_portable::decodeBase58Token(tokType, s, outBuf);
+            benchmark::DoNotOptimize(r);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numToDecode);
+}
+BENCHMARK(BM_portable_decode);
+
+#if !defined(_MSC_VER) && !defined(XRPL_B58_PORTABLE)
 static void
 BM_decode_non_ms(benchmark::State& state)
 {
@@ -166,6 +529,786 @@ BM_new_decode(benchmark::State& state)
     }
 }
 BENCHMARK(BM_new_decode);
+
+static void
+BM_fixed_decode(benchmark::State& state)
+{
+    constexpr std::size_t numToDecode = 256;
+    std::array<std::string, numToDecode> toDecode;
+    auto& rng = randEngine();
+    std::uniform_int_distribution<std::uint8_t> dist(0, 255);
+    for (auto& s : toDecode)
+    {
+        std::array<std::uint8_t, 20> payload;
+        std::generate(
+            payload.begin(), payload.end(), [&] { return dist(rng); });
+        s = ripple::encodeBase58Token(
+            ripple::TokenType::AccountID, payload.data(), payload.size());
+    }
+    for (auto _ : state)
+    {
+        for (auto const& s : toDecode)
+        {
+            auto r = ripple::b58_fast::decode<ripple::TokenType::AccountID>(s);
+            benchmark::DoNotOptimize(r);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numToDecode);
+}
+BENCHMARK(BM_fixed_decode);
+
+// Tokens of sizes other than the fixed payload sizes, up to the largest one
+// `encodeBase58Token` accepts
+static void
+BM_sized_encode(benchmark::State& state)
+{
+    constexpr std::size_t numToEncode = 256;
+    std::size_t const size = state.range(0);
+    auto& rng = randEngine();
+    std::uniform_int_distribution<std::uint8_t> dist(0, 255);
+    std::vector<std::vector<std::uint8_t>> payloads(numToEncode);
+    for (auto& p : payloads)
+    {
+        p.resize(size);
+        std::generate(p.begin(), p.end(), [&] { return dist(rng); });
+    }
+    std::array<std::uint8_t, ripple::b58_fast::maxBase58TokenChars> outBuf;
+    for (auto _ : state)
+    {
+        for (auto const& p : payloads)
+        {
+            auto r = ripple::b58_fast::encodeBase58Token(
+                ripple::TokenType::None, p, outBuf);
+            benchmark::DoNotOptimize(r);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numToEncode);
+}
+BENCHMARK(BM_sized_encode)->Arg(8)->Arg(48)->Arg(64)->Arg(96)->Arg(123);
+
+static void
+BM_sized_decode(benchmark::State& state)
+{
+    constexpr std::size_t numToDecode = 256;
+    std::size_t const size = state.range(0);
+    auto& rng = randEngine();
+    std::uniform_int_distribution<std::uint8_t> dist(0, 255);
+    std::vector<std::string> toDecode(numToDecode);
+    for (auto& s : toDecode)
+    {
+        std::vector<std::uint8_t> payload(size);
+        std::generate(
+            payload.begin(), payload.end(), [&] { return dist(rng); });
+        s = ripple::b58_ref::encodeBase58Token(
+            ripple::TokenType::None, payload.data(), payload.size());
+    }
+    std::array<std::uint8_t, 128> outBuf;
+    for (auto _ : state)
+    {
+        for (auto const& s : toDecode)
+        {
+            auto r = ripple::b58_fast::decodeBase58Token(
+                ripple::TokenType::None, s, outBuf);
+            benchmark::DoNotOptimize(r);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numToDecode);
+}
+BENCHMARK(BM_sized_decode)->Arg(8)->Arg(48)->Arg(64)->Arg(96)->Arg(123);
+
+// AccountIDs decoded without verifying the checksum
+static void
+BM_trusted_decode(benchmark::State& state)
+{
+    constexpr std::size_t numToDecode = 256;
+    std::array<std::string, numToDecode> toDecode;
+    auto& rng = randEngine();
+    std::uniform_int_distribution<std::uint8_t> dist(0, 255);
+    for (auto& s : toDecode)
+    {
+        std::array<std::uint8_t, 20> payload;
+        std::generate(
+            payload.begin(), payload.end(), [&] { return dist(rng); });
+        s = ripple::encodeBase58Token(
+            ripple::TokenType::AccountID, payload.data(), payload.size());
+    }
+    for (auto _ : state)
+    {
+        for (auto const& s : toDecode)
+        {
+            auto r = ripple::b58_fast::decodeTrusted<
+                ripple::TokenType::AccountID>(s);
+            benchmark::DoNotOptimize(r);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numToDecode);
+}
+BENCHMARK(BM_trusted_decode);
+
+// The first `k` characters of AccountIDs; 0 encodes the whole token
+static void
+BM_encode_prefix(benchmark::State& state)
+{
+    std::size_t const k = state.range(0);
+    constexpr std::size_t numToEncode = 256;
+    std::vector<std::array<std::uint8_t, 20>> accounts(numToEncode);
+    std::uniform_int_distribution<std::uint8_t> dist(0, 255);
+    for (auto& a : accounts)
+        std::generate(a.begin(), a.end(), [&] { return dist(randEngine()); });
+    std::array<std::uint8_t, 64> out;
+    for (auto _ : state)
+    {
+        for (auto const& a : accounts)
+        {
+            auto r = k ? ripple::b58_fast::encodeBase58TokenPrefix(
+                             ripple::TokenType::AccountID, a, k, out)
+                       : ripple::b58_fast::encodeBase58Token(
+                             ripple::TokenType::AccountID, a, out);
+            benchmark::DoNotOptimize(r);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numToEncode);
+}
+BENCHMARK(BM_encode_prefix)->Arg(0)->Arg(1)->Arg(4)->Arg(8);
+
+// Vanity matching: AccountIDs against the first `k` characters of "rXRPL...".
+// Every AccountID starts with 'r'; the longer prefixes almost never match.
+static void
+BM_prefix_match(benchmark::State& state)
+{
+    std::string const prefix =
+        std::string("rXRPLfast").substr(0, state.range(0));
+    constexpr std::size_t numToEncode = 256;
+    std::vector<std::array<std::uint8_t, 20>> accounts(numToEncode);
+    std::uniform_int_distribution<std::uint8_t> dist(0, 255);
+    for (auto& a : accounts)
+        std::generate(a.begin(), a.end(), [&] { return dist(randEngine()); });
+    for (auto _ : state)
+    {
+        for (auto const& a : accounts)
+        {
+            auto r = ripple::b58_fast::base58TokenStartsWith(
+                ripple::TokenType::AccountID, a, prefix);
+            benchmark::DoNotOptimize(r);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numToEncode);
+}
+BENCHMARK(BM_prefix_match)->Arg(1)->Arg(4)->Arg(8);
+
+// Address autocomplete over 2^20 AccountIDs: the first `k` characters of one
+// of the addresses, answered from the sorted index (Arg 1) or by a scan
+// (Arg 0)
+static void
+BM_prefix_query(benchmark::State& state)
+{
+    constexpr std::size_t numAccounts = 1 << 20;
+    std::size_t const k = state.range(0);
+    bool const useIndex = state.range(1);
+    std::vector<ripple::b58_fast::TokenPayload<ripple::TokenType::AccountID>>
+        accounts(numAccounts);
+    std::uniform_int_distribution<std::uint8_t> dist(0, 255);
+    for (auto& a : accounts)
+        std::generate(a.begin(), a.end(), [&] { return dist(randEngine()); });
+    ripple::b58_fast::AccountIDPrefixIndex const index(accounts);
+    std::vector<std::string> prefixes;
+    for (std::size_t i = 0; i < 64; ++i)
+    {
+        prefixes.push_back(ripple::encodeBase58Token(
+                               ripple::TokenType::AccountID,
+                               accounts[i].data(),
+                               accounts[i].size())
+                               .substr(0, k));
+    }
+    std::size_t i = 0;
+    for (auto _ : state)
+    {
+        auto const& prefix = prefixes[i++ % prefixes.size()];
+        if (useIndex)
+        {
+            auto r = index.count(prefix);
+            benchmark::DoNotOptimize(r);
+            continue;
+        }
+        std::size_t count = 0;
+        for (auto const& a : index.payloads())
+        {
+            count += ripple::b58_fast::base58TokenStartsWith(
+                         ripple::TokenType::AccountID, a, prefix)
+                         .value();
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_prefix_query)
+    ->ArgsProduct({{3, 6}, {0, 1}})
+    ->Unit(benchmark::kMicrosecond);
+
+// Gateway input: half valid addresses, half garbage (typos, truncated
+// addresses, node keys, hex, email addresses and other text). Checked by a
+// full decode into scratch (Arg 0), `isValidBase58Token` (Arg 1) or the
+// batch form (Arg 2).
+static void
+BM_validate(benchmark::State& state)
+{
+    constexpr std::size_t numInputs = 256;
+    auto& rng = randEngine();
+    std::uniform_int_distribution<std::uint8_t> dist(0, 255);
+    std::vector<std::string> strings;
+    for (std::size_t i = 0; i < numInputs; ++i)
+    {
+        std::array<std::uint8_t, 33> payload;
+        std::generate(
+            payload.begin(), payload.end(), [&] { return dist(rng); });
+        auto s = ripple::encodeBase58Token(
+            ripple::TokenType::AccountID, payload.data(), 20);
+        switch (i % 16)
+        {
+            case 8:
+            case 9:
+                // A typo: the checksum doesn't match
+                s[1 + i % (s.size() - 1)] = s[i % 7] == 'x' ? 'y' : 'x';
+                break;
+            case 10:
+                s.resize(s.size() - 1 - i % 5);
+                break;
+            case 11:
+                s = ripple::encodeBase58Token(
+                    ripple::TokenType::NodePublic, payload.data(), 33);
+                break;
+            case 12:
+                s = "0x";
+                for (std::size_t j = 0; j < 20; ++j)
+                    s += "0123456789abcdef"[payload[j] % 16];
+                break;
+            case 13:
+                s = "user" + std::to_string(i) + "@example.com";
+                break;
+            case 14:
+                s[i % s.size()] = "0OIl"[i % 4];
+                break;
+            case 15:
+                s = i % 2 ? "" : "undefined";
+                break;
+            default:
+                break;
+        }
+        strings.push_back(std::move(s));
+    }
+    std::vector<std::string_view> const inputs(strings.begin(), strings.end());
+    auto valid = std::make_unique<bool[]>(numInputs);
+
+    for (auto _ : state)
+    {
+        switch (state.range(0))
+        {
+            case 0:
+                for (auto const s : inputs)
+                {
+                    std::array<std::uint8_t, 64> buf;
+                    auto r = ripple::b58_fast::decodeBase58Token(
+                        ripple::TokenType::AccountID, s, buf);
+                    benchmark::DoNotOptimize(r);
+                }
+                break;
+            case 1:
+                for (auto const s : inputs)
+                {
+                    auto r = ripple::b58_fast::isValidBase58Token(
+                        ripple::TokenType::AccountID, s);
+                    benchmark::DoNotOptimize(r);
+                }
+                break;
+            default: {
+                auto r = ripple::b58_fast::isValidBase58TokenBatch(
+                    ripple::TokenType::AccountID,
+                    inputs,
+                    std::span(valid.get(), numInputs));
+                benchmark::DoNotOptimize(r);
+                benchmark::DoNotOptimize(valid.get());
+                break;
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numInputs);
+}
+BENCHMARK(BM_validate)->Arg(0)->Arg(1)->Arg(2);
+
+// Raw base 58 of blobs from 64 bytes to 1 MiB (memos, signed blobs). Four
+// times the size should take less than 16 times as long.
+static void
+BM_encode_raw(benchmark::State& state)
+{
+    std::vector<std::uint8_t> data(state.range(0));
+    std::uniform_int_distribution<std::uint8_t> dist(0, 255);
+    std::generate(
+        data.begin(), data.end(), [&] { return dist(randEngine()); });
+    std::vector<std::uint8_t> out(
+        ripple::b58_fast::rawEncodedSizeUpperBound(data.size()));
+    // The powers of 58 and their reciprocals are computed once, and kept
+    if (!ripple::b58_fast::encodeBase58Raw(data, out))
+        state.SkipWithError("encode failed");
+    for (auto _ : state)
+    {
+        auto r = ripple::b58_fast::encodeBase58Raw(data, out);
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_encode_raw)->RangeMultiplier(4)->Range(64, 1 << 20);
+
+static void
+BM_decode_raw(benchmark::State& state)
+{
+    std::vector<std::uint8_t> data(state.range(0));
+    std::uniform_int_distribution<std::uint8_t> dist(0, 255);
+    std::generate(
+        data.begin(), data.end(), [&] { return dist(randEngine()); });
+    std::vector<std::uint8_t> encoded(
+        ripple::b58_fast::rawEncodedSizeUpperBound(data.size()));
+    auto const e = ripple::b58_fast::encodeBase58Raw(data, encoded);
+    std::string const s(e.value().begin(), e.value().end());
+    std::vector<std::uint8_t> out(
+        ripple::b58_fast::rawDecodedSizeUpperBound(s.size()));
+    for (auto _ : state)
+    {
+        auto r = ripple::b58_fast::decodeBase58Raw(s, out);
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_decode_raw)->RangeMultiplier(4)->Range(64, 1 << 20);
+
+// AccountIDs parsed straight into fixed size arrays, from views into one
+// buffer
+static void
+BM_parse_base58(benchmark::State& state)
+{
+    constexpr std::size_t numToDecode = 256;
+    std::string buffer;
+    std::vector<std::pair<std::size_t, std::size_t>> fields;
+    auto& rng = randEngine();
+    std::uniform_int_distribution<std::uint8_t> dist(0, 255);
+    for (std::size_t i = 0; i < numToDecode; ++i)
+    {
+        std::array<std::uint8_t, 20> payload;
+        std::generate(
+            payload.begin(), payload.end(), [&] { return dist(rng); });
+        auto const s = ripple::encodeBase58Token(
+            ripple::TokenType::AccountID, payload.data(), payload.size());
+        buffer += "\"Account\":\"";
+        fields.emplace_back(buffer.size(), s.size());
+        buffer += s + "\",";
+    }
+    std::string_view const view(buffer);
+    for (auto _ : state)
+    {
+        for (auto const& [pos, size] : fields)
+        {
+            auto r = ripple::parseBase58<std::array<std::uint8_t, 20>>(
+                view.substr(pos, size));
+            benchmark::DoNotOptimize(r);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numToDecode);
+}
+BENCHMARK(BM_parse_base58);
+
+// Decode latency of one NodePublic token, as in a peer handshake, by hasher
+template <class Hasher>
+static void
+BM_node_public_decode(benchmark::State& state)
+{
+    constexpr auto type = ripple::TokenType::NodePublic;
+    ripple::b58_fast::TokenPayload<type> payload;
+    std::uniform_int_distribution<std::uint8_t> dist(0, 255);
+    std::generate(
+        payload.begin(), payload.end(), [&] { return dist(randEngine()); });
+    auto const s =
+        ripple::encodeBase58Token(type, payload.data(), payload.size());
+    for (auto _ : state)
+    {
+        auto r = ripple::b58_fast::decode<type, Hasher>(s);
+        benchmark::DoNotOptimize(r);
+    }
+}
+BENCHMARK_TEMPLATE(BM_node_public_decode, ripple::openssl_sha256_hasher);
+BENCHMARK_TEMPLATE(BM_node_public_decode, ripple::fast_sha256_hasher);
+
+static void
+BM_new_decode_loop(benchmark::State& state)
+{
+    std::size_t const numToDecode = state.range(0);
+    auto const tokens = account_id_tokens(numToDecode);
+    std::array<std::uint8_t, 128> outBuf{};
+    for (auto _ : state)
+    {
+        for (auto const& s : tokens)
+        {
+            auto r = ripple::b58_fast::decodeBase58Token(
+                ripple::TokenType::AccountID, s, outBuf);
+            benchmark::DoNotOptimize(r);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numToDecode);
+}
+BENCHMARK(BM_new_decode_loop)->Arg(1)->Arg(8)->Arg(64)->Arg(1024);
+
+static void
+BM_new_decode_batch(benchmark::State& state)
+{
+    std::size_t const numToDecode = state.range(0);
+    auto const tokens = account_id_tokens(numToDecode);
+    std::vector<std::string_view> toDecode(tokens.begin(), tokens.end());
+    std::vector<ripple::TokenType> types(
+        numToDecode, ripple::TokenType::AccountID);
+    std::size_t arenaSize = 0;
+    for (auto const& s : tokens)
+        arenaSize += ripple::b58_fast::decodedSizeUpperBound(s.size());
+    std::vector<std::uint8_t> arena(arenaSize);
+    std::vector<std::span<std::uint8_t>> outTokens(numToDecode);
+    std::vector<TokenCodecErrc> statuses(numToDecode);
+    for (auto _ : state)
+    {
+        auto r = ripple::b58_fast::decodeBase58TokenBatch(
+            types, toDecode, arena, outTokens, statuses);
+        if (!r)
+            state.SkipWithError(r.error().message().c_str());
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetItemsProcessed(state.iterations() * numToDecode);
+}
+BENCHMARK(BM_new_decode_batch)->Arg(1)->Arg(8)->Arg(64)->Arg(1024);
+
+static void
+BM_verify_batch(benchmark::State& state)
+{
+    std::size_t const numToVerify = state.range(0);
+    auto const tokens = account_id_tokens(numToVerify);
+    std::vector<std::string_view> toVerify(tokens.begin(), tokens.end());
+    std::vector<ripple::TokenType> types(
+        numToVerify, ripple::TokenType::AccountID);
+    std::vector<TokenCodecErrc> statuses(numToVerify);
+    for (auto _ : state)
+    {
+        auto r =
+            ripple::b58_fast::verifyBase58TokenBatch(types, toVerify, statuses);
+        if (!r || r.value() != 0)
+            state.SkipWithError("verification failed");
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetItemsProcessed(state.iterations() * numToVerify);
+}
+BENCHMARK(BM_verify_batch)->Arg(64)->Arg(1024);
+
+// Scaling of the parallel codecs from one thread to one per core, over
+// `parallelTokens` AccountIDs (far more than fit in the caches)
+static constexpr std::size_t parallelTokens = 1 << 20;
+
+static void
+parallel_thread_counts(benchmark::internal::Benchmark* b)
+{
+    int const cores = std::max(1u, std::thread::hardware_concurrency());
+    for (int threads = 1; threads < cores; threads *= 2)
+        b->Arg(threads);
+    b->Arg(cores);
+}
+
+static void
+BM_encode_parallel(benchmark::State& state)
+{
+    std::vector<std::array<std::uint8_t, 20>> accounts(parallelTokens);
+    std::uniform_int_distribution<std::uint8_t> dist(0, 255);
+    for (auto& a : accounts)
+        std::generate(a.begin(), a.end(), [&] { return dist(randEngine()); });
+    std::vector<std::span<std::uint8_t const>> inputs(
+        accounts.begin(), accounts.end());
+    std::vector<std::uint8_t> arena(
+        parallelTokens * ripple::b58_fast::encodedSizeUpperBound(20));
+    std::vector<std::span<std::uint8_t>> outTokens(parallelTokens);
+    ripple::b58_fast::WorkStealingPool pool(state.range(0));
+    for (auto _ : state)
+    {
+        auto r = ripple::b58_fast::encodeBase58TokenParallel(
+            ripple::TokenType::AccountID, inputs, arena, outTokens, pool);
+        if (!r)
+            state.SkipWithError(r.error().message().c_str());
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetItemsProcessed(state.iterations() * parallelTokens);
+}
+BENCHMARK(BM_encode_parallel)
+    ->Apply(parallel_thread_counts)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+static void
+BM_decode_parallel(benchmark::State& state)
+{
+    auto const tokens = account_id_tokens(parallelTokens);
+    std::vector<std::string_view> inputs(tokens.begin(), tokens.end());
+    std::vector<ripple::TokenType> types(
+        parallelTokens, ripple::TokenType::AccountID);
+    // AccountID tokens are at most 34 characters
+    std::vector<std::uint8_t> arena(
+        parallelTokens * ripple::b58_fast::decodedSizeUpperBound(34));
+    std::vector<std::span<std::uint8_t>> outTokens(parallelTokens);
+    std::vector<TokenCodecErrc> statuses(parallelTokens);
+    ripple::b58_fast::WorkStealingPool pool(state.range(0));
+    for (auto _ : state)
+    {
+        auto r = ripple::b58_fast::decodeBase58TokenParallel(
+            types, inputs, arena, outTokens, statuses, pool);
+        if (!r)
+            state.SkipWithError(r.error().message().c_str());
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetItemsProcessed(state.iterations() * parallelTokens);
+}
+BENCHMARK(BM_decode_parallel)
+    ->Apply(parallel_thread_counts)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// `n` draws from [0, population) with P(k) proportional to 1 / (k + 1)^s
+static auto
+zipf_indices(std::size_t n, std::size_t population, double s)
+    -> std::vector<std::size_t>
+{
+    std::vector<double> cdf(population);
+    double sum = 0;
+    for (std::size_t k = 0; k < population; ++k)
+        cdf[k] = sum += 1 / std::pow(k + 1, s);
+    std::uniform_real_distribution<double> dist(0, sum);
+    std::vector<std::size_t> result(n);
+    for (auto& i : result)
+    {
+        auto const it =
+            std::lower_bound(cdf.begin(), cdf.end(), dist(randEngine()));
+        i = std::min<std::size_t>(it - cdf.begin(), population - 1);
+    }
+    return result;
+}
+
+// Decode AccountIDs drawn from 10k addresses with a Zipf distribution
+// through a cache of `state.range(0)` tokens (0 decodes without a cache)
+static void
+BM_decode_cache_zipf(benchmark::State& state)
+{
+    std::size_t const capacity = state.range(0);
+    auto const tokens = account_id_tokens(10000);
+    auto const indices = zipf_indices(1 << 16, tokens.size(), 1.0);
+    std::unique_ptr<ripple::b58_fast::DecodeCache> cache;
+    if (capacity)
+        cache = std::make_unique<ripple::b58_fast::DecodeCache>(capacity);
+    std::array<std::uint8_t, 128> outBuf{};
+    for (auto _ : state)
+    {
+        for (auto const i : indices)
+        {
+            auto r = cache
+                ? cache->decode(ripple::TokenType::AccountID, tokens[i], outBuf)
+                : ripple::b58_fast::decodeBase58Token(
+                      ripple::TokenType::AccountID, tokens[i], outBuf);
+            benchmark::DoNotOptimize(r);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * indices.size());
+    if (cache)
+    {
+        auto const stats = cache->stats();
+        state.counters["hit_rate"] =
+            double(stats.hits) / double(stats.hits + stats.misses);
+    }
+}
+BENCHMARK(BM_decode_cache_zipf)
+    ->Arg(0)
+    ->Arg(256)
+    ->Arg(1024)
+    ->Arg(4096)
+    ->Arg(16384);
+
+// Encode AccountIDs drawn from 10k accounts with a Zipf distribution through
+// a cache of `state.range(0)` bytes (0 encodes without a cache)
+static void
+BM_encode_cache_zipf(benchmark::State& state)
+{
+    std::size_t const budget = state.range(0);
+    std::vector<std::array<std::uint8_t, 20>> accounts(10000);
+    std::uniform_int_distribution<std::uint8_t> dist(0, 255);
+    for (auto& a : accounts)
+        std::generate(a.begin(), a.end(), [&] { return dist(randEngine()); });
+    auto const indices = zipf_indices(1 << 16, accounts.size(), 1.0);
+    std::unique_ptr<ripple::b58_fast::EncodeCache<20>> cache;
+    if (budget)
+        cache = std::make_unique<ripple::b58_fast::EncodeCache<20>>(budget);
+    std::array<std::uint8_t, 128> outBuf{};
+    for (auto _ : state)
+    {
+        for (auto const i : indices)
+        {
+            auto r = cache
+                ? cache->encode(
+                      ripple::TokenType::AccountID, accounts[i], outBuf)
+                : ripple::b58_fast::encodeBase58Token(
+                      ripple::TokenType::AccountID, accounts[i], outBuf);
+            benchmark::DoNotOptimize(r);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * indices.size());
+}
+BENCHMARK(BM_encode_cache_zipf)
+    ->Arg(0)
+    ->Arg(16 << 10)
+    ->Arg(64 << 10)
+    ->Arg(256 << 10)
+    ->Arg(1 << 20);
+
+// Whole file conversions of `fileTokens` AccountIDs, through the page cache
+static constexpr std::size_t fileTokens = 1 << 18;
+
+static auto
+file_bench_paths() -> std::array<std::filesystem::path, 3>
+{
+    auto const dir = std::filesystem::temp_directory_path();
+    std::array<std::filesystem::path, 3> paths{
+        dir / "xrpl_b58_bench.bin",
+        dir / "xrpl_b58_bench.txt",
+        dir / "xrpl_b58_bench.out"};
+    std::vector<char> payloads(fileTokens * 20);
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::generate(payloads.begin(), payloads.end(), [&] {
+        return static_cast<char>(dist(randEngine()));
+    });
+    std::ofstream(paths[0], std::ios::binary)
+        .write(payloads.data(), payloads.size());
+    if (!ripple::b58_fast::encodeBase58File(
+            ripple::TokenType::AccountID, 20, paths[0], paths[1]))
+        std::abort();
+    return paths;
+}
+
+static void
+BM_encode_file(benchmark::State& state)
+{
+    auto const paths = file_bench_paths();
+    for (auto _ : state)
+    {
+        auto r = ripple::b58_fast::encodeBase58File(
+            ripple::TokenType::AccountID, 20, paths[0], paths[2]);
+        if (!r)
+            state.SkipWithError("encode failed");
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetItemsProcessed(state.iterations() * fileTokens);
+    state.SetBytesProcessed(state.iterations() * fileTokens * 20);
+    for (auto const& p : paths)
+        std::filesystem::remove(p);
+}
+BENCHMARK(BM_encode_file)->Unit(benchmark::kMillisecond);
+
+static void
+BM_decode_file(benchmark::State& state)
+{
+    auto const paths = file_bench_paths();
+    for (auto _ : state)
+    {
+        auto r = ripple::b58_fast::decodeBase58File(
+            ripple::TokenType::AccountID, 20, paths[1], paths[2]);
+        if (!r || r.value().failed != 0)
+            state.SkipWithError("decode failed");
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetItemsProcessed(state.iterations() * fileTokens);
+    state.SetBytesProcessed(
+        state.iterations() * std::filesystem::file_size(paths[1]));
+    for (auto const& p : paths)
+        std::filesystem::remove(p);
+}
+BENCHMARK(BM_decode_file)->Unit(benchmark::kMillisecond);
+
+// Messages the size of an expanded AccountID without its checksum
+static auto
+checksum_test_data(std::size_t n) -> std::vector<std::array<std::uint8_t, 21>>
+{
+    std::vector<std::array<std::uint8_t, 21>> result(n);
+    std::uniform_int_distribution<std::uint8_t> dist(0, 255);
+    for (auto& m : result)
+        std::generate(m.begin(), m.end(), [&] { return dist(randEngine()); });
+    return result;
+}
+
+static void
+BM_checksum_openssl(benchmark::State& state)
+{
+    constexpr std::size_t numToHash = 1024;
+    auto const data = checksum_test_data(numToHash);
+    for (auto _ : state)
+    {
+        for (auto const& m : data)
+        {
+            ripple::openssl_sha256_hasher h;
+            h(m.data(), m.size());
+            auto const d =
+                static_cast<ripple::openssl_sha256_hasher::result_type>(h);
+            ripple::openssl_sha256_hasher h2;
+            h2(d.data(), d.size());
+            auto const r =
+                static_cast<ripple::openssl_sha256_hasher::result_type>(h2);
+            benchmark::DoNotOptimize(r);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numToHash);
+}
+BENCHMARK(BM_checksum_openssl);
+
+static void
+BM_checksum_fast(benchmark::State& state)
+{
+    constexpr std::size_t numToHash = 1024;
+    auto const engine = static_cast<ripple::Sha256Engine>(state.range(0));
+    if (!ripple::sha256EngineSupported(engine))
+    {
+        state.SkipWithError("engine not supported");
+        return;
+    }
+    auto const data = checksum_test_data(numToHash);
+    std::array<std::uint8_t, 4> sum;
+    for (auto _ : state)
+    {
+        for (auto const& m : data)
+        {
+            ripple::fast_sha256_hasher::checksum(
+                engine, sum.data(), m.data(), m.size());
+            benchmark::DoNotOptimize(sum);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numToHash);
+}
+BENCHMARK(BM_checksum_fast)
+    ->Arg(static_cast<int>(ripple::Sha256Engine::portable))
+    ->Arg(static_cast<int>(ripple::Sha256Engine::shani));
+
+// The argument is the number of messages hashed at once (narrowed to what
+// the cpu supports)
+static void
+BM_checksum_batch(benchmark::State& state)
+{
+    constexpr std::size_t numToHash = 1024;
+    std::size_t const lanes = state.range(0);
+    auto const data = checksum_test_data(numToHash);
+    std::vector<std::span<std::uint8_t const>> messages(
+        data.begin(), data.end());
+    std::vector<std::array<std::uint8_t, 4>> sums(numToHash);
+    for (auto _ : state)
+    {
+        ripple::checksumBatch(sums, messages, lanes);
+        benchmark::DoNotOptimize(sums.data());
+    }
+    state.SetItemsProcessed(state.iterations() * numToHash);
+}
+BENCHMARK(BM_checksum_batch)->Arg(1)->Arg(4)->Arg(8)->Arg(16);
 #endif
 
 BENCHMARK_MAIN();
@@ -19,8 +19,17 @@
 
 #include <digest.h>
 #include <openssl/sha.h>
+
+#include <boost/endian/conversion.hpp>
+
+#include <cassert>
+#include <cstring>
 #include <type_traits>
 
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
 namespace ripple {
 
 openssl_sha256_hasher::openssl_sha256_hasher()
@@ -47,4 +56,558 @@ openssl_sha256_hasher::operator result_type() noexcept
     return digest;
 }
 
+//------------------------------------------------------------------------------
+
+namespace {
+
+using detail::sha256_h;
+using detail::sha256_k;
+
+// Longest message that fits, with its padding, in one SHA-256 block
+constexpr std::size_t max_block_message = 55;
+
+using ChecksumFn = void (*)(
+    std::span<std::array<std::uint8_t, 4>> out,
+    std::span<std::span<std::uint8_t const> const> messages);
+
+void
+checksum_one(
+    std::span<std::array<std::uint8_t, 4>> out,
+    std::span<std::span<std::uint8_t const> const> messages)
+{
+    for (std::size_t i = 0; i < messages.size(); ++i)
+    {
+        fast_sha256_hasher::checksum(
+            out[i].data(), messages[i].data(), messages[i].size());
+    }
+}
+
+// The multi-buffer hashes are written once with GCC vector extensions: `V`
+// holds one 32 bit word per lane. The wrappers below instantiate them with
+// the vector width of their target, so they compile to that instruction set.
+// Everything is inlined into the wrappers and no function returns a vector,
+// so the vectors never cross a call. This is a struct because an alias
+// template would drop the vector attribute. Without the vector extensions
+// (MSVC) only the single lane exists, and batches are hashed one message at
+// a time.
+#if defined(__GNUC__)
+template <std::size_t Lanes>
+struct lane_words
+{
+    typedef std::uint32_t type __attribute__((vector_size(4 * Lanes)));
+};
+#else
+template <std::size_t Lanes>
+struct lane_words;
+#endif
+
+// A single lane is a plain word: the portable engine
+template <>
+struct lane_words<1>
+{
+    using type = std::uint32_t;
+};
+
+// One SHA-256 compression of the block `w` into `state`, for every lane
+template <class V>
+[[gnu::always_inline]] inline void
+sha256_compress_lanes(V (&state)[8], V (&w)[16])
+{
+    V a = state[0], b = state[1], c = state[2], d = state[3];
+    V e = state[4], f = state[5], g = state[6], h = state[7];
+    // Fully unrolled, so the message schedule stays in registers
+#if defined(__GNUC__)
+#pragma GCC unroll 64
+#endif
+    for (std::size_t t = 0; t < 64; ++t)
+    {
+        // The rotates are spelled out; the compiler turns them into rotate
+        // instructions where the target has them
+        if (t >= 16)
+        {
+            V const x = w[(t - 15) & 15];
+            V const y = w[(t - 2) & 15];
+            V const s0 = (x >> 7 | x << 25) ^ (x >> 18 | x << 14) ^ (x >> 3);
+            V const s1 = (y >> 17 | y << 15) ^ (y >> 19 | y << 13) ^ (y >> 10);
+            w[t & 15] += s0 + w[(t - 7) & 15] + s1;
+        }
+        V const S1 = (e >> 6 | e << 26) ^ (e >> 11 | e << 21) ^
+            (e >> 25 | e << 7);
+        V const S0 = (a >> 2 | a << 30) ^ (a >> 13 | a << 19) ^
+            (a >> 22 | a << 10);
+        V const t1 = h + S1 + ((e & f) ^ (~e & g)) + sha256_k[t] + w[t & 15];
+        V const t2 = S0 + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+// Checksum up to `Lanes` messages of at most `max_block_message` bytes
+template <std::size_t Lanes>
+[[gnu::always_inline]] inline void
+checksum_lanes(
+    std::span<std::array<std::uint8_t, 4>> out,
+    std::span<std::span<std::uint8_t const> const> messages)
+{
+    using V = typename lane_words<Lanes>::type;
+    static_assert(sizeof(V) == 4 * Lanes);
+    assert(messages.size() <= Lanes);
+
+    // Pad every message to a block, then transpose the blocks so `w[t]`
+    // holds word `t` of every lane. The words are byte swapped to big endian
+    // once they are in vectors.
+    std::array<std::array<std::uint8_t, 64>, Lanes> blocks{};
+    for (std::size_t lane = 0; lane < messages.size(); ++lane)
+    {
+        auto const m = messages[lane];
+        assert(m.size() <= max_block_message);
+        auto& block = blocks[lane];
+        std::copy(m.begin(), m.end(), block.begin());
+        block[m.size()] = 0x80;
+        auto const bits =
+            boost::endian::native_to_big(std::uint64_t(m.size()) * 8);
+        std::memcpy(&block[56], &bits, 8);
+    }
+    std::array<std::array<std::uint32_t, Lanes>, 16> words;
+    for (std::size_t t = 0; t < 16; ++t)
+    {
+        for (std::size_t lane = 0; lane < Lanes; ++lane)
+            std::memcpy(&words[t][lane], &blocks[lane][t * 4], 4);
+    }
+    V w[16];
+    std::memcpy(w, words.data(), sizeof(w));
+    for (auto& x : w)
+    {
+        x = (x >> 24) | ((x >> 8) & 0xff00) | ((x << 8) & 0xff0000) |
+            (x << 24);
+    }
+    V state[8];
+    for (std::size_t i = 0; i < 8; ++i)
+        state[i] = V{} + sha256_h[i];
+    sha256_compress_lanes(state, w);
+
+    // The second hash is of the 32 byte digest, so its message words are the
+    // state words of the first hash
+    for (std::size_t i = 0; i < 8; ++i)
+    {
+        w[i] = state[i];
+        state[i] = V{} + sha256_h[i];
+    }
+    w[8] = V{} + 0x80000000;
+    for (std::size_t i = 9; i < 15; ++i)
+        w[i] = V{};
+    w[15] = V{} + 256;
+    sha256_compress_lanes(state, w);
+
+    // The checksum is the first word of the digest, big endian
+    std::array<std::uint32_t, Lanes> h0;
+    std::memcpy(h0.data(), &state[0], sizeof(state[0]));
+    for (std::size_t lane = 0; lane < messages.size(); ++lane)
+    {
+        auto const be = boost::endian::native_to_big(h0[lane]);
+        std::memcpy(out[lane].data(), &be, 4);
+    }
+}
+
+#if defined(__GNUC__)
+void
+checksum_lanes_4(
+    std::span<std::array<std::uint8_t, 4>> out,
+    std::span<std::span<std::uint8_t const> const> messages)
+{
+    checksum_lanes<4>(out, messages);
+}
+#endif
+
+// Only called after `checksumLanes` checks the cpu
+#if defined(__x86_64__) && defined(__GNUC__)
+__attribute__((target("avx2"))) void
+checksum_lanes_avx2(
+    std::span<std::array<std::uint8_t, 4>> out,
+    std::span<std::span<std::uint8_t const> const> messages)
+{
+    checksum_lanes<8>(out, messages);
+}
+
+__attribute__((target("avx512f"))) void
+checksum_lanes_avx512(
+    std::span<std::array<std::uint8_t, 4>> out,
+    std::span<std::span<std::uint8_t const> const> messages)
+{
+    checksum_lanes<16>(out, messages);
+}
+#endif
+
+void
+compress_portable(
+    std::array<std::uint32_t, 8>& state,
+    std::uint8_t const* blocks,
+    std::size_t num_blocks)
+{
+    for (; num_blocks; --num_blocks, blocks += 64)
+    {
+        std::uint32_t w[16];
+        for (std::size_t t = 0; t < 16; ++t)
+        {
+            std::memcpy(&w[t], blocks + t * 4, 4);
+            boost::endian::big_to_native_inplace(w[t]);
+        }
+        std::uint32_t s[8];
+        std::copy(state.begin(), state.end(), s);
+        sha256_compress_lanes(s, w);
+        std::copy(s, s + 8, state.begin());
+    }
+}
+
+void
+checksum_portable(void* out, void const* message, std::size_t size)
+{
+    std::span<std::uint8_t const> const m(
+        static_cast<std::uint8_t const*>(message), size);
+    std::array<std::uint8_t, 4> sum;
+    checksum_lanes<1>(std::span(&sum, 1), std::span(&m, 1));
+    std::memcpy(out, sum.data(), 4);
+}
+
+// The sha extensions keep the state as two vectors, ABEF and CDGH (largest
+// lane first), and run two rounds per instruction.
+#if defined(__x86_64__)
+[[gnu::always_inline]] __attribute__((target("sha,sse4.1"))) inline void
+sha256_rounds_shani(__m128i& abef, __m128i& cdgh, __m128i (&m)[4])
+{
+    __m128i const abef_in = abef;
+    __m128i const cdgh_in = cdgh;
+    // Fully unrolled, so the message schedule stays in registers. `m[g % 4]`
+    // holds message words 4g to 4g + 3.
+#pragma GCC unroll 16
+    for (std::size_t g = 0; g < 16; ++g)
+    {
+        __m128i& cur = m[g & 3];
+        if (g >= 4)
+        {
+            cur = _mm_sha256msg1_epu32(cur, m[(g - 3) & 3]);
+            cur = _mm_add_epi32(
+                cur, _mm_alignr_epi8(m[(g - 1) & 3], m[(g - 2) & 3], 4));
+            cur = _mm_sha256msg2_epu32(cur, m[(g - 1) & 3]);
+        }
+        __m128i const msg = _mm_add_epi32(
+            cur,
+            _mm_loadu_si128(
+                reinterpret_cast<__m128i const*>(&sha256_k[g * 4])));
+        cdgh = _mm_sha256rnds2_epu32(cdgh, abef, msg);
+        abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(msg, 0x0e));
+    }
+    abef = _mm_add_epi32(abef, abef_in);
+    cdgh = _mm_add_epi32(cdgh, cdgh_in);
+}
+
+// Load four big endian message words
+[[gnu::always_inline]] __attribute__((target("sha,sse4.1"))) inline __m128i
+load_words_shani(std::uint8_t const* p)
+{
+    __m128i const bswap =
+        _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    return _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<__m128i const*>(p)), bswap);
+}
+
+__attribute__((target("sha,sse4.1"))) void
+compress_shani(
+    std::array<std::uint32_t, 8>& state,
+    std::uint8_t const* blocks,
+    std::size_t num_blocks)
+{
+    auto const p = reinterpret_cast<__m128i*>(state.data());
+    __m128i const dcba = _mm_loadu_si128(p);
+    __m128i const hgfe = _mm_loadu_si128(p + 1);
+    __m128i const cdab = _mm_shuffle_epi32(dcba, 0xb1);
+    __m128i const efgh = _mm_shuffle_epi32(hgfe, 0x1b);
+    __m128i abef = _mm_alignr_epi8(cdab, efgh, 8);
+    __m128i cdgh = _mm_blend_epi16(efgh, cdab, 0xf0);
+    for (; num_blocks; --num_blocks, blocks += 64)
+    {
+        __m128i m[4];
+        for (std::size_t j = 0; j < 4; ++j)
+            m[j] = load_words_shani(blocks + j * 16);
+        sha256_rounds_shani(abef, cdgh, m);
+    }
+    __m128i const feba = _mm_shuffle_epi32(abef, 0x1b);
+    __m128i const dchg = _mm_shuffle_epi32(cdgh, 0xb1);
+    _mm_storeu_si128(p, _mm_blend_epi16(feba, dchg, 0xf0));
+    _mm_storeu_si128(p + 1, _mm_alignr_epi8(dchg, feba, 8));
+}
+
+// A message of at most `max_block_message` bytes
+__attribute__((target("sha,sse4.1"))) void
+checksum_shani(void* out, void const* message, std::size_t size)
+{
+    std::array<std::uint8_t, 64> block{};
+    std::memcpy(block.data(), message, size);
+    block[size] = 0x80;
+    auto const bits = boost::endian::native_to_big(std::uint64_t(size) * 8);
+    std::memcpy(&block[56], &bits, 8);
+
+    __m128i const abef_iv =
+        _mm_set_epi32(sha256_h[0], sha256_h[1], sha256_h[4], sha256_h[5]);
+    __m128i const cdgh_iv =
+        _mm_set_epi32(sha256_h[2], sha256_h[3], sha256_h[6], sha256_h[7]);
+    __m128i abef = abef_iv;
+    __m128i cdgh = cdgh_iv;
+    __m128i m[4];
+    for (std::size_t j = 0; j < 4; ++j)
+        m[j] = load_words_shani(block.data() + j * 16);
+    sha256_rounds_shani(abef, cdgh, m);
+
+    // The second hash is of the 32 byte digest: its message words are the
+    // state words of the first hash, then fixed padding
+    m[0] = _mm_shuffle_epi32(_mm_unpackhi_epi64(abef, cdgh), 0xb1);
+    m[1] = _mm_shuffle_epi32(_mm_unpacklo_epi64(abef, cdgh), 0xb1);
+    m[2] = _mm_set_epi32(0, 0, 0, 0x80000000);
+    m[3] = _mm_set_epi32(256, 0, 0, 0);
+    abef = abef_iv;
+    cdgh = cdgh_iv;
+    sha256_rounds_shani(abef, cdgh, m);
+
+    // The checksum is the first word of the digest, big endian
+    auto const a = boost::endian::native_to_big(
+        static_cast<std::uint32_t>(_mm_extract_epi32(abef, 3)));
+    std::memcpy(out, &a, 4);
+}
+#endif
+
+// The implementation that hashes `lanes` messages at once. `lanes` must be
+// supported by the cpu.
+ChecksumFn
+checksum_fn(std::size_t lanes)
+{
+    switch (lanes)
+    {
+#if defined(__x86_64__) && defined(__GNUC__)
+        case 16:
+            return checksum_lanes_avx512;
+        case 8:
+            return checksum_lanes_avx2;
+#endif
+#if defined(__GNUC__)
+        case 4:
+            return checksum_lanes_4;
+#endif
+        default:
+            return checksum_one;
+    }
+}
+
+// The widest multi-buffer implementation the cpu supports
+std::size_t
+widest_lanes()
+{
+#if defined(__x86_64__) && defined(__GNUC__)
+    if (__builtin_cpu_supports("avx512f"))
+        return 16;
+    if (__builtin_cpu_supports("avx2"))
+        return 8;
+#endif
+#if defined(__GNUC__)
+    return 4;
+#else
+    return 1;
+#endif
+}
+
+}  // namespace
+
+bool
+sha256EngineSupported(Sha256Engine engine)
+{
+    switch (engine)
+    {
+        case Sha256Engine::portable:
+            return true;
+#if defined(__x86_64__)
+        case Sha256Engine::shani:
+            return __builtin_cpu_supports("sha") &&
+                __builtin_cpu_supports("sse4.1");
+#endif
+        default:
+            return false;
+    }
+}
+
+Sha256Engine
+activeSha256Engine()
+{
+    static Sha256Engine const engine =
+        sha256EngineSupported(Sha256Engine::shani) ? Sha256Engine::shani
+                                                   : Sha256Engine::portable;
+    return engine;
+}
+
+fast_sha256_hasher::fast_sha256_hasher() noexcept
+    : fast_sha256_hasher(activeSha256Engine())
+{
+}
+
+fast_sha256_hasher::fast_sha256_hasher(Sha256Engine engine) noexcept
+    : state_(sha256_h), engine_(engine)
+{
+}
+
+void
+fast_sha256_hasher::operator()(void const* data, std::size_t size) noexcept
+{
+    auto const compress =
+#if defined(__x86_64__)
+        engine_ == Sha256Engine::shani ? compress_shani :
+#endif
+                                       compress_portable;
+    auto p = static_cast<std::uint8_t const*>(data);
+    std::size_t const used = size_ % 64;
+    size_ += size;
+    if (used)
+    {
+        std::size_t const n = std::min(size, 64 - used);
+        std::memcpy(&block_[used], p, n);
+        p += n;
+        size -= n;
+        if (used + n < 64)
+            return;
+        compress(state_, block_.data(), 1);
+    }
+    compress(state_, p, size / 64);
+    std::memcpy(block_.data(), p + size / 64 * 64, size % 64);
+}
+
+fast_sha256_hasher::operator result_type() noexcept
+{
+    // Pad with a one bit, zeros, and the size in bits
+    std::array<std::uint8_t, 72> padding{0x80};
+    std::size_t const used = size_ % 64;
+    std::size_t const pad_size = (used < 56 ? 56 : 120) - used;
+    auto const bits = boost::endian::native_to_big(size_ * 8);
+    std::memcpy(&padding[pad_size], &bits, 8);
+    (*this)(padding.data(), pad_size + 8);
+
+    result_type digest;
+    for (std::size_t i = 0; i < 8; ++i)
+    {
+        auto const be = boost::endian::native_to_big(state_[i]);
+        std::memcpy(&digest[i * 4], &be, 4);
+    }
+    return digest;
+}
+
+void
+fast_sha256_hasher::checksum(
+    void* out,
+    void const* message,
+    std::size_t size) noexcept
+{
+    checksum(activeSha256Engine(), out, message, size);
+}
+
+void
+fast_sha256_hasher::checksum(
+    Sha256Engine engine,
+    void* out,
+    void const* message,
+    std::size_t size) noexcept
+{
+    if (size > max_block_message)
+    {
+        fast_sha256_hasher h(engine);
+        h(message, size);
+        auto const d = static_cast<result_type>(h);
+        fast_sha256_hasher h2(engine);
+        h2(d.data(), d.size());
+        auto const d2 = static_cast<result_type>(h2);
+        std::memcpy(out, d2.data(), 4);
+        return;
+    }
+#if defined(__x86_64__)
+    if (engine == Sha256Engine::shani)
+        return checksum_shani(out, message, size);
+#endif
+    checksum_portable(out, message, size);
+}
+
+std::size_t
+checksumLanes()
+{
+    static std::size_t const lanes = []() -> std::size_t {
+#if defined(__x86_64__) && defined(__GNUC__)
+        if (__builtin_cpu_supports("avx512f"))
+            return 16;
+        // The sha extensions hash one message about as fast as the avx2
+        // version hashes eight
+        if (__builtin_cpu_supports("sha"))
+            return 1;
+        if (__builtin_cpu_supports("avx2"))
+            return 8;
+#endif
+#if defined(__GNUC__)
+        return 4;
+#else
+        return 1;
+#endif
+    }();
+    return lanes;
+}
+
+void
+checksumBatch(
+    std::span<std::array<std::uint8_t, 4>> out,
+    std::span<std::span<std::uint8_t const> const> messages,
+    std::size_t lanes)
+{
+    assert(out.size() >= messages.size());
+    lanes = std::min(lanes, widest_lanes());
+    lanes = lanes >= 16 ? 16 : lanes >= 8 ? 8 : lanes >= 4 ? 4 : 1;
+    auto const hash_lanes = checksum_fn(lanes);
+
+    // Gather the short messages into groups; a long message doesn't break up
+    // a group.
+    constexpr std::size_t max_lanes = 16;
+    std::array<std::span<std::uint8_t const>, max_lanes> group;
+    std::array<std::size_t, max_lanes> group_i;
+    std::array<std::array<std::uint8_t, 4>, max_lanes> sums;
+    std::size_t n = 0;
+    auto flush = [&] {
+        // A group too small to pay for the idle lanes is hashed one message
+        // at a time
+        auto const fn = n * 4 <= lanes ? checksum_one : hash_lanes;
+        fn(std::span(sums.data(), n), std::span(group.data(), n));
+        for (std::size_t i = 0; i < n; ++i)
+            out[group_i[i]] = sums[i];
+        n = 0;
+    };
+    for (std::size_t i = 0; i < messages.size(); ++i)
+    {
+        if (messages[i].size() > max_block_message)
+        {
+            checksum_one(out.subspan(i, 1), messages.subspan(i, 1));
+            continue;
+        }
+        group[n] = messages[i];
+        group_i[n] = i;
+        if (++n == lanes)
+            flush();
+    }
+    if (n)
+        flush();
+}
+
 }  // namespace ripple
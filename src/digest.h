@@ -24,6 +24,11 @@
 
 #include <algorithm>
 #include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
 
 namespace ripple {
 
@@ -53,6 +58,232 @@ private:
 
 using sha256_hasher = openssl_sha256_hasher;
 
+//------------------------------------------------------------------------------
+
+/** Implementations of the SHA-256 compression function */
+enum class Sha256Engine : std::uint8_t { portable, shani };
+
+/** Return true if the engine can run on this cpu */
+[[nodiscard]] bool
+sha256EngineSupported(Sha256Engine engine);
+
+/** The engine used by `fast_sha256_hasher` by default
+
+    The sha extensions when the cpu has them, otherwise the portable engine.
+    The choice is made once, on first use.
+*/
+[[nodiscard]] Sha256Engine
+activeSha256Engine();
+
+/** SHA-256 digest
+
+    @note This uses the sha extensions when the cpu has them. It also
+          computes the checksum of base 58 tokens directly, without the
+          overhead of streaming: the message of a token fits in one block
+          and the message of the second hash is always a 32 byte digest.
+*/
+struct fast_sha256_hasher
+{
+public:
+    static constexpr auto const endian = boost::endian::order::native;
+
+    using result_type = std::array<std::uint8_t, 32>;
+
+    fast_sha256_hasher() noexcept;
+
+    explicit fast_sha256_hasher(Sha256Engine engine) noexcept;
+
+    void
+    operator()(void const* data, std::size_t size) noexcept;
+
+    [[nodiscard]] explicit operator result_type() noexcept;
+
+    /** Calculate the 4-byte checksum of a message
+
+        The first 4 bytes of the SHA-256 digest of the SHA-256 digest of the
+        message. Messages of at most 55 bytes take a single compression per
+        hash.
+    */
+    static void
+    checksum(void* out, void const* message, std::size_t size) noexcept;
+
+    static void
+    checksum(
+        Sha256Engine engine,
+        void* out,
+        void const* message,
+        std::size_t size) noexcept;
+
+private:
+    std::array<std::uint32_t, 8> state_;
+    std::array<std::uint8_t, 64> block_;
+    std::uint64_t size_ = 0;
+    Sha256Engine engine_;
+};
+
+/** Calculate the 4-byte checksum of base 58 tokens with `Hasher`
+
+    The first 4 bytes of the digest of the digest of the message. A hasher
+    with a static `checksum` member computes it itself; any other hasher is
+    run twice.
+*/
+template <class Hasher>
+void
+tokenChecksum(void* out, void const* message, std::size_t size)
+{
+    if constexpr (requires { Hasher::checksum(out, message, size); })
+    {
+        Hasher::checksum(out, message, size);
+    }
+    else
+    {
+        Hasher h;
+        h(message, size);
+        auto const d = static_cast<typename Hasher::result_type>(h);
+        Hasher h2;
+        h2(d.data(), d.size());
+        auto const d2 = static_cast<typename Hasher::result_type>(h2);
+        std::memcpy(out, d2.data(), 4);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+namespace detail {
+
+inline constexpr std::array<std::uint32_t, 64> sha256_k = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+inline constexpr std::array<std::uint32_t, 8> sha256_h = {
+    0x6a09e667,
+    0xbb67ae85,
+    0x3c6ef372,
+    0xa54ff53a,
+    0x510e527f,
+    0x9b05688c,
+    0x1f83d9ab,
+    0x5be0cd19};
+
+// One SHA-256 compression of the block `w` (big endian words) into `state`
+constexpr void
+sha256_compress(
+    std::array<std::uint32_t, 8>& state,
+    std::array<std::uint32_t, 16> w)
+{
+    auto s = state;
+    for (std::size_t t = 0; t < 64; ++t)
+    {
+        if (t >= 16)
+        {
+            std::uint32_t const x = w[(t - 15) & 15];
+            std::uint32_t const y = w[(t - 2) & 15];
+            w[t & 15] += (std::rotr(x, 7) ^ std::rotr(x, 18) ^ (x >> 3)) +
+                w[(t - 7) & 15] +
+                (std::rotr(y, 17) ^ std::rotr(y, 19) ^ (y >> 10));
+        }
+        std::uint32_t const t1 = s[7] +
+            (std::rotr(s[4], 6) ^ std::rotr(s[4], 11) ^ std::rotr(s[4], 25)) +
+            ((s[4] & s[5]) ^ (~s[4] & s[6])) + sha256_k[t] + w[t & 15];
+        std::uint32_t const t2 =
+            (std::rotr(s[0], 2) ^ std::rotr(s[0], 13) ^ std::rotr(s[0], 22)) +
+            ((s[0] & s[1]) ^ (s[0] & s[2]) ^ (s[1] & s[2]));
+        for (std::size_t i = 7; i > 0; --i)
+            s[i] = s[i - 1];
+        s[4] += t1;
+        s[0] = t1 + t2;
+    }
+    for (std::size_t i = 0; i < 8; ++i)
+        state[i] += s[i];
+}
+
+// SHA-256 digest of `message`, padded one byte at a time. Only bit
+// operations, so constant evaluation can run it.
+constexpr std::array<std::uint8_t, 32>
+sha256_digest(std::span<std::uint8_t const> message)
+{
+    std::uint64_t const bits = std::uint64_t{message.size()} * 8;
+    std::size_t const padded = (message.size() + 9 + 63) / 64 * 64;
+    auto state = sha256_h;
+    for (std::size_t block = 0; block < padded; block += 64)
+    {
+        std::array<std::uint32_t, 16> w{};
+        for (std::size_t i = 0; i < 64; ++i)
+        {
+            std::size_t const pos = block + i;
+            std::uint8_t byte = 0;
+            if (pos < message.size())
+                byte = message[pos];
+            else if (pos == message.size())
+                byte = 0x80;
+            else if (pos >= padded - 8)
+                byte =
+                    static_cast<std::uint8_t>(bits >> 8 * (padded - 1 - pos));
+            w[i / 4] |= std::uint32_t{byte} << 8 * (3 - i % 4);
+        }
+        sha256_compress(state, w);
+    }
+    std::array<std::uint8_t, 32> digest;
+    for (std::size_t i = 0; i < 32; ++i)
+        digest[i] = static_cast<std::uint8_t>(state[i / 4] >> 8 * (3 - i % 4));
+    return digest;
+}
+
+}  // namespace detail
+
+/** Calculate the 4-byte checksum of base 58 tokens in constant evaluation
+
+    Same as `tokenChecksum`, with a plain SHA-256 written so constant
+    evaluation can run it. At run time it is much slower than
+    `fast_sha256_hasher`; use it for tokens known at compile time.
+*/
+[[nodiscard]] constexpr std::array<std::uint8_t, 4>
+constexprTokenChecksum(std::span<std::uint8_t const> message)
+{
+    auto const d = detail::sha256_digest(message);
+    auto const d2 = detail::sha256_digest(d);
+    return {d2[0], d2[1], d2[2], d2[3]};
+}
+
+//------------------------------------------------------------------------------
+
+/** The number of messages `checksumBatch` hashes at once by default
+
+    16 on cpus with avx512. Otherwise 1 on cpus with the sha extensions,
+    which hash one message about as fast as avx2 hashes eight; 8 with avx2;
+    and 4 elsewhere. 1 with compilers without the GCC vector extensions
+    (MSVC), where batches are hashed one message at a time.
+*/
+[[nodiscard]] std::size_t
+checksumLanes();
+
+/** Calculate the 4-byte checksums of a batch of messages
+
+    Each checksum is the first 4 bytes of the SHA-256 digest of the SHA-256
+    digest of the message, the checksum of base 58 tokens. Messages that fit
+    in one SHA-256 block (at most 55 bytes) are hashed several at a time, one
+    per SIMD lane; longer messages are hashed one at a time.
+
+    @param out Receives the checksum of each message.
+    @param messages The messages to checksum.
+    @param lanes The number of messages to hash at once: 1, 4, 8 or 16. It is
+                 narrowed to what the cpu supports.
+*/
+void
+checksumBatch(
+    std::span<std::array<std::uint8_t, 4>> out,
+    std::span<std::span<std::uint8_t const> const> messages,
+    std::size_t lanes = checksumLanes());
+
 }  // namespace ripple
 
 #endif
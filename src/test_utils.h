@@ -2,10 +2,14 @@
 
 #include "tokens.h"
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
 #include <random>
 #include <span>
 #include <sstream>
+#include <string>
+#include <vector>
 
 [[nodiscard]] inline auto
 randEngine() -> std::mt19937&
@@ -62,6 +66,24 @@ random_b256_test_data(std::span<std::uint8_t> d)
     return {tok_type, d.subspan(0, tok_size)};
 }
 
+// `n` random AccountID tokens
+[[nodiscard]] inline auto
+account_id_tokens(std::size_t n) -> std::vector<std::string>
+{
+    std::vector<std::string> result(n);
+    std::uniform_int_distribution<std::uint8_t> dist(0, 255);
+    for (auto& s : result)
+    {
+        std::array<std::uint8_t, 20> payload;
+        std::generate(payload.begin(), payload.end(), [&] {
+            return dist(randEngine());
+        });
+        s = ripple::encodeBase58Token(
+            ripple::TokenType::AccountID, payload.data(), payload.size());
+    }
+    return result;
+}
+
 inline auto
 print_as_char(std::span<std::uint8_t> a, std::span<std::uint8_t> b)
 {
@@ -1,7 +1,16 @@
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 
+#include "b58_bulk.h"
+#include "b58_cache.h"
+#include "b58_index.h"
+#include "b58_kernels.h"
+#include "b58_large.h"
+#include "b58_literals.h"
+#include "b58_parallel.h"
+#include "b58_stream.h"
 #include "b58_utils.h"
+#include "digest.h"
 #include "test_utils.h"
 #include "tokens.h"
 
@@ -9,11 +18,19 @@
 #include <boost/random.hpp>
 
 #include <array>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
 #include <random>
 #include <span>
+#include <thread>
 
 #ifndef _MSC_VER
 
+// Without `b58_fast`, only the digest and the portable codecs are tested
+#ifndef XRPL_B58_PORTABLE
 namespace multiprecision_utils {
 // return a random bigint of the same number in two forms. The first is smallest
 // coeff first u64. The second is boost multiprecision representation.
@@ -123,6 +140,206 @@ TEST_CASE("Multiprecision math matches boost", "[multiprecision]")
     }
 }
 
+TEST_CASE("Reciprocal division matches boost", "[multiprecision]")
+{
+    constexpr std::size_t iters = 1000000;
+    auto check = [&]<std::uint64_t Divisor>() {
+        for (int i = 0; i < iters; ++i)
+        {
+            auto big_int = multiprecision_utils::random_bigint();
+            auto boost_big_int = multiprecision_utils::to_boost_mp(
+                std::span<std::uint64_t>(big_int.data(), big_int.size()));
+
+            auto ref_div = boost_big_int / Divisor;
+            auto ref_mod = boost_big_int % Divisor;
+
+            auto mod = b58_fast::detail::inplace_bigint_div_rem_by<Divisor>(
+                std::span<uint64_t>(big_int.data(), big_int.size()));
+            auto found_div = multiprecision_utils::to_boost_mp(big_int);
+            REQUIRE(ref_mod.convert_to<std::uint64_t>() == mod);
+            REQUIRE(found_div == ref_div);
+        }
+    };
+    check.template operator()<430804206899405824>();  // 58^10
+    check.template operator()<58>();
+    // no normalization shift, and the largest shift
+    check.template operator()<std::numeric_limits<std::uint64_t>::max()>();
+    check.template operator()<(std::uint64_t(1) << 63) + 1>();
+    check.template operator()<1>();
+
+    // fixed size numerators are unrolled
+    std::array<std::uint64_t, 5> fixed;
+    std::uniform_int_distribution<std::uint64_t> dist;
+    for (int i = 0; i < iters; ++i)
+    {
+        std::generate(
+            fixed.begin(), fixed.end(), [&] { return dist(randEngine()); });
+        auto const boost_big_int = multiprecision_utils::to_boost_mp(fixed);
+        auto const mod =
+            b58_fast::detail::inplace_bigint_div_rem_by<430804206899405824>(
+                std::span(fixed));
+        REQUIRE(
+            (boost_big_int % 430804206899405824).convert_to<std::uint64_t>() ==
+            mod);
+        REQUIRE(
+            multiprecision_utils::to_boost_mp(fixed) ==
+            boost_big_int / 430804206899405824);
+    }
+
+    // base 58 digits of base 58^10 coeffs
+    std::uniform_int_distribution<std::uint64_t> coeffDist(
+        0, 430804206899405823);
+    for (int i = 0; i < iters; ++i)
+    {
+        std::uint64_t const coeff = i < 2 ? i * 430804206899405823
+                                          : coeffDist(randEngine());
+        auto const digits = b58_fast::detail::b58_10_to_b58_be(coeff);
+        boost::multiprecision::checked_uint512_t v = 0;
+        for (auto d : digits)
+        {
+            REQUIRE(d < 58);
+            v = v * 58 + d;
+        }
+        REQUIRE(v == coeff);
+    }
+}
+
+TEST_CASE("Base 58^10 to base 2^64 engines match boost", "[multiprecision]")
+{
+    constexpr std::size_t iters = 200000;
+    std::uniform_int_distribution<std::uint64_t> coeffDist(
+        0, 430804206899405823);
+    auto check = [&]<std::size_t NumCoeffs>() {
+        std::array<std::uint64_t, NumCoeffs> coeffs;
+        for (int i = 0; i < iters; ++i)
+        {
+            boost::multiprecision::checked_uint512_t ref = 0;
+            for (std::size_t j = 0; j < NumCoeffs; ++j)
+            {
+                // exercise the largest and smallest values too
+                coeffs[j] = i < 2 ? i * 430804206899405823
+                                  : coeffDist(randEngine());
+                ref = ref * 430804206899405824 + coeffs[j];
+            }
+            auto horner = b58_fast::detail::b58_10_to_b256_horner(
+                std::span<std::uint64_t const, NumCoeffs>(coeffs));
+            auto powers = b58_fast::detail::b58_10_to_b256_powers(
+                std::span<std::uint64_t const, NumCoeffs>(coeffs));
+            REQUIRE(multiprecision_utils::to_boost_mp(horner) == ref);
+            REQUIRE(multiprecision_utils::to_boost_mp(powers) == ref);
+        }
+    };
+    check.template operator()<1>();
+    check.template operator()<2>();
+    check.template operator()<3>();
+    check.template operator()<4>();
+    check.template operator()<5>();
+    check.template operator()<6>();
+}
+
+TEST_CASE("Digit extraction matches division", "[b58_fast]")
+{
+    std::string_view const alphabet =
+        "rpshnaf39wBUDNEGHJKLM4PQRST7VWXYZ2bcdeCg65jkm8oFqi1tuvAxyz";
+    std::uniform_int_distribution<std::uint64_t> coeffDist(
+        0, 430804206899405823);
+    constexpr std::size_t iters = 1000000;
+    for (int i = 0; i < iters; ++i)
+    {
+        std::uint64_t const coeff =
+            i < 2 ? i * 430804206899405823 : coeffDist(randEngine());
+        std::array<std::uint8_t, 10> chars;
+        ripple::b58_fast::detail::b58_10_to_alphabet_be(coeff, chars.data());
+        auto const digits = b58_fast::detail::b58_10_to_b58_be(coeff);
+        for (int j = 0; j < 10; ++j)
+            REQUIRE(chars[j] == alphabet[digits[j]]);
+    }
+}
+
+#endif
+
+TEST_CASE("SHA-256 engines match OpenSSL", "[digest]")
+{
+    constexpr std::size_t iters = 2000;
+    auto& rng = randEngine();
+    // exercise every padding case and messages of several blocks
+    std::uniform_int_distribution<std::size_t> sizeDist(0, 300);
+    std::uniform_int_distribution<std::uint8_t> byteDist(0, 255);
+    for (int i = 0; i < iters; ++i)
+    {
+        std::vector<std::uint8_t> d(i < 130 ? i : sizeDist(rng));
+        std::generate(d.begin(), d.end(), [&] { return byteDist(rng); });
+        ripple::openssl_sha256_hasher h;
+        h(d.data(), d.size());
+        auto const expected =
+            static_cast<ripple::openssl_sha256_hasher::result_type>(h);
+        ripple::openssl_sha256_hasher h2;
+        h2(expected.data(), expected.size());
+        auto const expected2 =
+            static_cast<ripple::openssl_sha256_hasher::result_type>(h2);
+
+        for (auto engine :
+             {ripple::Sha256Engine::portable, ripple::Sha256Engine::shani})
+        {
+            if (!ripple::sha256EngineSupported(engine))
+                continue;
+            // feed the message in two pieces to exercise the buffering
+            std::size_t const split = d.empty() ? 0 : rng() % d.size();
+            ripple::fast_sha256_hasher fh(engine);
+            fh(d.data(), split);
+            fh(d.data() + split, d.size() - split);
+            auto const digest =
+                static_cast<ripple::fast_sha256_hasher::result_type>(fh);
+            REQUIRE(digest == expected);
+
+            std::array<std::uint8_t, 4> sum;
+            ripple::fast_sha256_hasher::checksum(
+                engine, sum.data(), d.data(), d.size());
+            REQUIRE(std::equal(sum.begin(), sum.end(), expected2.begin()));
+        }
+    }
+}
+
+TEST_CASE("Checksum batch matches single checksum", "[digest]")
+{
+    constexpr std::size_t iters = 1000;
+    auto& rng = randEngine();
+    std::uniform_int_distribution<std::size_t> batchSizeDist(1, 100);
+    // exercise messages that don't fit in one block too
+    std::uniform_int_distribution<std::size_t> sizeDist(0, 80);
+    std::uniform_int_distribution<std::uint8_t> byteDist(0, 255);
+    for (int i = 0; i < iters; ++i)
+    {
+        auto const batchSize = batchSizeDist(rng);
+        std::vector<std::vector<std::uint8_t>> data(batchSize);
+        std::vector<std::span<std::uint8_t const>> messages;
+        std::vector<std::array<std::uint8_t, 4>> expected(batchSize);
+        for (std::size_t j = 0; j < batchSize; ++j)
+        {
+            auto& d = data[j];
+            d.resize(sizeDist(rng));
+            std::generate(d.begin(), d.end(), [&] { return byteDist(rng); });
+            messages.emplace_back(d.data(), d.size());
+            ripple::openssl_sha256_hasher h;
+            h(d.data(), d.size());
+            auto const digest =
+                static_cast<ripple::openssl_sha256_hasher::result_type>(h);
+            ripple::openssl_sha256_hasher h2;
+            h2(digest.data(), digest.size());
+            auto const digest2 =
+                static_cast<ripple::openssl_sha256_hasher::result_type>(h2);
+            std::copy_n(digest2.begin(), 4, expected[j].begin());
+        }
+        for (std::size_t lanes : {1, 4, 8, 16})
+        {
+            std::vector<std::array<std::uint8_t, 4>> sums(batchSize);
+            ripple::checksumBatch(sums, messages, lanes);
+            REQUIRE(sums == expected);
+        }
+    }
+}
+
+#ifndef XRPL_B58_PORTABLE
 TEST_CASE("New encode implementation match reference", "[b58_fast]")
 {
     std::array<std::uint8_t, 128> b256DataBuf;
@@ -209,4 +426,1764 @@ TEST_CASE("New encode implementation match reference", "[b58_fast]")
     }
 }
 
+TEST_CASE("Tokens of every size match reference", "[b58_fast]")
+{
+    auto& rng = randEngine();
+    std::uniform_int_distribution<std::uint8_t> byteDist(0, 255);
+    std::uniform_int_distribution<std::size_t> zerosDist(0, 3);
+    constexpr std::size_t maxSize = 123;
+    constexpr std::size_t iters = 200;
+    for (std::size_t size = 1; size <= maxSize; ++size)
+    {
+        for (std::size_t i = 0; i < iters; ++i)
+        {
+            auto const tokType = std::get<0>(random_token_type_and_size());
+            std::vector<std::uint8_t> payload(size);
+            std::generate(payload.begin(), payload.end(), [&] {
+                return byteDist(rng);
+            });
+            // exercise the leading zero handling, including all zeros
+            std::fill_n(
+                payload.begin(),
+                i % 16 ? std::min(size, zerosDist(rng)) : size,
+                0);
+            auto const expected = ripple::b58_ref::encodeBase58Token(
+                tokType, payload.data(), payload.size());
+
+            std::array<std::uint8_t, ripple::b58_fast::maxBase58TokenChars>
+                encodedBuf;
+            auto const encoded = ripple::b58_fast::encodeBase58Token(
+                tokType, payload, encodedBuf);
+            REQUIRE(encoded);
+            std::string_view const s(
+                reinterpret_cast<char const*>(encoded.value().data()),
+                encoded.value().size());
+            REQUIRE(s == expected);
+
+            std::array<std::uint8_t, maxSize> decodedBuf;
+            auto const decoded =
+                ripple::b58_fast::decodeBase58Token(tokType, s, decodedBuf);
+            REQUIRE(decoded);
+            REQUIRE(std::equal(
+                decoded.value().begin(),
+                decoded.value().end(),
+                payload.begin(),
+                payload.end()));
+
+            // The string interface sizes its buffers from the input
+            REQUIRE(
+                ripple::b58_fast::encodeBase58Token(
+                    tokType, payload.data(), payload.size()) == expected);
+            REQUIRE(
+                ripple::b58_fast::decodeBase58Token(expected, tokType) ==
+                std::string(payload.begin(), payload.end()));
+
+            // The kernels hand tokens too large for them to the same code
+            std::array<std::string_view, 1> in{s};
+            std::array<std::uint8_t, maxSize + 5> expandedBuf;
+            std::array<std::span<std::uint8_t>, 1> out{expandedBuf};
+            std::array<TokenCodecErrc, 1> status;
+            ripple::b58_fast::detail::b58_to_b256_kernel(
+                ripple::b58_fast::activeKernel(), in, out, status);
+            REQUIRE(status[0] == TokenCodecErrc::Success);
+            REQUIRE(out[0].size() == size + 5);
+            REQUIRE(std::equal(
+                payload.begin(), payload.end(), out[0].begin() + 1));
+        }
+    }
+
+    std::array<std::uint8_t, maxSize + 1> tooLarge{};
+    std::array<std::uint8_t, ripple::b58_fast::maxBase58TokenChars + 8> buf;
+    REQUIRE(
+        ripple::b58_fast::encodeBase58Token(
+            ripple::TokenType::AccountID, std::span(tooLarge), buf)
+            .error() == TokenCodecErrc::InputTooLarge);
+    std::string const tooLong(ripple::b58_fast::maxBase58TokenChars + 1, 'p');
+    REQUIRE(
+        ripple::b58_fast::decodeBase58Token(
+            ripple::TokenType::AccountID, tooLong, buf)
+            .error() == TokenCodecErrc::InputTooLarge);
+}
+
+#endif
+
+TEST_CASE("Portable codecs match fast codecs", "[b58_portable]")
+{
+    auto& rng = randEngine();
+    std::uniform_int_distribution<std::uint8_t> byteDist(0, 255);
+    std::uniform_int_distribution<std::size_t> sizeDist(1, 123);
+    std::uniform_int_distribution<int> corruptDist(0, 7);
+    constexpr std::size_t iters = 100000;
+    for (std::size_t i = 0; i < iters; ++i)
+    {
+        auto const [tokType, tokSize] = random_token_type_and_size();
+        std::vector<std::uint8_t> payload(i % 2 ? tokSize : sizeDist(rng));
+        std::generate(
+            payload.begin(), payload.end(), [&] { return byteDist(rng); });
+        // exercise the leading zero handling, including all zeros
+        std::fill_n(
+            payload.begin(),
+            i % 16 ? std::min<std::size_t>(payload.size(), i % 3) :
+                     payload.size(),
+            0);
+
+        auto const expected = ripple::b58_ref::encodeBase58Token(
+            tokType, payload.data(), payload.size());
+        REQUIRE(
+            ripple::b58_portable::encodeBase58Token(
+                tokType, payload.data(), payload.size()) == expected);
+
+        auto e = expected;
+        std::uniform_int_distribution<std::size_t> posDist(0, e.size() - 1);
+        auto type = tokType;
+        switch (corruptDist(rng))
+        {
+            case 0:
+                e[posDist(rng)] = expected[posDist(rng)];
+                break;
+            case 1:
+                e[posDist(rng)] = '0';
+                break;
+            case 2:
+                type = std::get<0>(random_token_type_and_size());
+                break;
+            case 3:
+                e.resize(posDist(rng) % 8);
+                break;
+            case 4:
+                e += e;
+                break;
+            default:
+                break;
+        }
+#ifndef XRPL_B58_PORTABLE
+        std::array<std::uint8_t, 2 * ripple::b58_fast::maxBase58TokenChars>
+            bufs[2];
+        auto const fast =
+            ripple::b58_fast::decodeBase58Token(type, e, bufs[0]);
+        auto const portable =
+            ripple::b58_portable::decodeBase58Token(type, e, bufs[1]);
+        REQUIRE(fast.has_value() == portable.has_value());
+        if (!fast)
+        {
+            REQUIRE(fast.error() == portable.error());
+            continue;
+        }
+        REQUIRE(std::equal(
+            fast.value().begin(),
+            fast.value().end(),
+            portable.value().begin(),
+            portable.value().end()));
+#else
+        std::vector<std::uint8_t> buf(e.size());
+        auto const portable =
+            ripple::b58_portable::decodeBase58Token(type, e, buf);
+        if (e == expected && type == tokType)
+        {
+            REQUIRE(portable);
+            REQUIRE(std::ranges::equal(portable.value(), payload));
+            continue;
+        }
+        // The reference decodes every error to an empty string, and only
+        // decodes tokens of up to 64 characters
+        if (e.size() > 64)
+            continue;
+        auto const reference = ripple::b58_ref::decodeBase58Token(e, type);
+        REQUIRE(portable.has_value() == !reference.empty());
+        if (!portable)
+            continue;
+        REQUIRE(std::equal(
+            reference.begin(),
+            reference.end(),
+            portable.value().begin(),
+            portable.value().end(),
+            [](char a, std::uint8_t b) {
+                return static_cast<std::uint8_t>(a) == b;
+            }));
+#endif
+    }
+
+    std::array<std::uint8_t, 124> tooLarge{};
+    std::array<std::uint8_t, 8> small;
+    REQUIRE(
+        ripple::b58_portable::encodeBase58Token(
+            ripple::TokenType::AccountID, std::span(tooLarge), small)
+            .error() == TokenCodecErrc::InputTooLarge);
+    REQUIRE(
+        ripple::b58_portable::encodeBase58Token(
+            ripple::TokenType::AccountID,
+            std::span(tooLarge).first(20),
+            small)
+            .error() == TokenCodecErrc::OutputTooSmall);
+}
+
+TEST_CASE("Constexpr codecs match fast codecs", "[b58_portable]")
+{
+    using namespace ripple::b58_literals;
+    using ripple::TokenType;
+    using AccountID = std::array<std::uint8_t, 20>;
+
+    // All of these are checked by the compiler
+    constexpr auto genesis = "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh"_account;
+    static_assert(
+        genesis ==
+        AccountID{0xb5, 0xf7, 0x62, 0x79, 0x8a, 0x53, 0xd5, 0x43, 0xa0, 0x14,
+                  0xca, 0xf8, 0xb2, 0x97, 0xcf, 0xf8, 0xf2, 0xf9, 0x37, 0xe8});
+    static_assert("rrrrrrrrrrrrrrrrrrrrrhoLvTp"_account == AccountID{});
+    static_assert(
+        ripple::b58_portable::encodeBase58Token(TokenType::AccountID, genesis)
+            .view() == "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh");
+    static_assert(
+        ripple::parseBase58<AccountID>("rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh") ==
+        genesis);
+    // A bad checksum, a bad character, and the wrong type
+    static_assert(!ripple::parseBase58<AccountID>(
+        "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTi"));
+    static_assert(!ripple::parseBase58<AccountID>(
+        "rHb9CJAWyB4rj91VRWn96DkukG4bwdty0h"));
+    static_assert(!ripple::b58_portable::decodeBase58Token<20>(
+        TokenType::NodePublic, "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh"));
+    constexpr auto node =
+        "n9KAa2zVWjPHgfzsE3iZ8HAbzJtPrnoh4H2M2HgE7dfqtvyEb1KJ"_node_public;
+    static_assert(
+        ripple::b58_portable::encodeBase58Token(TokenType::NodePublic, node)
+            .view() == "n9KAa2zVWjPHgfzsE3iZ8HAbzJtPrnoh4H2M2HgE7dfqtvyEb1KJ");
+
+    // The constexpr SHA-256, for messages of one and several blocks
+    auto& rng = randEngine();
+    std::uniform_int_distribution<std::uint8_t> byteDist(0, 255);
+    std::vector<std::uint8_t> message(200);
+    std::generate(
+        message.begin(), message.end(), [&] { return byteDist(rng); });
+    for (std::size_t size = 0; size <= message.size(); ++size)
+    {
+        std::array<std::uint8_t, 4> expected;
+        ripple::tokenChecksum<ripple::fast_sha256_hasher>(
+            expected.data(), message.data(), size);
+        REQUIRE(
+            ripple::constexprTokenChecksum(std::span(message).first(size)) ==
+            expected);
+    }
+
+    // And the codecs at run time
+    auto check = [&]<std::size_t N>(TokenType type) {
+        for (std::size_t i = 0; i < 1000; ++i)
+        {
+            std::array<std::uint8_t, N> payload;
+            std::generate(
+                payload.begin(), payload.end(), [&] { return byteDist(rng); });
+            std::fill_n(payload.begin(), i % 3, 0);
+            auto const encoded =
+                ripple::b58_portable::encodeBase58Token(type, payload);
+#ifndef XRPL_B58_PORTABLE
+            REQUIRE(
+                encoded.view() ==
+                ripple::b58_fast::encodeBase58TokenInline(
+                    type, payload.data(), payload.size())
+                    .view());
+#else
+            REQUIRE(
+                encoded.view() ==
+                ripple::b58_ref::encodeBase58Token(
+                    type, payload.data(), payload.size()));
+#endif
+            REQUIRE(
+                ripple::b58_portable::decodeBase58Token<N>(type, encoded) ==
+                payload);
+            REQUIRE(!ripple::b58_portable::decodeBase58Token<N - 1>(
+                type, encoded));
+        }
+    };
+    check.template operator()<16>(TokenType::FamilySeed);
+    check.template operator()<20>(TokenType::AccountID);
+    check.template operator()<32>(TokenType::NodePrivate);
+    check.template operator()<33>(TokenType::NodePublic);
+}
+
+#ifndef XRPL_B58_PORTABLE
+TEST_CASE("Batch encode matches single encode", "[b58_fast]")
+{
+    constexpr std::size_t iters = 1000;
+    auto& rng = randEngine();
+    std::uniform_int_distribution<std::size_t> batchSizeDist(1, 100);
+    std::uniform_int_distribution<std::uint8_t> byteDist(0, 255);
+    // The token sizes, and larger inputs that are encoded one at a time
+    std::array<std::size_t, 7> const sizes{16, 20, 32, 33, 34, 64, 123};
+    std::uniform_int_distribution<std::size_t> sizeDist(0, sizes.size() - 1);
+    for (int i = 0; i < iters; ++i)
+    {
+        auto const [tokType, _] = random_token_type_and_size();
+        auto const batchSize = batchSizeDist(rng);
+        std::vector<std::vector<std::uint8_t>> data(batchSize);
+        std::vector<std::span<std::uint8_t const>> inputs;
+        std::size_t arenaSize = 0;
+        for (auto& d : data)
+        {
+            d.resize(sizes[sizeDist(rng)]);
+            std::generate(d.begin(), d.end(), [&] { return byteDist(rng); });
+            // exercise the leading zero handling
+            if (byteDist(rng) < 32)
+                std::fill(d.begin(), d.begin() + byteDist(rng) % 4, 0);
+            inputs.emplace_back(d.data(), d.size());
+            arenaSize += ripple::b58_fast::encodedSizeUpperBound(d.size());
+        }
+        std::vector<std::uint8_t> arena(arenaSize);
+        std::vector<std::span<std::uint8_t>> outTokens(batchSize);
+        auto r = ripple::b58_fast::encodeBase58TokenBatch(
+            tokType, inputs, arena, outTokens);
+        REQUIRE(r);
+
+        std::size_t totalSize = 0;
+        for (std::size_t j = 0; j < batchSize; ++j)
+        {
+            std::array<
+                std::uint8_t,
+                ripple::b58_fast::encodedSizeUpperBound(
+                    ripple::b58_fast::maxBase58TokenPayload)>
+                expectedBuf;
+            auto expected = ripple::b58_fast::encodeBase58Token(
+                tokType, inputs[j], expectedBuf);
+            REQUIRE(expected);
+            REQUIRE(std::equal(
+                outTokens[j].begin(),
+                outTokens[j].end(),
+                expected.value().begin(),
+                expected.value().end()));
+            REQUIRE(outTokens[j].data() == arena.data() + totalSize);
+            totalSize += outTokens[j].size();
+        }
+        REQUIRE(r.value().size() == totalSize);
+    }
+
+    std::vector<std::uint8_t> const tooLarge(
+        ripple::b58_fast::maxBase58TokenPayload + 1);
+    std::array<std::span<std::uint8_t const>, 1> const inputs{tooLarge};
+    std::vector<std::uint8_t> arena(
+        ripple::b58_fast::encodedSizeUpperBound(tooLarge.size()));
+    std::array<std::span<std::uint8_t>, 1> outTokens;
+    REQUIRE(
+        ripple::b58_fast::encodeBase58TokenBatch(
+            ripple::TokenType::None, inputs, arena, outTokens)
+            .error() == TokenCodecErrc::InputTooLarge);
+}
+
+TEST_CASE("Batch decode matches single decode", "[b58_fast]")
+{
+    constexpr std::size_t iters = 1000;
+    auto& rng = randEngine();
+    std::uniform_int_distribution<std::size_t> batchSizeDist(1, 100);
+    std::uniform_int_distribution<int> corruptDist(0, 15);
+    for (int i = 0; i < iters; ++i)
+    {
+        auto const batchSize = batchSizeDist(rng);
+        std::vector<ripple::TokenType> types(batchSize);
+        std::vector<std::string> encoded(batchSize);
+        std::vector<std::string_view> inputs;
+        std::size_t arenaSize = 0;
+        for (std::size_t j = 0; j < batchSize; ++j)
+        {
+            std::array<std::uint8_t, 64> b256DataBuf;
+            auto const [tokType, b256Data] = random_b256_test_data(b256DataBuf);
+            types[j] = tokType;
+            auto& e = encoded[j];
+            e = ripple::b58_ref::encodeBase58Token(
+                tokType, b256Data.data(), b256Data.size());
+            // Corrupt some of the tokens; they must fail on their own
+            std::uniform_int_distribution<std::size_t> posDist(
+                0, e.size() - 1);
+            switch (corruptDist(rng))
+            {
+                case 0:
+                    e[posDist(rng)] =
+                        ripple::b58_fast::detail::b58Alphabet[posDist(rng)];
+                    break;
+                case 1:
+                    e[posDist(rng)] = '0';
+                    break;
+                case 2:
+                    types[j] = std::get<0>(random_token_type_and_size());
+                    break;
+                case 3:
+                    e.resize(posDist(rng) % 8);
+                    break;
+                case 4:
+                    e += e;
+                    break;
+                default:
+                    break;
+            }
+            inputs.emplace_back(e);
+            arenaSize += ripple::b58_fast::decodedSizeUpperBound(e.size());
+        }
+        std::vector<std::uint8_t> arena(arenaSize);
+        std::vector<std::span<std::uint8_t>> outTokens(batchSize);
+        std::vector<TokenCodecErrc> statuses(batchSize);
+        auto r = ripple::b58_fast::decodeBase58TokenBatch(
+            types, inputs, arena, outTokens, statuses);
+        REQUIRE(r);
+
+        std::size_t totalSize = 0;
+        for (std::size_t j = 0; j < batchSize; ++j)
+        {
+            std::array<std::uint8_t, 64> expectedBuf;
+            auto expected = ripple::b58_fast::decodeBase58Token(
+                types[j], inputs[j], expectedBuf);
+            if (!expected)
+            {
+                REQUIRE(make_error_code(statuses[j]) == expected.error());
+                REQUIRE(outTokens[j].empty());
+                continue;
+            }
+            REQUIRE(statuses[j] == TokenCodecErrc::Success);
+            REQUIRE(std::equal(
+                outTokens[j].begin(),
+                outTokens[j].end(),
+                expected.value().begin(),
+                expected.value().end()));
+            REQUIRE(outTokens[j].data() == arena.data() + totalSize);
+            totalSize += outTokens[j].size();
+        }
+        REQUIRE(r.value().size() == totalSize);
+    }
+}
+
+TEST_CASE("Parallel codecs match single codecs", "[b58_fast]")
+{
+    auto& rng = randEngine();
+    std::uniform_int_distribution<std::uint8_t> byteDist(0, 255);
+    std::uniform_int_distribution<std::size_t> sizeDist(
+        1, ripple::b58_fast::maxBase58TokenPayload);
+
+    // Runs every task on the calling thread, in reverse
+    struct SerialExecutor : ripple::b58_fast::TaskExecutor
+    {
+        void
+        parallelFor(
+            std::size_t count,
+            std::function<void(std::size_t)> const& task) override
+        {
+            while (count)
+                task(--count);
+        }
+    } serial;
+    ripple::b58_fast::WorkStealingPool pool1(1);
+    ripple::b58_fast::WorkStealingPool pool4(4);
+    ripple::b58_fast::TaskExecutor* const executors[] = {
+        &serial, &pool1, &pool4, &ripple::b58_fast::defaultExecutor()};
+
+    // Every task runs exactly once, however the work is stolen
+    for (std::size_t count : {0, 1, 3, 4, 5, 1000, 100003})
+    {
+        std::vector<std::atomic<int>> runs(count);
+        pool4.parallelFor(count, [&](std::size_t i) {
+            runs[i].fetch_add(1, std::memory_order_relaxed);
+        });
+        REQUIRE(std::all_of(runs.begin(), runs.end(), [](auto const& r) {
+            return r.load() == 1;
+        }));
+    }
+
+    auto const tokType = ripple::TokenType::NodePublic;
+    for (std::size_t n : {std::size_t{0},
+                          std::size_t{1},
+                          ripple::b58_fast::parallelTaskTokens,
+                          5 * ripple::b58_fast::parallelTaskTokens + 17})
+    {
+        std::vector<std::vector<std::uint8_t>> payloads(n);
+        std::vector<std::span<std::uint8_t const>> inputs(n);
+        std::size_t encodedSize = 0;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            payloads[i].resize(sizeDist(rng));
+            std::generate(payloads[i].begin(), payloads[i].end(), [&] {
+                return byteDist(rng);
+            });
+            inputs[i] = payloads[i];
+            encodedSize +=
+                ripple::b58_fast::encodedSizeUpperBound(payloads[i].size());
+        }
+        for (auto* executor : executors)
+        {
+            std::vector<std::uint8_t> arena(encodedSize);
+            std::vector<std::span<std::uint8_t>> outTokens(n);
+            REQUIRE(ripple::b58_fast::encodeBase58TokenParallel(
+                tokType, inputs, arena, outTokens, *executor));
+            std::vector<std::string> encoded(n);
+            std::vector<std::string_view> views(n);
+            std::size_t decodedSize = 0;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                encoded[i].assign(outTokens[i].begin(), outTokens[i].end());
+                REQUIRE(
+                    encoded[i] ==
+                    ripple::b58_ref::encodeBase58Token(
+                        tokType, payloads[i].data(), payloads[i].size()));
+                // Corrupt some of the tokens; they must fail on their own
+                if (i % 7 == 3)
+                    encoded[i].back() = encoded[i].back() == 'r' ? 'p' : 'r';
+                views[i] = encoded[i];
+                decodedSize +=
+                    ripple::b58_fast::decodedSizeUpperBound(views[i].size());
+            }
+
+            std::vector<ripple::TokenType> types(n, tokType);
+            std::vector<std::uint8_t> decodeArena(decodedSize);
+            std::vector<std::span<std::uint8_t>> decoded(n);
+            std::vector<TokenCodecErrc> statuses(n);
+            REQUIRE(ripple::b58_fast::decodeBase58TokenParallel(
+                types, views, decodeArena, decoded, statuses, *executor));
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                if (i % 7 == 3)
+                {
+                    REQUIRE(statuses[i] != TokenCodecErrc::Success);
+                    continue;
+                }
+                REQUIRE(statuses[i] == TokenCodecErrc::Success);
+                REQUIRE(std::ranges::equal(decoded[i], payloads[i]));
+            }
+
+            // The arenas must hold the worst case
+            if (n)
+            {
+                arena.pop_back();
+                REQUIRE(!ripple::b58_fast::encodeBase58TokenParallel(
+                    tokType, inputs, arena, outTokens, *executor));
+            }
+        }
+    }
+
+    std::vector<std::uint8_t> const tooLarge(
+        ripple::b58_fast::maxBase58TokenPayload + 1);
+    std::array<std::span<std::uint8_t const>, 1> const inputs{tooLarge};
+    std::vector<std::uint8_t> arena(
+        ripple::b58_fast::encodedSizeUpperBound(tooLarge.size()));
+    std::array<std::span<std::uint8_t>, 1> outTokens;
+    REQUIRE(
+        ripple::b58_fast::encodeBase58TokenParallel(
+            tokType, inputs, arena, outTokens, pool4)
+            .error() == TokenCodecErrc::InputTooLarge);
+}
+
+TEST_CASE("Inline string codecs match the string codecs", "[b58_fast]")
+{
+    using ripple::Base58String;
+    constexpr std::size_t iters = 10000;
+    for (std::size_t i = 0; i < iters; ++i)
+    {
+        std::array<std::uint8_t, 64> b256DataBuf;
+        auto const [tokType, b256Data] = random_b256_test_data(b256DataBuf);
+        auto const expected = ripple::b58_fast::encodeBase58Token(
+            tokType, b256Data.data(), b256Data.size());
+        auto const encoded = ripple::b58_fast::encodeBase58TokenInline(
+            tokType, b256Data.data(), b256Data.size());
+        REQUIRE(encoded.view() == expected);
+        REQUIRE(encoded.str() == expected);
+
+        std::string corrupted = expected;
+        if (i % 2)
+            corrupted[i % corrupted.size()] = '0';
+        auto const decoded =
+            ripple::b58_fast::decodeBase58TokenInline(corrupted, tokType);
+        REQUIRE(
+            decoded.view() ==
+            ripple::b58_fast::decodeBase58Token(corrupted, tokType));
+        if (i % 2 == 0)
+        {
+            REQUIRE(
+                decoded.view() ==
+                std::string_view(
+                    reinterpret_cast<char const*>(b256Data.data()),
+                    b256Data.size()));
+        }
+    }
+
+    // The payload must fit in a Base58String
+    for (std::size_t size :
+         {Base58String::capacity, Base58String::capacity + 1})
+    {
+        std::vector<std::uint8_t> payload(size, 0xab);
+        auto const token = ripple::b58_fast::encodeBase58Token(
+            ripple::TokenType::AccountID, payload.data(), payload.size());
+        REQUIRE(token.size() > 60);
+        auto const decoded = ripple::b58_fast::decodeBase58TokenInline(
+            token, ripple::TokenType::AccountID);
+        if (size <= Base58String::capacity)
+            REQUIRE(
+                decoded.view() ==
+                ripple::b58_fast::decodeBase58Token(
+                    token, ripple::TokenType::AccountID));
+        else
+            REQUIRE(decoded.empty());
+    }
+
+    // Value semantics
+    Base58String const a("rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh");
+    Base58String const b("rrrrrrrrrrrrrrrrrrrrrhoLvTp");
+    REQUIRE(a == Base58String(std::string_view(a)));
+    REQUIRE(a != b);
+    REQUIRE(a < b);
+    REQUIRE(
+        std::hash<Base58String>{}(a) ==
+        std::hash<std::string_view>{}(a.view()));
+    REQUIRE(Base58String().empty());
+    REQUIRE(
+        Base58String(std::string(Base58String::capacity, 'r')).size() ==
+        Base58String::capacity);
+}
+
+TEST_CASE("Prefix encode matches encode", "[b58_fast]")
+{
+    auto& rng = randEngine();
+    std::uniform_int_distribution<std::uint8_t> byteDist(0, 255);
+    std::uniform_int_distribution<std::size_t> sizeDist(1, 33);
+    std::uniform_int_distribution<int> typeDist(0, 255);
+    for (int i = 0; i < 20000; ++i)
+    {
+        // Any type byte and size; small values and leading zeros make the
+        // checksum reach the leading digits
+        auto const tokType = i % 4 == 0
+            ? ripple::TokenType::AccountID
+            : static_cast<ripple::TokenType>(typeDist(rng));
+        std::vector<std::uint8_t> payload(sizeDist(rng));
+        std::generate(payload.begin(), payload.end(), [&] {
+            return byteDist(rng);
+        });
+        if (i % 8 == 1)
+            std::fill_n(payload.begin(), payload.size() / 2 + i % 3, 0);
+        if (i % 64 == 3)
+            std::fill(payload.begin(), payload.end(), 0);
+
+        auto const expected = ripple::b58_ref::encodeBase58Token(
+            tokType, payload.data(), payload.size());
+        for (std::size_t k = 0; k <= expected.size() + 1; ++k)
+        {
+            std::array<std::uint8_t, 64> buf;
+            auto const r = ripple::b58_fast::encodeBase58TokenPrefix(
+                tokType, payload, k, buf);
+            REQUIRE(r);
+            auto const prefix = expected.substr(0, k);
+            REQUIRE(
+                std::string_view(
+                    reinterpret_cast<char const*>(r.value().data()),
+                    r.value().size()) == prefix);
+
+            REQUIRE(ripple::b58_fast::base58TokenStartsWith(
+                        tokType, payload, prefix)
+                        .value());
+            if (k == 0)
+                continue;
+            auto other = prefix;
+            other.back() = other.back() == 'r' ? 'p' : 'r';
+            REQUIRE(!ripple::b58_fast::base58TokenStartsWith(
+                         tokType, payload, other)
+                         .value());
+        }
+        REQUIRE(!ripple::b58_fast::base58TokenStartsWith(
+                     tokType, payload, expected + 'r')
+                     .value());
+        REQUIRE(!ripple::b58_fast::base58TokenStartsWith(
+                     tokType, payload, "0")
+                     .value());
+    }
+
+    std::array<std::uint8_t, 34> tooLarge{};
+    std::array<std::uint8_t, 8> buf;
+    REQUIRE(
+        ripple::b58_fast::encodeBase58TokenPrefix(
+            ripple::TokenType::AccountID, tooLarge, 4, buf)
+            .error() == TokenCodecErrc::InputTooLarge);
+    REQUIRE(
+        ripple::b58_fast::encodeBase58TokenPrefix(
+            ripple::TokenType::AccountID,
+            std::span(tooLarge).first(20),
+            10,
+            buf)
+            .error() == TokenCodecErrc::OutputTooSmall);
+}
+
+template <ripple::TokenType Type>
+static void
+checkPrefixIndex(std::size_t numPayloads)
+{
+    using Payload = ripple::b58_fast::TokenPayload<Type>;
+    auto& rng = randEngine();
+    std::uniform_int_distribution<std::uint8_t> byteDist(0, 255);
+    std::uniform_int_distribution<std::size_t> lenDist(1, 8);
+    std::vector<Payload> payloads(numPayloads);
+    for (std::size_t i = 0; i < payloads.size(); ++i)
+    {
+        std::generate(payloads[i].begin(), payloads[i].end(), [&] {
+            return byteDist(rng);
+        });
+        // Leading zero bytes make shorter tokens
+        if (i % 16 == 1)
+            std::fill_n(payloads[i].begin(), i % 5, 0);
+    }
+    auto const encode = [](Payload const& payload) {
+        return ripple::b58_ref::encodeBase58Token(
+            Type, payload.data(), payload.size());
+    };
+
+    std::vector<std::string> prefixes{"", "r", "rr", "rrr", "z", "2"};
+    for (std::size_t i = 0; i < 300; ++i)
+    {
+        auto const token = encode(payloads[i]);
+        prefixes.push_back(token.substr(0, lenDist(rng)));
+    }
+    prefixes.push_back(encode(payloads[0]));
+    // The payloads at the ends of the ranges may or may not match: make sure
+    // some are indexed
+    for (auto const& prefix : prefixes)
+    {
+        auto const ranges =
+            ripple::b58_fast::base58PrefixRanges<Type>(prefix);
+        REQUIRE(ranges);
+        REQUIRE(ranges.value().size() <= 3);
+        for (auto const& range : ranges.value())
+        {
+            REQUIRE(range.low <= range.high);
+            payloads.push_back(range.low);
+            payloads.push_back(range.high);
+        }
+    }
+
+    ripple::b58_fast::Base58PrefixIndex<Type> const index(payloads);
+    REQUIRE(std::is_sorted(index.payloads().begin(), index.payloads().end()));
+    std::vector<std::string> tokens;
+    for (auto const& payload : index.payloads())
+        tokens.push_back(encode(payload));
+    for (auto const& prefix : prefixes)
+    {
+        std::vector<Payload> expected;
+        for (std::size_t i = 0; i < tokens.size(); ++i)
+        {
+            if (tokens[i].starts_with(prefix))
+                expected.push_back(index.payloads()[i]);
+        }
+        auto const matches = index.find(prefix);
+        REQUIRE(matches);
+        std::vector<Payload> found;
+        for (auto const& run : matches.value())
+            found.insert(found.end(), run.begin(), run.end());
+        REQUIRE(found == expected);
+        REQUIRE(index.count(prefix).value() == expected.size());
+    }
+    REQUIRE(
+        index.find("r0").error() == TokenCodecErrc::InvalidEncodingChar);
+}
+
+TEST_CASE("Prefix index matches a scan", "[b58_fast]")
+{
+    checkPrefixIndex<ripple::TokenType::AccountID>(20000);
+    checkPrefixIndex<ripple::TokenType::NodePublic>(2000);
+    checkPrefixIndex<ripple::TokenType::FamilySeed>(2000);
+}
+
+TEST_CASE("Validation matches decode", "[b58_fast]")
+{
+    using ripple::b58_fast::ChecksumCheck;
+    auto& rng = randEngine();
+    std::uniform_int_distribution<std::uint8_t> byteDist(0, 255);
+    std::uniform_int_distribution<std::size_t> lenDist(0, 60);
+    std::uniform_int_distribution<int> editDist(0, 7);
+    std::string_view const alphabet =
+        "rpshnaf39wBUDNEGHJKLM4PQRST7VWXYZ2bcdeCg65jkm8oFqi1tuvAxyz";
+    std::array const types{
+        ripple::TokenType::None,
+        ripple::TokenType::FamilySeed,
+        ripple::TokenType::AccountID,
+        ripple::TokenType::NodePrivate,
+        ripple::TokenType::AccountSecret,
+        ripple::TokenType::NodePublic,
+        ripple::TokenType::AccountPublic};
+
+    std::vector<ripple::TokenType> tokenTypes;
+    std::vector<std::string> inputs;
+    for (std::size_t i = 0; i < 40000; ++i)
+    {
+        auto const tokType = types[i % types.size()];
+        auto const size = ripple::b58_fast::tokenPayloadSize(tokType);
+        // Up to the largest payload the codecs take
+        std::vector<std::uint8_t> payload(size ? size : 1 + i % 123);
+        std::generate(payload.begin(), payload.end(), [&] {
+            return byteDist(rng);
+        });
+        if (i % 16 == 3)
+            std::fill_n(payload.begin(), payload.size() / 2 + i % 3, 0);
+        if (i % 64 == 5)
+            std::fill(payload.begin(), payload.end(), 0);
+        if (i % 64 == 7)
+            std::fill(payload.begin(), payload.end(), 0xff);
+        // Tokens of the type, of another type, and edited or random ones
+        auto const encodedType = i % 13 == 0
+            ? types[(i / 13) % types.size()]
+            : tokType;
+        std::string s = ripple::b58_ref::encodeBase58Token(
+            encodedType, payload.data(), payload.size());
+        switch (editDist(rng))
+        {
+            case 0:
+                s[i % s.size()] = alphabet[i % alphabet.size()];
+                break;
+            case 1:
+                s[i % s.size()] = "0OIl @\n"[i % 7];
+                break;
+            case 2:
+                s.resize(lenDist(rng));
+                for (auto& c : s)
+                    c = alphabet[byteDist(rng) % alphabet.size()];
+                break;
+            case 3:
+                s.insert(s.begin(), alphabet[i % alphabet.size()]);
+                break;
+            case 4:
+                s.pop_back();
+                break;
+            default:
+                break;
+        }
+        tokenTypes.push_back(tokType);
+        inputs.push_back(std::move(s));
+    }
+
+    std::size_t numValid = 0;
+    for (std::size_t i = 0; i < inputs.size(); ++i)
+    {
+        // Tokens of the types with a fixed size must have that size
+        auto const decoded = [&](auto const& r) {
+            auto const size =
+                ripple::b58_fast::tokenPayloadSize(tokenTypes[i]);
+            return r && (!size || r.value().size() == size);
+        };
+        std::array<
+            std::uint8_t,
+            ripple::b58_fast::decodedSizeUpperBound(
+                ripple::b58_fast::maxBase58TokenChars)>
+            buf;
+        bool const decodes = decoded(ripple::b58_fast::decodeBase58Token(
+            tokenTypes[i], inputs[i], buf));
+        REQUIRE(
+            ripple::b58_fast::isValidBase58Token(tokenTypes[i], inputs[i]) ==
+            decodes);
+        bool const trusted =
+            decoded(ripple::b58_fast::decodeTrustedBase58Token(
+                tokenTypes[i], inputs[i], buf));
+        REQUIRE(
+            ripple::b58_fast::isValidBase58Token(
+                tokenTypes[i], inputs[i], ChecksumCheck::trusted) == trusted);
+        numValid += decodes;
+    }
+    // Three in eight tokens are left as they are
+    REQUIRE(numValid > inputs.size() / 4);
+    REQUIRE(!ripple::b58_fast::isValidBase58Token(
+        ripple::TokenType::AccountID, ""));
+    // Payloads larger than any of the fixed sizes
+    std::vector<std::uint8_t> const large(123, 0xab);
+    for (std::size_t size : {65, 100, 123})
+    {
+        auto const token = ripple::b58_ref::encodeBase58Token(
+            ripple::TokenType::None, large.data(), size);
+        REQUIRE(ripple::b58_fast::isValidBase58Token(
+            ripple::TokenType::None, token));
+        REQUIRE(ripple::b58_fast::isValidBase58Token(
+            ripple::TokenType::None, token, ChecksumCheck::trusted));
+    }
+
+    for (auto const tokType : types)
+    {
+        std::vector<std::string_view> batch;
+        for (std::size_t i = 0; i < inputs.size(); ++i)
+        {
+            if (tokenTypes[i] == tokType || i % 5 == 0)
+                batch.push_back(inputs[i]);
+        }
+        auto const valid = std::make_unique<bool[]>(batch.size());
+        auto const r = ripple::b58_fast::isValidBase58TokenBatch(
+            tokType, batch, std::span(valid.get(), batch.size()));
+        REQUIRE(r);
+        std::size_t expected = 0;
+        for (std::size_t i = 0; i < batch.size(); ++i)
+        {
+            bool const v =
+                ripple::b58_fast::isValidBase58Token(tokType, batch[i]);
+            REQUIRE(valid[i] == v);
+            expected += v;
+        }
+        REQUIRE(r.value() == expected);
+    }
+    std::array<std::string_view, 2> two{"r", "r"};
+    std::array<bool, 1> one;
+    REQUIRE(
+        ripple::b58_fast::isValidBase58TokenBatch(
+            ripple::TokenType::AccountID, two, one)
+            .error() == TokenCodecErrc::OutputTooSmall);
+}
+
+// Base 58 of any data with a big integer library
+static std::string
+rawBase58Oracle(std::span<std::uint8_t const> input)
+{
+    using boost::multiprecision::cpp_int;
+    std::string_view const alphabet =
+        "rpshnaf39wBUDNEGHJKLM4PQRST7VWXYZ2bcdeCg65jkm8oFqi1tuvAxyz";
+    std::size_t const zeros =
+        std::find_if(input.begin(), input.end(), [](auto c) { return c; }) -
+        input.begin();
+    cpp_int x;
+    if (zeros < input.size())
+        import_bits(x, input.begin() + zeros, input.end());
+    std::string digits;
+    cpp_int const b58_10 = cpp_int(430804206899405824ull);
+    while (x != 0)
+    {
+        auto coeff = static_cast<std::uint64_t>(x % b58_10);
+        x /= b58_10;
+        for (int i = 0; i < 10; ++i, coeff /= 58)
+            digits += alphabet[coeff % 58];
+    }
+    while (!digits.empty() && digits.back() == alphabet[0])
+        digits.pop_back();
+    digits.append(zeros, alphabet[0]);
+    return {digits.rbegin(), digits.rend()};
+}
+
+TEST_CASE("Raw codecs match a reference", "[b58_fast]")
+{
+    auto& rng = randEngine();
+    std::uniform_int_distribution<std::uint8_t> byteDist(0, 255);
+    auto const roundTrip = [&](std::size_t size, bool useOracle) {
+        std::vector<std::uint8_t> data(size);
+        std::generate(data.begin(), data.end(), [&] { return byteDist(rng); });
+        if (size % 3 == 1)
+            std::fill_n(data.begin(), size / 4, 0);
+        if (size % 7 == 2)
+            std::fill(data.begin(), data.end(), 0xff);
+        std::vector<std::uint8_t> encoded(
+            ripple::b58_fast::rawEncodedSizeUpperBound(size));
+        auto const e = ripple::b58_fast::encodeBase58Raw(data, encoded);
+        REQUIRE(e);
+        std::string_view const s(
+            reinterpret_cast<char const*>(e.value().data()), e.value().size());
+        if (useOracle)
+            REQUIRE(s == rawBase58Oracle(data));
+        std::vector<std::uint8_t> decoded(
+            ripple::b58_fast::rawDecodedSizeUpperBound(s.size()));
+        auto const d = ripple::b58_fast::decodeBase58Raw(s, decoded);
+        REQUIRE(d);
+        REQUIRE(std::equal(
+            data.begin(), data.end(), d.value().begin(), d.value().end()));
+    };
+    for (std::size_t size = 0; size < 100; ++size)
+        roundTrip(size, true);
+    // Past the quadratic cutoffs, and through several levels of the
+    // recursions (with reciprocals of a few hundred coeffs)
+    for (std::size_t size : {255, 256, 257, 600, 1000, 2049, 4000, 6000})
+        roundTrip(size, true);
+    for (std::size_t size : {16384, 100000, 300001})
+        roundTrip(size, false);
+
+    // Tokens are raw encodings of the expanded token
+    for (int i = 0; i < 1000; ++i)
+    {
+        std::array<std::uint8_t, 64> b256DataBuf;
+        auto const [tokType, b256Data] = random_b256_test_data(b256DataBuf);
+        auto const token = ripple::b58_ref::encodeBase58Token(
+            tokType, b256Data.data(), b256Data.size());
+        std::array<std::uint8_t, 64> expanded;
+        auto const d = ripple::b58_fast::decodeBase58Raw(token, expanded);
+        REQUIRE(d);
+        REQUIRE(d.value().size() == b256Data.size() + 5);
+        std::array<std::uint8_t, 128> encoded;
+        auto const e = ripple::b58_fast::encodeBase58Raw(d.value(), encoded);
+        REQUIRE(e);
+        REQUIRE(
+            std::string_view(
+                reinterpret_cast<char const*>(e.value().data()),
+                e.value().size()) == token);
+    }
+
+    std::array<std::uint8_t, 8> small;
+    REQUIRE(
+        ripple::b58_fast::decodeBase58Raw("rpsh0", small).error() ==
+        TokenCodecErrc::InvalidEncodingChar);
+    std::array<std::uint8_t, 9> nine{1, 2, 3, 4, 5, 6, 7, 8, 9};
+    REQUIRE(
+        ripple::b58_fast::encodeBase58Raw(nine, small).error() ==
+        TokenCodecErrc::OutputTooSmall);
+    REQUIRE(
+        ripple::b58_fast::decodeBase58Raw("zzzzzzzzzzzzzzzzzz", small)
+            .error() == TokenCodecErrc::OutputTooSmall);
+}
+
+TEST_CASE("Trusted decode skips only the checksum", "[b58_fast]")
+{
+    constexpr std::size_t iters = 10000;
+    auto& rng = randEngine();
+    std::uniform_int_distribution<int> corruptDist(0, 7);
+    std::vector<ripple::TokenType> types(iters);
+    std::vector<std::string> encoded(iters);
+    for (std::size_t i = 0; i < iters; ++i)
+    {
+        std::array<std::uint8_t, 64> b256DataBuf;
+        auto const [tokType, b256Data] = random_b256_test_data(b256DataBuf);
+        types[i] = tokType;
+        auto& e = encoded[i];
+        e = ripple::b58_ref::encodeBase58Token(
+            tokType, b256Data.data(), b256Data.size());
+        std::uniform_int_distribution<std::size_t> posDist(0, e.size() - 1);
+        switch (corruptDist(rng))
+        {
+            case 0:
+                e[posDist(rng)] =
+                    ripple::b58_fast::detail::b58Alphabet[posDist(rng)];
+                break;
+            case 1:
+                e.back() = e.back() == 'r' ? 'p' : 'r';
+                break;
+            case 2:
+                types[i] = std::get<0>(random_token_type_and_size());
+                break;
+            case 3:
+                e[posDist(rng)] = '0';
+                break;
+            default:
+                break;
+        }
+    }
+
+    std::vector<std::string_view> inputs(encoded.begin(), encoded.end());
+    std::vector<TokenCodecErrc> statuses(iters);
+    auto const failed =
+        ripple::b58_fast::verifyBase58TokenBatch(types, inputs, statuses);
+    REQUIRE(failed);
+
+    std::size_t expectedFailed = 0;
+    for (std::size_t i = 0; i < iters; ++i)
+    {
+        std::array<std::uint8_t, 64> expectedBuf;
+        std::array<std::uint8_t, 64> trustedBuf;
+        auto const expected = ripple::b58_fast::decodeBase58Token(
+            types[i], inputs[i], expectedBuf);
+        auto const trusted = ripple::b58_fast::decodeTrustedBase58Token(
+            types[i], inputs[i], trustedBuf);
+        if (expected)
+        {
+            REQUIRE(statuses[i] == TokenCodecErrc::Success);
+            REQUIRE(trusted);
+            REQUIRE(std::equal(
+                trusted.value().begin(),
+                trusted.value().end(),
+                expected.value().begin(),
+                expected.value().end()));
+            continue;
+        }
+        ++expectedFailed;
+        REQUIRE(make_error_code(statuses[i]) == expected.error());
+        if (expected.error() == TokenCodecErrc::MismatchedChecksum)
+            REQUIRE(trusted);
+        else
+            REQUIRE(trusted.error() == expected.error());
+    }
+    REQUIRE(failed.value() == expectedFailed);
+    REQUIRE(expectedFailed > 0);
+
+    // The fixed size form
+    std::array<std::uint8_t, 64> b58Buf;
+    ripple::b58_fast::TokenPayload<ripple::TokenType::AccountID> id{};
+    id.back() = 1;
+    auto const r =
+        ripple::b58_fast::encode<ripple::TokenType::AccountID>(id, b58Buf);
+    REQUIRE(r);
+    std::string s(r.value().begin(), r.value().end());
+    REQUIRE(
+        ripple::b58_fast::decodeTrusted<ripple::TokenType::AccountID>(s)
+            .value() == id);
+    s.back() = s.back() == 'r' ? 'p' : 'r';
+    REQUIRE(!ripple::b58_fast::decode<ripple::TokenType::AccountID>(s));
+    REQUIRE(
+        ripple::b58_fast::decodeTrusted<ripple::TokenType::AccountID>(s)
+            .value() == id);
+    REQUIRE(!ripple::b58_fast::decodeTrusted<ripple::TokenType::NodePublic>(s));
+    REQUIRE(!ripple::b58_fast::decodeTrusted<ripple::TokenType::AccountID>(
+        "0" + s));
+}
+
+TEST_CASE("Decode cache matches decode", "[b58_fast]")
+{
+    auto& rng = randEngine();
+    // A pool of tokens, some of them invalid, that doesn't fit in the cache
+    constexpr std::size_t poolSize = 300;
+    std::vector<ripple::TokenType> types(poolSize);
+    std::vector<std::string> pool(poolSize);
+    for (std::size_t j = 0; j < poolSize; ++j)
+    {
+        std::array<std::uint8_t, 64> b256DataBuf;
+        auto const [tokType, b256Data] = random_b256_test_data(b256DataBuf);
+        types[j] = tokType;
+        pool[j] = ripple::b58_ref::encodeBase58Token(
+            tokType, b256Data.data(), b256Data.size());
+        if (j % 10 == 0)
+            pool[j].back() = pool[j].back() == 'r' ? 'p' : 'r';
+        else if (j % 10 == 1)
+            types[j] = std::get<0>(random_token_type_and_size());
+    }
+
+    auto matches = [&](ripple::b58_fast::DecodeCache& cache,
+                       std::size_t j,
+                       std::size_t outSize) {
+        std::array<std::uint8_t, 64> expectedBuf;
+        std::array<std::uint8_t, 64> gotBuf;
+        auto const expected = ripple::b58_fast::decodeBase58Token(
+            types[j], pool[j], std::span(expectedBuf).first(outSize));
+        auto const got =
+            cache.decode(types[j], pool[j], std::span(gotBuf).first(outSize));
+        if (!expected || !got)
+            return !expected && !got && expected.error() == got.error();
+        return std::equal(
+            got.value().begin(),
+            got.value().end(),
+            expected.value().begin(),
+            expected.value().end());
+    };
+
+    ripple::b58_fast::DecodeCache cache(64, 4);
+    REQUIRE(cache.capacity() == 64);
+    constexpr std::size_t iters = 20000;
+    std::uniform_int_distribution<std::size_t> poolDist(0, poolSize - 1);
+    std::uniform_int_distribution<std::size_t> outSizeDist(0, 64);
+    for (std::size_t i = 0; i < iters; ++i)
+    {
+        // Favor the start of the pool so there are hits as well as misses
+        auto const j = i % 2 ? poolDist(rng) % 32 : poolDist(rng);
+        auto const outSize = i % 16 ? 64 : outSizeDist(rng);
+        REQUIRE(matches(cache, j, outSize));
+    }
+    auto const stats = cache.stats();
+    REQUIRE(stats.hits + stats.misses == iters);
+    REQUIRE(stats.hits > iters / 4);
+    REQUIRE(stats.insertions - stats.evictions <= cache.capacity());
+
+    // A token that was just decoded is found without decoding
+    std::array<std::uint8_t, 64> buf;
+    REQUIRE(cache.decode(types[2], pool[2], buf));
+    REQUIRE(!cache.find(types[2], pool[2], buf).empty());
+    // Another type never hits
+    auto const otherType = static_cast<ripple::TokenType>(
+        static_cast<std::uint8_t>(types[2]) + 1);
+    REQUIRE(cache.find(otherType, pool[2], buf).empty());
+    cache.clear();
+    REQUIRE(cache.find(types[2], pool[2], buf).empty());
+
+    // Threads sharing a cache that is much smaller than the working set
+    ripple::b58_fast::DecodeCache shared(32, 2);
+    std::atomic<std::size_t> mismatches{0};
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&, seed = rng()] {
+            std::mt19937 threadRng(seed);
+            for (std::size_t i = 0; i < iters; ++i)
+            {
+                if (!matches(shared, poolDist(threadRng) % 64, 64))
+                    ++mismatches;
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    REQUIRE(mismatches == 0);
+}
+
+TEST_CASE("Encode cache matches encode", "[b58_fast]")
+{
+    auto& rng = randEngine();
+    std::uniform_int_distribution<std::uint8_t> byteDist(0, 255);
+    auto check = [&]<std::size_t N>() {
+        // A pool of payloads, with a few types each, that doesn't fit in the
+        // cache
+        constexpr std::size_t poolSize = 300;
+        std::vector<ripple::TokenType> types(poolSize);
+        std::vector<std::array<std::uint8_t, N>> pool(poolSize);
+        for (std::size_t j = 0; j < poolSize; ++j)
+        {
+            types[j] = std::get<0>(random_token_type_and_size());
+            std::generate(pool[j].begin(), pool[j].end(), [&] {
+                return byteDist(rng);
+            });
+            if (j % 8 == 0)
+                std::fill_n(pool[j].begin(), j % N, 0);
+            if (j % 3 == 1)
+                pool[j] = pool[j - 1];
+        }
+
+        auto matches = [&](ripple::b58_fast::EncodeCache<N>& cache,
+                           std::size_t j,
+                           std::size_t outSize) {
+            std::array<std::uint8_t, 64> expectedBuf;
+            std::array<std::uint8_t, 64> gotBuf;
+            auto const expected = ripple::b58_fast::encodeBase58Token(
+                types[j], pool[j], std::span(expectedBuf).first(outSize));
+            auto const got = cache.encode(
+                types[j], pool[j], std::span(gotBuf).first(outSize));
+            if (!expected || !got)
+                return !expected && !got && expected.error() == got.error();
+            return std::equal(
+                got.value().begin(),
+                got.value().end(),
+                expected.value().begin(),
+                expected.value().end());
+        };
+
+        ripple::b58_fast::EncodeCache<N> cache(4096);
+        REQUIRE(cache.bytes() <= 4096);
+        REQUIRE(cache.capacity() >= cache.probes);
+        constexpr std::size_t iters = 20000;
+        std::uniform_int_distribution<std::size_t> poolDist(0, poolSize - 1);
+        std::uniform_int_distribution<std::size_t> outSizeDist(0, 64);
+        for (std::size_t i = 0; i < iters; ++i)
+        {
+            auto const j = i % 2 ? poolDist(rng) % 16 : poolDist(rng);
+            auto const outSize = i % 16 ? 64 : outSizeDist(rng);
+            REQUIRE(matches(cache, j, outSize));
+            if (i == iters / 2)
+                cache.clear();
+        }
+
+        // Threads sharing a cache that is much smaller than the working set
+        ripple::b58_fast::EncodeCache<N> shared(1024);
+        std::atomic<std::size_t> mismatches{0};
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&, seed = rng()] {
+                std::mt19937 threadRng(seed);
+                for (std::size_t i = 0; i < iters; ++i)
+                {
+                    if (!matches(shared, poolDist(threadRng) % 64, 64))
+                        ++mismatches;
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        REQUIRE(mismatches == 0);
+    };
+    check.template operator()<16>();
+    check.template operator()<20>();
+    check.template operator()<32>();
+    check.template operator()<33>();
+}
+
+TEST_CASE("Codec kernels match reference", "[b58_fast]")
+{
+    using ripple::b58_fast::CodecKernel;
+    namespace kdetail = ripple::b58_fast::detail;
+    constexpr std::size_t lanes = kdetail::kernelLanes;
+    constexpr std::size_t iters = 20000;
+    for (auto kernel :
+         {CodecKernel::scalar, CodecKernel::avx2, CodecKernel::avx512})
+    {
+        if (!ripple::b58_fast::kernelSupported(kernel))
+            continue;
+        for (int i = 0; i < iters; ++i)
+        {
+            std::array<std::array<std::uint8_t, 64>, lanes> b256DataBuf;
+            std::array<std::tuple<ripple::TokenType, std::span<std::uint8_t>>,
+                       lanes>
+                data;
+            std::array<std::string, lanes> refEncoded;
+            std::array<std::string_view, lanes> toDecode;
+            // Use fewer lanes than the kernel width some of the time
+            std::size_t const n = i % 4 ? lanes : (i / 4) % lanes + 1;
+            for (std::size_t lane = 0; lane < n; ++lane)
+            {
+                data[lane] = random_b256_test_data(b256DataBuf[lane]);
+                auto const [tokType, b256Data] = data[lane];
+                if (lane % 3 == 0)
+                {
+                    // exercise the leading zero handling
+                    std::fill_n(b256Data.begin(), lane % 5, 0);
+                }
+                refEncoded[lane] = ripple::b58_ref::encodeBase58Token(
+                    tokType, b256Data.data(), b256Data.size());
+                toDecode[lane] = refEncoded[lane];
+            }
+
+            // Decode to the expanded token: type + payload + checksum
+            std::array<std::array<std::uint8_t, 64>, lanes> decodedBuf;
+            std::array<std::span<std::uint8_t>, lanes> decoded;
+            std::array<TokenCodecErrc, lanes> status;
+            for (std::size_t lane = 0; lane < n; ++lane)
+                decoded[lane] = decodedBuf[lane];
+            kdetail::b58_to_b256_kernel(
+                kernel,
+                std::span(toDecode.data(), n),
+                std::span(decoded.data(), n),
+                std::span(status.data(), n));
+            for (std::size_t lane = 0; lane < n; ++lane)
+            {
+                auto const [tokType, b256Data] = data[lane];
+                REQUIRE(status[lane] == TokenCodecErrc::Success);
+                REQUIRE(decoded[lane].size() == b256Data.size() + 5);
+                REQUIRE(
+                    decoded[lane][0] == static_cast<std::uint8_t>(tokType));
+                REQUIRE(std::equal(
+                    b256Data.begin(),
+                    b256Data.end(),
+                    decoded[lane].begin() + 1));
+            }
+
+            // Encode the expanded token back
+            std::array<std::span<std::uint8_t const>, lanes> toEncode;
+            std::array<std::array<std::uint8_t, 64>, lanes> encodedBuf;
+            std::array<std::span<std::uint8_t>, lanes> encoded;
+            for (std::size_t lane = 0; lane < n; ++lane)
+            {
+                toEncode[lane] = decoded[lane];
+                encoded[lane] = encodedBuf[lane];
+            }
+            kdetail::b256_to_b58_kernel(
+                kernel,
+                std::span(toEncode.data(), n),
+                std::span(encoded.data(), n),
+                std::span(status.data(), n));
+            for (std::size_t lane = 0; lane < n; ++lane)
+            {
+                REQUIRE(status[lane] == TokenCodecErrc::Success);
+                REQUIRE(std::equal(
+                    encoded[lane].begin(),
+                    encoded[lane].end(),
+                    refEncoded[lane].begin(),
+                    refEncoded[lane].end()));
+            }
+        }
+
+        // Invalid characters are reported per lane
+        std::array<std::string_view, 2> bad{
+            "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh",
+            "rHb9CJAWyB4rj91VRWn96DkukG4bwdty0h"};
+        std::array<std::array<std::uint8_t, 64>, 2> badBuf;
+        std::array<std::span<std::uint8_t>, 2> badOut{badBuf[0], badBuf[1]};
+        std::array<TokenCodecErrc, 2> badStatus;
+        kdetail::b58_to_b256_kernel(kernel, bad, badOut, badStatus);
+        REQUIRE(badStatus[0] == TokenCodecErrc::Success);
+        REQUIRE(badStatus[1] == TokenCodecErrc::InvalidEncodingChar);
+    }
+}
+
+TEST_CASE("Fixed size codecs match reference", "[b58_fast]")
+{
+    auto& rng = randEngine();
+    std::uniform_int_distribution<std::uint8_t> byteDist(0, 255);
+
+    auto check = [&]<ripple::TokenType Type>() {
+        constexpr std::size_t iters = 20000;
+        for (int i = 0; i < iters; ++i)
+        {
+            ripple::b58_fast::TokenPayload<Type> payload;
+            std::generate(
+                payload.begin(), payload.end(), [&] { return byteDist(rng); });
+            // exercise the leading zero handling, including all zeros
+            if (i % 8 == 0)
+                std::fill_n(
+                    payload.begin(), (i / 8) % (payload.size() + 1), 0);
+
+            std::array<std::uint8_t, 64> b58Buf;
+            auto const encoded =
+                ripple::b58_fast::encode<Type>(payload, b58Buf);
+            REQUIRE(encoded);
+            std::string const s(encoded.value().begin(), encoded.value().end());
+            REQUIRE(
+                s ==
+                ripple::b58_ref::encodeBase58Token(
+                    Type, payload.data(), payload.size()));
+
+            auto const decoded = ripple::b58_fast::decode<Type>(s);
+            REQUIRE(decoded);
+            REQUIRE(decoded.value() == payload);
+
+            // Any hasher can compute the checksum
+            using OpenSSL = ripple::openssl_sha256_hasher;
+            auto const encodedOpenSSL =
+                ripple::b58_fast::encode<Type, OpenSSL>(payload, b58Buf);
+            REQUIRE(encodedOpenSSL);
+            REQUIRE(std::equal(
+                s.begin(),
+                s.end(),
+                encodedOpenSSL.value().begin(),
+                encodedOpenSSL.value().end()));
+            auto const decodedOpenSSL =
+                ripple::b58_fast::decode<Type, OpenSSL>(s);
+            REQUIRE(decodedOpenSSL);
+            REQUIRE(decodedOpenSSL.value() == payload);
+
+            // A leading zero digit adds a zero byte, so the size is wrong
+            REQUIRE(!ripple::b58_fast::decode<Type>("r" + s));
+            // Truncated tokens must not decode either
+            REQUIRE(!ripple::b58_fast::decode<Type>(s.substr(1)));
+        }
+    };
+    check.template operator()<ripple::TokenType::FamilySeed>();
+    check.template operator()<ripple::TokenType::AccountID>();
+    check.template operator()<ripple::TokenType::NodePrivate>();
+    check.template operator()<ripple::TokenType::AccountSecret>();
+    check.template operator()<ripple::TokenType::NodePublic>();
+    check.template operator()<ripple::TokenType::AccountPublic>();
+
+    // The type and checksum are checked
+    std::array<std::uint8_t, 64> b58Buf;
+    ripple::b58_fast::TokenPayload<ripple::TokenType::AccountID> id{};
+    id.back() = 1;
+    auto const encoded =
+        ripple::b58_fast::encode<ripple::TokenType::AccountID>(id, b58Buf);
+    REQUIRE(encoded);
+    std::string s(encoded.value().begin(), encoded.value().end());
+    auto const wrongType = ripple::b58_fast::decodeBase58Token<20>(
+        ripple::TokenType::NodePrivate, s);
+    REQUIRE(wrongType.error() == TokenCodecErrc::MismatchedTokenType);
+    s.back() = s.back() == 'r' ? 'p' : 'r';
+    auto const badChecksum =
+        ripple::b58_fast::decode<ripple::TokenType::AccountID>(s);
+    REQUIRE(badChecksum.error() == TokenCodecErrc::MismatchedChecksum);
+    auto const badChar =
+        ripple::b58_fast::decode<ripple::TokenType::AccountID>("0" + s);
+    REQUIRE(badChar.error() == TokenCodecErrc::InvalidEncodingChar);
+}
+
+TEST_CASE("parseBase58 decodes into fixed size types", "[b58_fast]")
+{
+    auto& rng = randEngine();
+    std::uniform_int_distribution<std::uint8_t> byteDist(0, 255);
+
+    // A type like uint160, that is not a std::array
+    struct Uint160
+    {
+        std::array<std::uint8_t, 20> bytes;
+    };
+    static_assert(ripple::Base58Payload<Uint160>);
+    static_assert(!ripple::Base58Payload<std::array<std::uint8_t, 21>>);
+    // Padding bytes can't hold a payload
+    struct Padded
+    {
+        std::uint8_t a;
+        std::uint32_t b[4];
+    };
+    static_assert(sizeof(Padded) == 20);
+    static_assert(!ripple::Base58Payload<Padded>);
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        ripple::b58_fast::TokenPayload<ripple::TokenType::AccountID> id;
+        std::generate(id.begin(), id.end(), [&] { return byteDist(rng); });
+        ripple::b58_fast::TokenPayload<ripple::TokenType::NodePublic> pk;
+        std::generate(pk.begin(), pk.end(), [&] { return byteDist(rng); });
+        auto const idToken = ripple::b58_ref::encodeBase58Token(
+            ripple::TokenType::AccountID, id.data(), id.size());
+        auto const pkToken = ripple::b58_ref::encodeBase58Token(
+            ripple::TokenType::NodePublic, pk.data(), pk.size());
+
+        auto const parsedId = ripple::parseBase58<decltype(id)>(idToken);
+        REQUIRE(parsedId);
+        REQUIRE(*parsedId == id);
+        // Straight from a view into a larger buffer
+        std::string const json = "{\"Account\":\"" + idToken + "\"}";
+        auto const parsedUint = ripple::parseBase58<Uint160>(
+            std::string_view(json).substr(12, idToken.size()));
+        REQUIRE(parsedUint);
+        REQUIRE(parsedUint->bytes == id);
+
+        auto const parsedPk = ripple::parseBase58<decltype(pk)>(
+            ripple::TokenType::NodePublic, pkToken);
+        REQUIRE(parsedPk);
+        REQUIRE(*parsedPk == pk);
+
+        // The type, size and checksum are checked
+        REQUIRE(!ripple::parseBase58<decltype(pk)>(
+            ripple::TokenType::AccountPublic, pkToken));
+        REQUIRE(!ripple::parseBase58<decltype(id)>(pkToken));
+        REQUIRE(!ripple::parseBase58<std::array<std::uint8_t, 32>>(
+            ripple::TokenType::NodePublic, pkToken));
+        std::string bad = idToken;
+        bad[i % bad.size()] = bad[i % bad.size()] == 'r' ? 'p' : 'r';
+        REQUIRE(!ripple::parseBase58<decltype(id)>(bad));
+    }
+
+    // Strings too short for the payload fail before the base conversion
+    auto const tooShort =
+        ripple::b58_fast::decode<ripple::TokenType::AccountID>(
+            std::string(24, 'z'));
+    REQUIRE(tooShort.error() == TokenCodecErrc::InputTooSmall);
+}
+
+TEST_CASE("File codecs round trip", "[b58_fast]")
+{
+    auto& rng = randEngine();
+    std::uniform_int_distribution<std::uint8_t> byteDist(0, 255);
+    auto const dir = std::filesystem::temp_directory_path();
+    auto const tag = std::to_string(rng());
+    auto const binPath = dir / ("xrpl_b58_test_" + tag + ".bin");
+    auto const textPath = dir / ("xrpl_b58_test_" + tag + ".txt");
+    auto const outPath = dir / ("xrpl_b58_test_" + tag + ".out");
+    auto read_file = [](std::filesystem::path const& path) {
+        std::ifstream f(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(f), {});
+    };
+    auto write_file = [](std::filesystem::path const& path,
+                         std::string const& data) {
+        std::ofstream f(path, std::ios::binary | std::ios::trunc);
+        f.write(data.data(), data.size());
+    };
+    // Small chunks so the files span many of them
+    ripple::b58_fast::StreamOptions const options{.chunkTokens = 1000};
+
+    for (auto const& [tokType, stride] :
+         {std::pair{ripple::TokenType::AccountID, std::size_t{20}},
+          std::pair{ripple::TokenType::NodePublic, std::size_t{33}}})
+    {
+        std::size_t const n = 2500 + rng() % 1000;
+        std::string payloads(n * stride, 0);
+        std::generate(payloads.begin(), payloads.end(), [&] {
+            return byteDist(rng);
+        });
+        write_file(binPath, payloads);
+
+        auto const encoded = ripple::b58_fast::encodeBase58File(
+            tokType, stride, binPath, textPath, options);
+        REQUIRE(encoded);
+        REQUIRE(encoded.value().tokens == n);
+        REQUIRE(encoded.value().failed == 0);
+        std::string expected;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            expected += ripple::b58_ref::encodeBase58Token(
+                tokType, payloads.data() + i * stride, stride);
+            expected += '\n';
+        }
+        auto text = read_file(textPath);
+        REQUIRE(text == expected);
+        REQUIRE(encoded.value().bytesOut == text.size());
+
+        auto decoded = ripple::b58_fast::decodeBase58File(
+            tokType, stride, textPath, outPath, options);
+        REQUIRE(decoded);
+        REQUIRE(decoded.value().tokens == n);
+        REQUIRE(decoded.value().failed == 0);
+        REQUIRE(read_file(outPath) == payloads);
+
+        // A bad token decodes to zeros; CRLF and a missing final newline
+        // are accepted
+        auto const first = text.find('\n');
+        text[first / 2] = text[first / 2] == 'r' ? 'p' : 'r';
+        text.insert(first, "\r");
+        text.pop_back();
+        write_file(textPath, text);
+        decoded = ripple::b58_fast::decodeBase58File(
+            tokType, stride, textPath, outPath, options);
+        REQUIRE(decoded);
+        REQUIRE(decoded.value().tokens == n);
+        REQUIRE(decoded.value().failed == 1);
+        std::fill_n(payloads.begin(), stride, 0);
+        REQUIRE(read_file(outPath) == payloads);
+    }
+
+    // The input must hold whole payloads
+    write_file(binPath, std::string(41, 'x'));
+    auto const partial = ripple::b58_fast::encodeBase58File(
+        ripple::TokenType::AccountID, 20, binPath, textPath);
+    REQUIRE(partial.error() == TokenCodecErrc::InputTooSmall);
+    REQUIRE(!ripple::b58_fast::encodeBase58File(
+        ripple::TokenType::AccountID, 20, dir / "xrpl_b58_missing", textPath));
+
+    for (auto const& p : {binPath, textPath, outPath})
+        std::filesystem::remove(p);
+}
+
+TEST_CASE("Bulk conversions match the codecs", "[b58_fast]")
+{
+    using namespace ripple::b58_fast;
+    auto& rng = randEngine();
+    std::uniform_int_distribution<int> byteDist(0, 255);
+    auto to_hex = [](std::string_view bytes) {
+        std::string hex;
+        for (unsigned char b : bytes)
+        {
+            hex += "0123456789abcdef"[b >> 4];
+            hex += "0123456789abcdef"[b & 15];
+        }
+        return hex;
+    };
+    // Reads `data` a few bytes at a time, so lines straddle the reads
+    auto reader_of = [](std::string const& data, BulkOptions const& o) {
+        return BulkChunkReader(
+            [&data, pos = std::size_t{0}](
+                char* out, std::size_t size) mutable {
+                auto const n = std::min(size, data.size() - pos);
+                std::copy_n(data.data() + pos, n, out);
+                pos += n;
+                return n;
+            },
+            o);
+    };
+    auto convert = [&](std::string const& data, BulkOptions const& o) {
+        auto reader = reader_of(data, o);
+        BulkChunkResult total;
+        std::uint64_t chunks = 0;
+        auto const r = convertBulk(
+            reader, o, 4, [&](BulkChunkResult const& result) {
+                total.out += result.out;
+                total.records += result.records;
+                total.bytesIn += result.bytesIn;
+                for (std::size_t e = 0; e < numTokenCodecErrc; ++e)
+                    total.failures[e] += result.failures[e];
+                ++chunks;
+            });
+        REQUIRE(r);
+        REQUIRE(chunks > 1);
+        return total;
+    };
+
+    BulkOptions o;
+    o.chunkTokens = 7;
+    std::size_t const n = 500;
+    std::string raw, hex, expected, expectedHex;
+    std::vector<std::size_t> bad;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        std::string payload(o.stride, 0);
+        for (auto& c : payload)
+            c = static_cast<char>(byteDist(rng));
+        raw += payload;
+        auto line = to_hex(payload);
+        if (i % 50 == 3)
+        {
+            // Not a payload: a bad digit or a short line
+            line[i % 2 ? 5 : line.size() - 1] = 'g';
+            if (i % 4 == 1)
+                line.pop_back();
+            bad.push_back(i);
+            expected += '\n';
+            expectedHex += '\n';
+        }
+        else
+        {
+            expected += ripple::b58_ref::encodeBase58Token(
+                o.type, payload.data(), payload.size());
+            expected += '\n';
+            expectedHex += line + '\n';
+        }
+        hex += line;
+        hex += i % 3 ? "\n" : "\r\n";
+    }
+    // The last line has no newline
+    hex.pop_back();
+
+    SECTION("Encode raw")
+    {
+        auto const result = convert(raw, o);
+        std::string all;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            all += ripple::b58_ref::encodeBase58Token(
+                o.type, raw.data() + i * o.stride, o.stride);
+            all += '\n';
+        }
+        REQUIRE(result.out == all);
+        REQUIRE(result.records == n);
+        REQUIRE(result.bytesIn == raw.size());
+
+        // Raw input must hold whole payloads
+        auto const partial = raw.substr(0, raw.size() - 1);
+        auto reader = reader_of(partial, o);
+        auto const r =
+            convertBulk(reader, o, 4, [](BulkChunkResult const&) {});
+        REQUIRE(r.error() == TokenCodecErrc::InputTooSmall);
+    }
+
+    SECTION("Encode hex, decode and validate")
+    {
+        o.inFormat = BulkFormat::hex;
+        auto const encoded = convert(hex, o);
+        REQUIRE(encoded.out == expected);
+        REQUIRE(encoded.records == n);
+        REQUIRE(encoded.bytesIn == hex.size() + 1);
+        std::uint64_t failed = 0;
+        for (auto f : encoded.failures)
+            failed += f;
+        REQUIRE(failed == bad.size());
+
+        o.command = BulkCommand::decode;
+        o.inFormat = BulkFormat::b58;
+        o.outFormat = BulkFormat::hex;
+        auto const decoded = convert(encoded.out, o);
+        REQUIRE(decoded.out == expectedHex);
+        REQUIRE(decoded.records == n);
+
+        o.command = BulkCommand::validate;
+        auto const validated = convert(encoded.out, o);
+        std::string report;
+        for (auto i : bad)
+            report += std::to_string(i + 1) + '\t' +
+                make_error_code(TokenCodecErrc::InputTooSmall).message() +
+                '\n';
+        REQUIRE(validated.out == report);
+    }
+}
+
+TEST_CASE("Character translation kernels match", "[b58_fast]")
+{
+    using namespace ripple::b58_fast;
+    namespace kdetail = ripple::b58_fast::detail;
+    auto& rng = randEngine();
+    std::uniform_int_distribution<std::size_t> lenDist(0, 64);
+    std::uniform_int_distribution<std::size_t> charDist(
+        0, kdetail::b58Alphabet.size() - 1);
+    std::uniform_int_distribution<int> byteDist(0, 255);
+
+    auto const reference = kdetail::b58ToDigits(CodecKernel::scalar);
+    constexpr std::size_t iters = 100000;
+    for (auto kernel :
+         {CodecKernel::scalar, CodecKernel::avx2, CodecKernel::avx512})
+    {
+        if (!kernelSupported(kernel))
+            continue;
+        auto const translate = kdetail::b58ToDigits(kernel);
+        for (int i = 0; i < iters; ++i)
+        {
+            std::string in(lenDist(rng), 'r');
+            auto const zeros = byteDist(rng) < 64 ? lenDist(rng) : 0;
+            for (std::size_t j = zeros; j < in.size(); ++j)
+                in[j] = kdetail::b58Alphabet[charDist(rng)];
+            bool const corrupt = !in.empty() && byteDist(rng) < 64;
+            if (corrupt)
+            {
+                char bad;
+                do
+                {
+                    bad = static_cast<char>(byteDist(rng));
+                } while (kdetail::b58Alphabet.find(bad) !=
+                         std::string_view::npos);
+                in[lenDist(rng) % in.size()] = bad;
+            }
+
+            std::array<std::uint8_t, 64> digits, refDigits;
+            std::size_t leadingZeros = 0, refLeadingZeros = 0;
+            bool const ok = translate(in, digits, leadingZeros);
+            REQUIRE(ok == !corrupt);
+            REQUIRE(reference(in, refDigits, refLeadingZeros) == ok);
+            if (!ok)
+                continue;
+            REQUIRE(digits == refDigits);
+            REQUIRE(leadingZeros == refLeadingZeros);
+            REQUIRE(
+                leadingZeros ==
+                std::min(in.find_first_not_of('r'), in.size()));
+            for (std::size_t j = 0; j < in.size(); ++j)
+                REQUIRE(kdetail::b58Alphabet[digits[j]] == in[j]);
+        }
+    }
+}
+
+#endif
+
 #endif
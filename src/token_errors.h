@@ -1,3 +1,6 @@
+#ifndef RIPPLE_PROTOCOL_TOKEN_ERRORS_H_INCLUDED
+#define RIPPLE_PROTOCOL_TOKEN_ERRORS_H_INCLUDED
+
 #include <system_error>
 
 enum class TokenCodecErrc {
@@ -72,3 +75,5 @@ make_error_code(TokenCodecErrc e)
 {
     return {static_cast<int>(e), TokenCodecErrcCategory()};
 }
+
+#endif
@@ -19,6 +19,7 @@
 
 #include <tokens.h>
 
+#include <b58_kernels.h>
 #include <b58_utils.h>
 
 #include <boost/container/small_vector.hpp>
@@ -26,6 +27,8 @@
 #include <boost/endian/conversion.hpp>
 #include <boost/outcome/success_failure.hpp>
 
+#include <algorithm>
+#include <bit>
 #include <cassert>
 #include <cstring>
 #include <digest.h>
@@ -37,17 +40,19 @@
 
 namespace ripple {
 
-static constexpr char const* alphabetForward =
-    "rpshnaf39wBUDNEGHJKLM4PQRST7VWXYZ2bcdeCg65jkm8oFqi1tuvAxyz";
-
-static constexpr std::array<int, 256> const alphabetReverse = []() {
-    std::array<int, 256> map{};
-    for (auto& m : map)
-        m = -1;
-    for (int i = 0, j = 0; alphabetForward[i] != 0; ++i)
-        map[static_cast<unsigned char>(alphabetForward[i])] = j++;
-    return map;
-}();
+static constexpr std::string_view alphabetForward =
+    b58_portable::detail::alphabet;
+using b58_portable::detail::alphabetReverse;
+
+// Every pair of alphabet characters, indexed by the value of the pair as two
+// base 58 digits. Lets the encoder write two digits with one 16-bit store.
+static constexpr std::array<std::array<char, 2>, 58 * 58> const
+    alphabetPairs = []() {
+        std::array<std::array<char, 2>, 58 * 58> pairs{};
+        for (int i = 0; i < 58 * 58; ++i)
+            pairs[i] = {alphabetForward[i / 58], alphabetForward[i % 58]};
+        return pairs;
+    }();
 
 template <class Hasher>
 static typename Hasher::result_type
@@ -198,20 +203,20 @@ decodeBase58(std::string const& s)
 [[nodiscard]] std::string
 encodeBase58Token(TokenType type, void const* token, std::size_t size)
 {
-#ifndef _MSC_VER
-    return b58_fast::encodeBase58Token(type, token, size);
+#if defined(_MSC_VER) || defined(XRPL_B58_PORTABLE)
+    return b58_portable::encodeBase58Token(type, token, size);
 #else
-    return b58_ref::encodeBase58Token(type, token, size);
+    return b58_fast::encodeBase58Token(type, token, size);
 #endif
 }
 
 [[nodiscard]] std::string
 decodeBase58Token(std::string const& s, TokenType type)
 {
-#ifndef _MSC_VER
-    return b58_fast::decodeBase58Token(s, type);
+#if defined(_MSC_VER) || defined(XRPL_B58_PORTABLE)
+    return b58_portable::decodeBase58Token(s, type);
 #else
-    return b58_ref::decodeBase58Token_ms(s, type);
+    return b58_fast::decodeBase58Token(s, type);
 #endif
 }
 
@@ -264,125 +269,309 @@ decodeBase58Token(std::string const& s, TokenType type)
 }
 }  // namespace b58_ref
 
-#ifndef _MSC_VER
+#if !defined(_MSC_VER) && !defined(XRPL_B58_PORTABLE)
 namespace b58_fast {
 namespace detail {
-Result<std::span<std::uint8_t>>
-b256_to_b58(std::span<std::uint8_t const> input, std::span<std::uint8_t> out)
+
+// Write the ten alphabet characters of a base 58^10 coeff, largest digit
+// first. The coeff is split into base 58^5 halves and then into pairs of
+// digits, which are looked up two characters at a time; there is no serial
+// chain of ten divides.
+void
+b58_10_to_alphabet_be(std::uint64_t coeff, std::uint8_t* out)
 {
-    // Allocate enough base 58^10 coeff for encoding 38 bytes
-    // (33 bytes for nodepublic + 1 byte token + 4 bytes checksum)
-    // log(2^(38*8),58^10)) ~= 5.18. So 6 coeff are enough
-    if (input.size() > 38)
-    {
-        return boost::outcome_v2::failure(TokenCodecErrc::InputTooLarge);
+    constexpr std::uint64_t B_58_5 = 656356768;  // 58^5
+    assert(coeff < B_58_5 * B_58_5);
+    auto const write_58_5 = [](std::uint32_t v, std::uint8_t* o) {
+        constexpr std::uint32_t B_58_3 = 195112;  // 58^3
+        std::uint32_t const low = v % B_58_3;
+        std::memcpy(o, ::ripple::alphabetPairs[v / B_58_3].data(), 2);
+        std::memcpy(o + 2, ::ripple::alphabetPairs[low / 58].data(), 2);
+        o[4] = ::ripple::alphabetForward[low % 58];
     };
+    write_58_5(coeff / B_58_5, out);
+    write_58_5(coeff % B_58_5, out + 5);
+}
 
-    auto count_leading_zeros = [&](auto const& col) -> std::size_t {
-        std::size_t count = 0;
-        for (auto const& c : col)
+// Translate base 58^10 coeffs (smallest coeff first) into the alphabet.
+// Put `input_zeros` zeros at the beginning, then all the values from the coeffs
+Result<std::span<std::uint8_t>>
+b58_10_to_alphabet(
+    std::span<std::uint64_t const> base_58_10_coeff,
+    std::size_t input_zeros,
+    std::span<std::uint8_t> out)
+{
+    // Don't write leading zeros for the most significant coeffs
+    std::size_t num_coeffs = base_58_10_coeff.size();
+    while (num_coeffs > 0 && base_58_10_coeff[num_coeffs - 1] == 0)
+    {
+        num_coeffs -= 1;
+    }
+    if (num_coeffs == 0)
+    {
+        if (out.size() < input_zeros)
         {
-            if (c != 0)
-            {
-                return count;
-            }
-            count += 1;
+            return boost::outcome_v2::failure(TokenCodecErrc::OutputTooSmall);
         }
-        return count;
-    };
+        std::fill_n(out.begin(), input_zeros, ::ripple::alphabetForward[0]);
+        return boost::outcome_v2::success(out.subspan(0, input_zeros));
+    }
 
-    auto const input_zeros = count_leading_zeros(input);
-    input = input.subspan(input_zeros);
+    std::array<std::uint8_t, 10> top;
+    b58_10_to_alphabet_be(base_58_10_coeff[num_coeffs - 1], top.data());
+    std::size_t const top_digits = top.end() -
+        std::find_if(top.begin(), top.end(), [](std::uint8_t c) {
+            return c != ::ripple::alphabetForward[0];
+        });
 
-    std::array<std::uint64_t, 6> base_58_10_coeff{};
-    std::array<std::uint64_t, 5> base_2_64_coeff_buf{};
-    std::span<std::uint64_t> const base_2_64_coeff =
-        [&]() -> std::span<std::uint64_t> {
-        // convert from input from big endian to native u64, lowest coeff first
-        std::size_t num_coeff = 0;
-        for (int i = 0; i < 5; ++i)
-        {
-            if (i * 8 > input.size())
-            {
-                break;
-            }
-            auto const src_i_end = input.size() - i * 8;
-            if (src_i_end >= 8)
-            {
-                std::memcpy(
-                    &base_2_64_coeff_buf[num_coeff], &input[src_i_end - 8], 8);
-                boost::endian::big_to_native_inplace(
-                    base_2_64_coeff_buf[num_coeff]);
-            }
-            else
-            {
-                std::uint64_t be = 0;
-                for (int bi = 0; bi < src_i_end; ++bi)
-                {
-                    be <<= 8;
-                    be |= input[bi];
-                }
-                base_2_64_coeff_buf[num_coeff] = be;
-            };
-            num_coeff += 1;
-        }
-        return std::span(base_2_64_coeff_buf.data(), num_coeff);
-    }();
+    std::size_t const out_size =
+        input_zeros + top_digits + (num_coeffs - 1) * 10;
+    if (out.size() < out_size)
+    {
+        return boost::outcome_v2::failure(TokenCodecErrc::OutputTooSmall);
+    }
+    auto out_i = std::fill_n(
+        out.begin(), input_zeros, ::ripple::alphabetForward[0]);
+    out_i = std::copy(top.end() - top_digits, top.end(), out_i);
+    for (std::size_t i = num_coeffs - 1; i-- > 0;)
+    {
+        b58_10_to_alphabet_be(base_58_10_coeff[i], &*out_i);
+        out_i += 10;
+    }
+
+    return boost::outcome_v2::success(out.subspan(0, out_size));
+}
+
+// Number of base 58^10 coeffs needed to hold a value with `num_limbs` base
+// 2^64 coeffs: ceil(num_limbs * log(2^64, 58^10))
+constexpr std::size_t
+b58_10_coeffs_for_limbs(std::size_t num_limbs)
+{
+    constexpr std::array<std::size_t, 6> table{0, 2, 3, 4, 5, 6};
+    return table[num_limbs];
+}
+
+// Number of base 2^64 coeffs needed to hold an expanded token
+// (type + payload + checksum) of `size` bytes
+constexpr std::size_t
+b256_limbs_for_size(std::size_t size)
+{
+    return (size + 7) / 8;
+}
+
+// Lay out a group of at most `kernelLanes` tokens, each as
+//      <type (1 byte)><token (input len)><checksum (4 bytes)>
+// with their checksums hashed together. Each `bufs[i]` is shrunk to its
+// token.
+static void
+expand_tokens(
+    TokenType token_type,
+    std::span<std::span<std::uint8_t const> const> inputs,
+    std::span<std::span<std::uint8_t>> bufs)
+{
+    assert(inputs.size() <= kernelLanes);
+    std::array<std::span<std::uint8_t const>, kernelLanes> messages;
+    std::array<std::array<std::uint8_t, 4>, kernelLanes> sums;
+    for (std::size_t i = 0; i < inputs.size(); ++i)
+    {
+        auto const buf = bufs[i];
+        assert(buf.size() >= inputs[i].size() + 5);
+        buf[0] = static_cast<std::uint8_t>(token_type);
+        memcpy(&buf[1], inputs[i].data(), inputs[i].size());
+        messages[i] = buf.subspan(0, inputs[i].size() + 1);
+    }
+    checksumBatch(
+        std::span(sums.data(), inputs.size()),
+        std::span(messages.data(), inputs.size()));
+    for (std::size_t i = 0; i < inputs.size(); ++i)
+    {
+        memcpy(&bufs[i][inputs[i].size() + 1], sums[i].data(), 4);
+        bufs[i] = bufs[i].subspan(0, inputs[i].size() + 5);
+    }
+}
+
+// Number of base 58^10 coeffs needed to hold a value of `size` bytes:
+// ceil(size * 8 / log(58^10, 2))
+constexpr std::size_t
+b58_10_coeffs_for_size(std::size_t size)
+{
+    // log(58^10, 2) ~= 58.5798
+    return (size * 8 * 10000 + 585797) / 585798;
+}
+
+// Number of base 2^64 coeffs still needed by a value of `size` bytes after
+// `i` base 58^10 coeffs were divided out of it (58^10 > 2^58)
+constexpr std::size_t
+b256_limbs_after_58_10_coeffs(std::size_t size, std::size_t i)
+{
+    return size * 8 > i * 58 ? (size * 8 - i * 58 + 63) / 64 : 1;
+}
 
+// Divide the base 58^10 coeffs (smallest coeff first) out of a value of at
+// most `Size` bytes. The number of divides and the number of base 2^64 coeffs
+// each divide touches are fixed at compile time, so the conversion is fully
+// unrolled.
+template <std::size_t Size>
+static std::array<std::uint64_t, b58_10_coeffs_for_size(Size)>
+b256_to_b58_10(
+    ::b58_fast::detail::fixed_bigint<b256_limbs_for_size(Size)> value)
+{
     constexpr std::uint64_t B_58_10 = 430804206899405824;  // 58^10;
-    std::size_t num_58_10_coeffs = 0;
-    std::size_t cur_2_64_end = base_2_64_coeff.size();
-    // compute the base 58 10 coeffs
-    while (cur_2_64_end > 0)
+    std::array<std::uint64_t, b58_10_coeffs_for_size(Size)> base_58_10_coeff;
+    auto div_rem = [&]<std::size_t I>() {
+        constexpr std::size_t limbs = b256_limbs_after_58_10_coeffs(Size, I);
+        base_58_10_coeff[I] = value.template div_rem_by<B_58_10, limbs>();
+    };
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+        (div_rem.template operator()<I>(), ...);
+    }(std::make_index_sequence<base_58_10_coeff.size()>{});
+    return base_58_10_coeff;
+}
+
+// Convert base 58 digits (largest digit first) to base 2^64 coeffs (smallest
+// coeff first). There are at most `NumCoeffs * 10` digits; they are right
+// aligned, padded with zeros, so every base 58^10 coeff is exactly 10 digits.
+template <std::size_t NumCoeffs>
+static ::b58_fast::detail::fixed_bigint<
+    ::b58_fast::detail::b256_limbs_for_58_10_coeffs(NumCoeffs)>
+b58_digits_to_b256(std::span<std::uint8_t const> input_digits)
+{
+    assert(input_digits.size() <= NumCoeffs * 10);
+    std::array<std::uint8_t, NumCoeffs * 10> digits{};
+    std::copy(
+        input_digits.begin(),
+        input_digits.end(),
+        digits.end() - input_digits.size());
+    std::array<std::uint64_t, NumCoeffs> b_58_10_coeff{};
+    for (std::size_t i = 0; i < NumCoeffs; ++i)
     {
-        base_58_10_coeff[num_58_10_coeffs] =
-            ::b58_fast::detail::inplace_bigint_div_rem(
-                base_2_64_coeff.subspan(0, cur_2_64_end), B_58_10);
-        num_58_10_coeffs += 1;
-        if (base_2_64_coeff[cur_2_64_end - 1] == 0)
+        for (std::size_t j = 0; j < 10; ++j)
         {
-            cur_2_64_end -= 1;
+            b_58_10_coeff[i] = b_58_10_coeff[i] * 58 + digits[i * 10 + j];
         }
     }
+    std::span<std::uint64_t const, NumCoeffs> const coeffs(b_58_10_coeff);
+    // Summing the products with the powers of 58^10 overlaps the multiplies,
+    // but its column sums only fit in 128 bits for the token sizes
+    if constexpr (NumCoeffs <= ::b58_fast::detail::b58_10_powers.size())
+        return {::b58_fast::detail::b58_10_to_b256_powers(coeffs)};
+    else
+        return {::b58_fast::detail::b58_10_to_b256_horner(coeffs)};
+}
+
+// Encode an expanded token (type + payload + checksum) of exactly `Size`
+// bytes. Produces the same result as `b256_to_b58`, with the conversion fully
+// unrolled.
+template <std::size_t Size>
+Result<std::span<std::uint8_t>>
+b256_to_b58_fixed(
+    std::span<std::uint8_t const, Size> input,
+    std::span<std::uint8_t> out)
+{
+    using value_type =
+        ::b58_fast::detail::fixed_bigint<b256_limbs_for_size(Size)>;
+    std::size_t const input_zeros =
+        std::find_if(
+            input.begin(), input.end(), [](std::uint8_t c) { return c != 0; }) -
+        input.begin();
+    auto const base_58_10_coeff =
+        b256_to_b58_10<Size>(value_type::from_be_bytes(input));
+    return b58_10_to_alphabet(base_58_10_coeff, input_zeros, out);
+}
 
-    // Translate the result into the alphabet
-    // Put all the zeros at the beginning, then all the values from the output
-    std::fill(
-        out.begin(), out.begin() + input_zeros, ::ripple::alphabetForward[0]);
+// Decode into an expanded token (type + payload + checksum) of exactly `Size`
+// bytes. Produces the same result as `b58_to_b256` when that decodes to
+// `Size` bytes, and fails otherwise. The number of base 58^10 coeffs and the
+// number of base 2^64 coeffs each multiply touches are fixed at compile time.
+template <std::size_t Size>
+Result<std::span<std::uint8_t>>
+b58_to_b256_fixed(std::string_view input, std::span<std::uint8_t, Size> out)
+{
+    constexpr std::size_t max_digits =
+        ::b58_fast::detail::b58_digits_for_size(Size);
+    constexpr std::size_t num_58_10_coeffs = (max_digits + 9) / 10;
 
-    // iterate through the base 58^10 coeff
-    // convert to base 58 little endian then
-    // convert to alphabet big endian
-    bool skip_zeros = true;
-    auto out_index = input_zeros;
-    for (int i = num_58_10_coeffs - 1; i >= 0; --i)
+    if (input.size() > max_digits)
     {
-        if (skip_zeros && base_58_10_coeff[i] == 0)
-        {
-            continue;
-        }
-        auto const b58_be =
-            ::b58_fast::detail::b58_10_to_b58_be(base_58_10_coeff[i]);
-        std::size_t to_skip = 0;
-        std::span<std::uint8_t const> b58_be_s{b58_be.data(), b58_be.size()};
-        if (skip_zeros)
-        {
-            to_skip = count_leading_zeros(b58_be_s);
-            skip_zeros = false;
-            if (out.size() < (i + 1) * 10 - to_skip)
-            {
-                return boost::outcome_v2::failure(
-                    TokenCodecErrc::OutputTooSmall);
-            }
-        }
-        for (auto b58_coeff : b58_be_s.subspan(to_skip))
-        {
-            out[out_index] = ::ripple::alphabetForward[b58_coeff];
-            out_index += 1;
-        }
+        return boost::outcome_v2::failure(TokenCodecErrc::InputTooLarge);
+    }
+    // Every byte takes at least one digit: leading zero bytes are one zero
+    // digit each, and the m bytes of the value past them need more than
+    // (m - 1) * log(256) / log(58) digits.
+    if (input.size() < Size)
+    {
+        return boost::outcome_v2::failure(TokenCodecErrc::InputTooSmall);
+    }
+
+    std::array<std::uint8_t, 64> input_digits;
+    std::size_t input_zeros;
+    if (!b58_to_digits(input, input_digits, input_zeros))
+    {
+        return boost::outcome_v2::failure(TokenCodecErrc::InvalidEncodingChar);
+    }
+
+    auto const value = b58_digits_to_b256<num_58_10_coeffs>(
+        std::span(input_digits).first(input.size()));
+    std::array<std::uint8_t, value.num_limbs * 8> b256_be;
+    value.to_be_bytes(b256_be);
+
+    // `b58_to_b256` writes a zero byte for each leading zero digit, then the
+    // value without leading zero bytes (a zero value is a single zero byte)
+    std::size_t const value_zeros = std::min<std::size_t>(
+        std::find_if(
+            b256_be.begin(),
+            b256_be.end(),
+            [](std::uint8_t c) { return c != 0; }) -
+            b256_be.begin(),
+        b256_be.size() - 1);
+    std::size_t const decoded_size =
+        input_zeros + b256_be.size() - value_zeros;
+    if (decoded_size > Size)
+    {
+        return boost::outcome_v2::failure(TokenCodecErrc::InputTooLarge);
+    }
+    if (decoded_size < Size)
+    {
+        return boost::outcome_v2::failure(TokenCodecErrc::InputTooSmall);
+    }
+    std::copy(b256_be.end() - Size, b256_be.end(), out.begin());
+    return boost::outcome_v2::success(std::span<std::uint8_t>(out));
+}
+
+static_assert(
+    maxEncodedTokenChars ==
+    ::b58_fast::detail::b58_digits_for_size(maxExpandedTokenSize));
+
+// Encode an expanded token of any size up to `maxExpandedTokenSize`. The value
+// past the leading zero bytes is converted with the smallest fixed width that
+// holds it, so every size takes a fully unrolled conversion.
+Result<std::span<std::uint8_t>>
+b256_to_b58(std::span<std::uint8_t const> input, std::span<std::uint8_t> out)
+{
+    if (input.size() > maxExpandedTokenSize)
+    {
+        return boost::outcome_v2::failure(TokenCodecErrc::InputTooLarge);
+    };
+
+    std::size_t const input_zeros =
+        std::find_if(
+            input.begin(), input.end(), [](std::uint8_t c) { return c != 0; }) -
+        input.begin();
+    input = input.subspan(input_zeros);
+    if (input.empty())
+    {
+        return b58_10_to_alphabet({}, input_zeros, out);
     }
 
-    return boost::outcome_v2::success(out.subspan(0, out_index));
+    return ::b58_fast::detail::with_fixed_width<b256_limbs_for_size(
+        maxExpandedTokenSize)>(
+        b256_limbs_for_size(input.size()),
+        [&]<std::size_t NumLimbs>() -> Result<std::span<std::uint8_t>> {
+            using value_type = ::b58_fast::detail::fixed_bigint<NumLimbs>;
+            auto const base_58_10_coeff =
+                b256_to_b58_10<NumLimbs * 8>(value_type::from_be_bytes(input));
+            return b58_10_to_alphabet(base_58_10_coeff, input_zeros, out);
+        });
 }
 
 // Note the input is in BIG ENDIAN form (some fn in this module use little
@@ -390,11 +579,7 @@ b256_to_b58(std::span<std::uint8_t const> input, std::span<std::uint8_t> out)
 Result<std::span<std::uint8_t>>
 b58_to_b256(std::string_view input, std::span<std::uint8_t> out)
 {
-    // Convert from b58 to b 58^10
-
-    // Max encoded value is 38 bytes
-    // log(2^(38*8),58) ~= 51.9
-    if (input.size() > 52)
+    if (input.size() > maxEncodedTokenChars)
     {
         return boost::outcome_v2::failure(TokenCodecErrc::InputTooLarge);
     };
@@ -403,117 +588,371 @@ b58_to_b256(std::string_view input, std::span<std::uint8_t> out)
         return boost::outcome_v2::failure(TokenCodecErrc::OutputTooSmall);
     }
 
-    auto count_leading_zeros = [&](auto const& col) -> std::size_t {
-        std::size_t count = 0;
-        for (auto const& c : col)
+    // Translate and validate all the characters up front, 64 at a time, so
+    // the accumulation below is branch free
+    std::array<std::uint8_t, (maxEncodedTokenChars + 63) / 64 * 64> digits;
+    std::size_t input_zeros = 0;
+    for (std::size_t i = 0; i < input.size(); i += 64)
+    {
+        std::size_t chunk_zeros;
+        if (!b58_to_digits(
+                input.substr(i, 64),
+                std::span(digits).subspan(i).first<64>(),
+                chunk_zeros))
         {
-            if (c != ::ripple::alphabetForward[0])
+            return boost::outcome_v2::failure(
+                TokenCodecErrc::InvalidEncodingChar);
+        }
+        if (input_zeros == i)
+            input_zeros += chunk_zeros;
+    }
+
+    // Convert with the smallest number of base 58^10 coeffs that holds the
+    // digits. An empty string decodes to a single zero byte.
+    auto const num_58_10_coeffs =
+        std::max<std::size_t>((input.size() + 9) / 10, 1);
+    return ::b58_fast::detail::with_fixed_width<(maxEncodedTokenChars + 9) /
+                                                10>(
+        num_58_10_coeffs,
+        [&]<std::size_t NumCoeffs>() -> Result<std::span<std::uint8_t>> {
+            auto const value = b58_digits_to_b256<NumCoeffs>(
+                std::span(digits).first(input.size()));
+            std::array<std::uint8_t, value.num_limbs * 8> b256_be;
+            value.to_be_bytes(b256_be);
+
+            // Write a zero byte for each leading zero digit, then the value
+            // without leading zero bytes (a zero value is a single zero byte)
+            std::span<std::uint8_t const> b256_be_s(b256_be);
+            b256_be_s = b256_be_s.subspan(std::min<std::size_t>(
+                b256_be_s.size() - 1,
+                std::find_if(
+                    b256_be_s.begin(),
+                    b256_be_s.end(),
+                    [](std::uint8_t c) { return c != 0; }) -
+                    b256_be_s.begin()));
+            std::size_t const out_size = input_zeros + b256_be_s.size();
+            if (out.size() < out_size)
             {
-                return count;
+                return boost::outcome_v2::failure(
+                    TokenCodecErrc::OutputTooSmall);
             }
-            count += 1;
-        }
-        return count;
-    };
+            auto out_i = std::fill_n(out.begin(), input_zeros, 0);
+            std::copy(b256_be_s.begin(), b256_be_s.end(), out_i);
+            return boost::outcome_v2::success(out.subspan(0, out_size));
+        });
+}
 
-    auto const input_zeros = count_leading_zeros(input);
+template Result<std::span<std::uint8_t>>
+b256_to_b58_fixed<21>(
+    std::span<std::uint8_t const, 21>,
+    std::span<std::uint8_t>);
+template Result<std::span<std::uint8_t>>
+b256_to_b58_fixed<25>(
+    std::span<std::uint8_t const, 25>,
+    std::span<std::uint8_t>);
+template Result<std::span<std::uint8_t>>
+b256_to_b58_fixed<37>(
+    std::span<std::uint8_t const, 37>,
+    std::span<std::uint8_t>);
+template Result<std::span<std::uint8_t>>
+b256_to_b58_fixed<38>(
+    std::span<std::uint8_t const, 38>,
+    std::span<std::uint8_t>);
+template Result<std::span<std::uint8_t>>
+b58_to_b256_fixed<21>(std::string_view, std::span<std::uint8_t, 21>);
+template Result<std::span<std::uint8_t>>
+b58_to_b256_fixed<25>(std::string_view, std::span<std::uint8_t, 25>);
+template Result<std::span<std::uint8_t>>
+b58_to_b256_fixed<37>(std::string_view, std::span<std::uint8_t, 37>);
+template Result<std::span<std::uint8_t>>
+b58_to_b256_fixed<38>(std::string_view, std::span<std::uint8_t, 38>);
+
+static TokenCodecErrc
+to_errc(std::error_code const& ec)
+{
+    return static_cast<TokenCodecErrc>(ec.value());
+}
 
-    // Allocate enough base 58^10 coeff for encoding 38 bytes
-    // (33 bytes for nodepublic + 1 byte token + 4 bytes checksum)
-    // log(2^(38*8),58^10)) ~= 5.18. So 6 coeff are enough
-    std::array<std::uint64_t, 6> b_58_10_coeff{};
-    auto [num_full_coeffs, partial_coeff_len] =
-        ::b58_fast::detail::div_rem(input.size(), 10);
-    auto const num_partial_coeffs = partial_coeff_len ? 1 : 0;
-    auto const num_b_58_10_coeffs = num_full_coeffs + num_partial_coeffs;
-    assert(num_b_58_10_coeffs <= b_58_10_coeff.size());
-    for (auto c : input.substr(0, partial_coeff_len))
+void
+b256_to_b58_kernel(
+    CodecKernel kernel,
+    std::span<std::span<std::uint8_t const> const> in,
+    std::span<std::span<std::uint8_t>> out,
+    std::span<TokenCodecErrc> status)
+{
+    assert(in.size() <= kernelLanes);
+    auto const div_rem_lanes = divRemLanes(kernel);
+    if (!div_rem_lanes)
     {
-        auto cur_val = ::ripple::alphabetReverse[c];
-        if (cur_val < 0)
+        for (std::size_t lane = 0; lane < in.size(); ++lane)
         {
-            return boost::outcome_v2::failure(
-                TokenCodecErrc::InvalidEncodingChar);
+            auto const r = b256_to_b58(in[lane], out[lane]);
+            status[lane] = r ? TokenCodecErrc::Success : to_errc(r.error());
+            if (r)
+                out[lane] = r.value();
         }
-        b_58_10_coeff[0] *= 58;
-        b_58_10_coeff[0] += cur_val;
+        return;
     }
-    for (int i = 0; i < 10; ++i)
+
+    // The vector kernels work in doubles, so use base 2^16 coeffs: the
+    // intermediate `rem * 2^16 + coeff` of a divide by 58^5 is less than 2^46
+    // and exactly representable.
+    // 38 bytes (33 bytes for nodepublic + 1 byte token + 4 bytes checksum)
+    // need 19 base 2^16 coeffs and ceil(log(2^(38*8), 58^5)) = 11 base 58^5
+    // coeffs
+    constexpr std::size_t max_size = 38;
+    std::array<DoubleLanes, (max_size + 1) / 2> base_2_16_coeff;
+    std::array<std::size_t, kernelLanes> input_zeros{};
+    std::size_t size = 0;
+    for (std::size_t lane = 0; lane < kernelLanes; ++lane)
     {
-        for (int j = 0; j < num_full_coeffs; ++j)
+        // right align the input so the unused high bytes are zero
+        std::array<std::uint8_t, base_2_16_coeff.size() * 2> buf{};
+        if (lane < in.size())
         {
-            auto c = input[partial_coeff_len + j * 10 + i];
-            auto cur_val = ::ripple::alphabetReverse[c];
-            if (cur_val < 0)
+            auto const input = in[lane];
+            if (input.size() > max_size)
             {
-                return boost::outcome_v2::failure(
-                    TokenCodecErrc::InvalidEncodingChar);
+                status[lane] = TokenCodecErrc::InputTooLarge;
             }
-            b_58_10_coeff[num_partial_coeffs + j] *= 58;
-            b_58_10_coeff[num_partial_coeffs + j] += cur_val;
+            else
+            {
+                status[lane] = TokenCodecErrc::Success;
+                input_zeros[lane] = std::find_if(
+                                        input.begin(),
+                                        input.end(),
+                                        [](std::uint8_t c) { return c != 0; }) -
+                    input.begin();
+                std::copy(input.begin(), input.end(), buf.end() - input.size());
+                size = std::max(size, input.size());
+            }
+        }
+        // convert from big endian bytes, lowest coeff first
+        for (std::size_t i = 0; i < base_2_16_coeff.size(); ++i)
+        {
+            auto const hi = buf[buf.size() - 2 * i - 2];
+            auto const lo = buf[buf.size() - 2 * i - 1];
+            base_2_16_coeff[i][lane] = (hi << 8) | lo;
         }
     }
 
-    constexpr std::uint64_t B_58_10 = 430804206899405824;  // 58^10;
+    constexpr double B_58_5 = 656356768;  // 58^5
+    std::size_t const num_bits = size * 8;
+    // 58^5 > 2^29, so each divide removes more than 29 bits
+    std::size_t const num_58_5_coeffs = (num_bits + 28) / 29;
+    constexpr std::size_t max_58_5_coeffs = (max_size * 8 + 28) / 29;
+    // base 58 digits, smallest first
+    std::array<DoubleLanes, max_58_5_coeffs * 5> base_58_coeff;
+    for (std::size_t i = 0; i < num_58_5_coeffs; ++i)
+    {
+        // The quotient coeffs may be negative (see DivRemLanesFn), so a
+        // value less than 2^bits_left may need one more coeff than usual
+        std::size_t const bits_left = num_bits - std::min(num_bits, 29 * i);
+        std::size_t const cur_2_16_end =
+            std::min(base_2_16_coeff.size(), bits_left / 16 + 1);
+        std::array<DoubleLanes, 1> base_58_5_coeff;
+        div_rem_lanes(
+            std::span(base_2_16_coeff.data(), cur_2_16_end),
+            65536.0,
+            B_58_5,
+            base_58_5_coeff[0]);
+
+        // convert to base 58
+        for (std::size_t j = 0; j < 5; ++j)
+        {
+            div_rem_lanes(base_58_5_coeff, 0.0, 58.0, base_58_coeff[i * 5 + j]);
+        }
+    }
+
+    for (std::size_t lane = 0; lane < in.size(); ++lane)
+    {
+        if (status[lane] != TokenCodecErrc::Success)
+            continue;
+        // skip the leading zero digits
+        std::size_t num_digits = num_58_5_coeffs * 5;
+        while (num_digits > 0 && base_58_coeff[num_digits - 1][lane] == 0)
+        {
+            num_digits -= 1;
+        }
+
+        auto& o = out[lane];
+        if (o.size() < input_zeros[lane] + num_digits)
+        {
+            status[lane] = TokenCodecErrc::OutputTooSmall;
+            continue;
+        }
+        auto out_i = std::fill_n(
+            o.begin(), input_zeros[lane], ::ripple::alphabetForward[0]);
+        for (std::size_t i = num_digits; i-- > 0;)
+        {
+            *out_i++ = ::ripple::alphabetForward[static_cast<std::size_t>(
+                base_58_coeff[i][lane])];
+        }
+        o = o.subspan(0, out_i - o.begin());
+    }
+
+    // Tokens too large for the vector conversion take the scalar one
+    for (std::size_t lane = 0; lane < in.size(); ++lane)
+    {
+        if (in[lane].size() <= max_size)
+            continue;
+        auto const r = b256_to_b58(in[lane], out[lane]);
+        status[lane] = r ? TokenCodecErrc::Success : to_errc(r.error());
+        if (r)
+            out[lane] = r.value();
+    }
+}
 
-    // log(2^(38*8),2^64) ~= 4.75)
-    std::array<std::uint64_t, 5> result{};
-    result[0] = b_58_10_coeff[0];
-    std::size_t cur_result_size = 1;
-    for (int i = 1; i < num_b_58_10_coeffs; ++i)
+void
+b58_to_b256_kernel(
+    CodecKernel kernel,
+    std::span<std::string_view const> in,
+    std::span<std::span<std::uint8_t>> out,
+    std::span<TokenCodecErrc> status)
+{
+    assert(in.size() <= kernelLanes);
+    auto const mul_add_lanes = mulAddLanes(kernel);
+    if (!mul_add_lanes)
     {
-        auto c = b_58_10_coeff[i];
-        ::b58_fast::detail::inplace_bigint_mul(
-            std::span(&result[0], cur_result_size + 1), B_58_10);
-        ::b58_fast::detail::inplace_bigint_add(
-            std::span(&result[0], cur_result_size + 1), c);
-        if (result[cur_result_size] != 0)
+        for (std::size_t lane = 0; lane < in.size(); ++lane)
         {
-            cur_result_size += 1;
+            auto const r = b58_to_b256(in[lane], out[lane]);
+            status[lane] = r ? TokenCodecErrc::Success : to_errc(r.error());
+            if (r)
+                out[lane] = r.value();
         }
+        return;
     }
-    std::fill(out.begin(), out.begin() + input_zeros, 0);
-    auto cur_out_i = input_zeros;
-    // Don't write leading zeros to the output for the most significant
-    // coeff
+
+    // The vector conversion takes values of at most 38 bytes: 52 base 58
+    // digits (longer strings are converted at the end, one at a time). Right
+    // align the digits of every lane in 11 base 58^5 coeffs (largest coeffs
+    // first); the leading zero digits don't change the value.
+    constexpr std::size_t max_digits = 52;
+    constexpr std::size_t num_58_5_coeffs = (max_digits + 4) / 5;
+    constexpr std::size_t padded_digits = num_58_5_coeffs * 5;
+    std::array<U64Lanes, num_58_5_coeffs> base_58_5_coeff;
+    std::array<std::size_t, kernelLanes> input_zeros{};
+    std::size_t num_digits = 0;
+    for (std::size_t lane = 0; lane < kernelLanes; ++lane)
     {
-        std::uint64_t const c = result[cur_result_size - 1];
-        auto skip_zero = true;
-        // start and end of output range
-        for (int i = 0; i < 8; ++i)
+        // right align the input, padding with the zero digit
+        std::array<char, padded_digits> buf;
+        buf.fill(::ripple::alphabetForward[0]);
+        if (lane < in.size())
         {
-            std::uint8_t const b = (c >> (8 * (7 - i))) & 0xff;
-            if (i == 7)
+            auto const input = in[lane];
+            if (input.size() > max_digits)
+            {
+                status[lane] = TokenCodecErrc::InputTooLarge;
+            }
+            else if (out[lane].size() < 8)
+            {
+                status[lane] = TokenCodecErrc::OutputTooSmall;
+            }
+            else
             {
-                // handle the all zero case - write the last zero
-                skip_zero = false;
+                status[lane] = TokenCodecErrc::Success;
+                input_zeros[lane] =
+                    std::find_if(
+                        input.begin(),
+                        input.end(),
+                        [](char c) {
+                            return c != ::ripple::alphabetForward[0];
+                        }) -
+                    input.begin();
+                std::copy(input.begin(), input.end(), buf.end() - input.size());
             }
-            if (skip_zero)
+        }
+        // Invalid characters map to -1; or all the values together so they
+        // are checked once, with no branch per character.
+        int invalid = 0;
+        for (std::size_t i = 0; i < num_58_5_coeffs; ++i)
+        {
+            std::uint64_t c = 0;
+            for (std::size_t j = 0; j < 5; ++j)
             {
-                if (b == 0)
-                {
-                    continue;
-                }
-                skip_zero = false;
+                auto const cur_val = ::ripple::alphabetReverse
+                    [static_cast<unsigned char>(buf[i * 5 + j])];
+                invalid |= cur_val;
+                c = c * 58 + cur_val;
             }
-            out[cur_out_i] = b;
-            cur_out_i += 1;
+            base_58_5_coeff[i][lane] = c;
         }
+        if (lane < in.size() && invalid < 0 &&
+            status[lane] == TokenCodecErrc::Success)
+        {
+            status[lane] = TokenCodecErrc::InvalidEncodingChar;
+        }
+        if (lane >= in.size() || status[lane] != TokenCodecErrc::Success)
+        {
+            for (auto& c : base_58_5_coeff)
+                c[lane] = 0;
+            continue;
+        }
+        num_digits = std::max(num_digits, in[lane].size());
     }
-    if ((cur_out_i + 8 * (cur_result_size - 1)) > out.size())
+
+    // Convert to base 2^32: result = result * 58^5 + coeff, smallest coeff
+    // first. 58^5 < 2^30, so after k coeffs the value fits in 30 * k bits.
+    // log(2^(38*8),2^32) ~= 9.5
+    constexpr std::uint64_t B_58_5 = 656356768;  // 58^5
+    std::array<U64Lanes, 10> result{};
+    std::size_t const first_coeff = (padded_digits - num_digits) / 5;
+    for (std::size_t i = first_coeff; i < num_58_5_coeffs; ++i)
     {
-        return boost::outcome_v2::failure(TokenCodecErrc::OutputTooSmall);
+        std::size_t const num_bits = 30 * (i - first_coeff + 1);
+        std::size_t const cur_result_size =
+            std::min(result.size(), (num_bits + 31) / 32);
+        mul_add_lanes(
+            std::span(result.data(), cur_result_size),
+            B_58_5,
+            base_58_5_coeff[i]);
     }
 
-    for (int i = cur_result_size - 2; i >= 0; --i)
+    for (std::size_t lane = 0; lane < in.size(); ++lane)
     {
-        auto c = result[i];
-        boost::endian::native_to_big_inplace(c);
-        memcpy(&out[cur_out_i], &c, 8);
-        cur_out_i += 8;
+        if (status[lane] != TokenCodecErrc::Success)
+            continue;
+        // convert to big endian bytes
+        std::array<std::uint8_t, result.size() * 4> b256_be;
+        for (std::size_t i = 0; i < result.size(); ++i)
+        {
+            auto c = static_cast<std::uint32_t>(result[i][lane]);
+            boost::endian::native_to_big_inplace(c);
+            memcpy(&b256_be[b256_be.size() - (i + 1) * 4], &c, 4);
+        }
+        std::span<std::uint8_t const> b256_be_s(b256_be);
+        // Don't write leading zeros, but write a single zero for a zero value
+        b256_be_s = b256_be_s.subspan(std::min<std::size_t>(
+            b256_be_s.size() - 1,
+            std::find_if(
+                b256_be_s.begin(),
+                b256_be_s.end(),
+                [](std::uint8_t c) { return c != 0; }) -
+                b256_be_s.begin()));
+
+        auto& o = out[lane];
+        if (o.size() < input_zeros[lane] + b256_be_s.size())
+        {
+            status[lane] = TokenCodecErrc::OutputTooSmall;
+            continue;
+        }
+        auto out_i = std::fill_n(o.begin(), input_zeros[lane], 0);
+        out_i = std::copy(b256_be_s.begin(), b256_be_s.end(), out_i);
+        o = o.subspan(0, out_i - o.begin());
     }
 
-    return boost::outcome_v2::success(out.subspan(0, cur_out_i));
+    // Strings too long for the vector conversion take the scalar one
+    for (std::size_t lane = 0; lane < in.size(); ++lane)
+    {
+        if (in[lane].size() <= max_digits)
+            continue;
+        auto const r = b58_to_b256(in[lane], out[lane]);
+        status[lane] = r ? TokenCodecErrc::Success : to_errc(r.error());
+        if (r)
+            out[lane] = r.value();
+    }
 }
 }  // namespace detail
 
@@ -523,7 +962,26 @@ encodeBase58Token(
     std::span<std::uint8_t const> input,
     std::span<std::uint8_t> out)
 {
-    constexpr std::size_t tmpBufSize = 128;
+    // The token sizes used by the XRPL take the fully unrolled path
+    switch (input.size())
+    {
+        case 16:
+            return detail::encode_token_fixed<fast_sha256_hasher>(
+                token_type, input.first<16>(), out);
+        case 20:
+            return detail::encode_token_fixed<fast_sha256_hasher>(
+                token_type, input.first<20>(), out);
+        case 32:
+            return detail::encode_token_fixed<fast_sha256_hasher>(
+                token_type, input.first<32>(), out);
+        case 33:
+            return detail::encode_token_fixed<fast_sha256_hasher>(
+                token_type, input.first<33>(), out);
+        default:
+            break;
+    }
+
+    constexpr std::size_t tmpBufSize = detail::maxExpandedTokenSize;
     std::array<std::uint8_t, tmpBufSize> buf;
     if (input.size() > tmpBufSize - 5)
     {
@@ -539,87 +997,1269 @@ encodeBase58Token(
     memcpy(&buf[1], input.data(), input.size());
     size_t const checksum_i = input.size() + 1;
     // buf[checksum_i..checksum_i + 4] = checksum
-    checksum(buf.data() + checksum_i, buf.data(), checksum_i);
+    tokenChecksum<fast_sha256_hasher>(
+        buf.data() + checksum_i, buf.data(), checksum_i);
     std::span<std::uint8_t const> b58Span(buf.data(), input.size() + 5);
     return detail::b256_to_b58(b58Span, out);
 }
-// Convert from base 58 to base 256, largest coefficients first
-// The input is encoded in XPRL format, with the token in the first
-// byte and the checksum in the last four bytes.
-// The decoded base 256 value does not include the token type or checksum.
-// It is an error if the token type or checksum does not match.
-Result<std::span<std::uint8_t>>
-decodeBase58Token(
-    TokenType type,
-    std::string_view s,
-    std::span<std::uint8_t> outBuf)
-{
-    std::array<std::uint8_t, 64> tmpBuf;
-    auto const decodeResult =
-        detail::b58_to_b256(s, std::span(tmpBuf.data(), tmpBuf.size()));
 
-    if (!decodeResult)
-        return decodeResult;
+namespace detail {
 
-    auto const ret = decodeResult.value();
+// An expanded token as base 2^64 coeffs, smallest coeff first
+using PrefixLimbs = std::array<std::uint64_t, 5>;
 
-    // Reject zero length tokens
-    if (ret.size() < 6)
-        return boost::outcome_v2::failure(TokenCodecErrc::InputTooSmall);
+// a -= b + borrow, modulo 2^320. Returns the borrow out: 1 if a was less
+// than b + borrow. There are no branches, so the result can be used as a
+// mask.
+static std::uint64_t
+sub_limbs(PrefixLimbs& a, PrefixLimbs const& b, std::uint64_t borrow = 0)
+{
+    for (std::size_t i = 0; i < a.size(); ++i)
+    {
+        auto const d = static_cast<unsigned __int128>(a[i]) - b[i] - borrow;
+        a[i] = static_cast<std::uint64_t>(d);
+        borrow = static_cast<std::uint64_t>(d >> 64) & 1;
+    }
+    return borrow;
+}
 
-    // The type must match.
-    if (type != static_cast<TokenType>(static_cast<std::uint8_t>(ret[0])))
-        return boost::outcome_v2::failure(TokenCodecErrc::MismatchedTokenType);
+// a += b & mask, modulo 2^320
+static void
+add_limbs_masked(PrefixLimbs& a, PrefixLimbs const& b, std::uint64_t mask)
+{
+    std::uint64_t carry = 0;
+    for (std::size_t i = 0; i < a.size(); ++i)
+    {
+        auto const sum =
+            static_cast<unsigned __int128>(a[i]) + (b[i] & mask) + carry;
+        a[i] = static_cast<std::uint64_t>(sum);
+        carry = static_cast<std::uint64_t>(sum >> 64);
+    }
+}
 
-    // And the checksum must as well.
-    std::array<std::uint8_t, 4> guard;
-    checksum(guard.data(), ret.data(), ret.size() - guard.size());
-    if (!std::equal(guard.rbegin(), guard.rend(), ret.rbegin()))
+static std::size_t
+bit_width_limbs(PrefixLimbs const& a)
+{
+    for (std::size_t i = a.size(); i-- > 0;)
     {
-        return boost::outcome_v2::failure(TokenCodecErrc::MismatchedChecksum);
+        if (a[i])
+            return i * 64 + std::bit_width(a[i]);
     }
+    return 0;
+}
 
-    std::size_t const outSize = ret.size() - 1 - guard.size();
-    if (outBuf.size() < outSize)
-        return boost::outcome_v2::failure(TokenCodecErrc::OutputTooSmall);
-    // Skip the leading type byte and the trailing checksum.
-    std::copy(ret.begin() + 1, ret.begin() + outSize + 1, outBuf.begin());
-    return boost::outcome_v2::success(outBuf.subspan(0, outSize));
+// Bits [shift, shift + 128) of `a`
+static unsigned __int128
+bits_at(PrefixLimbs const& a, std::size_t shift)
+{
+    auto limb = [&](std::size_t i) -> std::uint64_t {
+        return i < a.size() ? a[i] : 0;
+    };
+    std::size_t const i = shift / 64;
+    std::size_t const s = shift % 64;
+    auto word = [&](std::size_t j) -> std::uint64_t {
+        return s ? limb(j) >> s | limb(j + 1) << (64 - s) : limb(j);
+    };
+    return static_cast<unsigned __int128>(word(i + 1)) << 64 | word(i);
 }
 
-[[nodiscard]] std::string
-encodeBase58Token(TokenType type, void const* token, std::size_t size)
+// The leading base 58 digits of a value
+struct LeadingDigits
 {
-    std::string sr;
-    // The largest object encoded as base58 is 33 bytes; This will be encoded in
-    // at most ceil(log(2^256,58)) bytes, or 46 bytes. 64 is plenty (and there's
-    // not real benefit making it smaller)
-    sr.resize(128);
-    std::span<std::uint8_t> outSp(
-        reinterpret_cast<std::uint8_t*>(sr.data()), sr.size());
-    std::span<std::uint8_t const> inSp(
-        reinterpret_cast<std::uint8_t const*>(token), size);
-    auto r = b58_fast::encodeBase58Token(type, inSp, outSp);
-    if (!r)
-        return {};
-    sr.resize(r.value().size());
-    return sr;
+    // The first `count` digits, as a number
+    std::uint64_t value = 0;
+    std::size_t count = 0;
+    // The most that can be added to the value without changing its first
+    // `count` digits (nor its number of digits), saturated at 2^64 - 1
+    std::uint64_t headroom = 0;
+};
+
+// The first `max_digits` (at most 10) base 58 digits of the non-zero value
+// `n`. They are floor(n / 58^e), where e is the number of the other digits.
+static LeadingDigits
+leading_b58_digits(PrefixLimbs const& n, std::size_t max_digits)
+{
+    assert(max_digits > 0 && max_digits <= 10);
+    auto const& powers = ::b58_fast::detail::b58_powers;
+    // 2^(bits - 1) has floor((bits - 1) * log(2, 58)) + 1 digits; `n` has
+    // that many or one more (log(58, 2) ~= 5.857981 is rounded up here). The
+    // corrections below are branch free: which way they go is random.
+    std::size_t const bits = bit_width_limbs(n);
+    assert(bits > 0);
+    std::size_t total = (bits - 1) * 1000000 / 5857981 + 1;
+    PrefixLimbs scratch = n;
+    total += 1 - sub_limbs(scratch, powers[total]);
+
+    LeadingDigits result;
+    result.count = std::min(max_digits, total);
+    auto const& d = powers[total - result.count];
+
+    // Estimate the quotient from the top 128 bits of `n` and the top 64 bits
+    // of `d`. The quotient is less than 2^59, so the estimate is off by at
+    // most one; fix it up with the exact remainder.
+    std::size_t const d_bits = bit_width_limbs(d);
+    std::size_t const shift = d_bits > 64 ? d_bits - 64 : 0;
+    auto const n_top = bits_at(n, shift);
+    auto const d_top = static_cast<std::uint64_t>(bits_at(d, shift));
+    std::uint64_t q = std::get<0>(::b58_fast::detail::div_rem_64(
+        static_cast<std::uint64_t>(n_top >> 64),
+        static_cast<std::uint64_t>(n_top),
+        d_top));
+
+    PrefixLimbs product = d;
+    [[maybe_unused]] auto const carry =
+        ::b58_fast::detail::inplace_bigint_mul_add(std::span(product), q, 0);
+    assert(carry == 0);
+    PrefixLimbs rem = n;
+    std::uint64_t const too_large = sub_limbs(rem, product);
+    add_limbs_masked(rem, d, -too_large);
+    q -= too_large;
+    scratch = rem;
+    std::uint64_t const too_small = 1 - sub_limbs(scratch, d);
+    rem = too_small ? scratch : rem;
+    q += too_small;
+    result.value = q;
+
+    // headroom = d - rem - 1
+    PrefixLimbs room = d;
+    sub_limbs(room, rem, 1);
+    result.headroom = room[1] | room[2] | room[3] | room[4]
+        ? ~std::uint64_t{0}
+        : room[0];
+    return result;
 }
 
-[[nodiscard]] std::string
-decodeBase58Token(std::string const& s, TokenType type)
+// An expanded token (type + payload + checksum) as base 2^64 coeffs, whose
+// checksum is only computed when it is needed. The coeffs are loaded straight
+// from the payload, with no byte copies in between.
+class LazyExpandedToken
 {
-    std::string sr;
-    // The largest object encoded as base58 is 33 bytes; 64 is plenty (and
-    // there's no benefit making it smaller)
-    sr.resize(64);
-    std::span<std::uint8_t> outSp(
-        reinterpret_cast<std::uint8_t*>(sr.data()), sr.size());
-    auto r = b58_fast::decodeBase58Token(type, s, outSp);
-    if (!r)
-        return {};
-    sr.resize(r.value().size());
-    return sr;
+public:
+    LazyExpandedToken(TokenType type, std::span<std::uint8_t const> input)
+        : type_(type), input_(input)
+    {
+        assert(!input.empty() && input.size() <= 33);
+        std::size_t const n = input.size();
+        PrefixLimbs payload{};
+        std::size_t i = 0;
+        for (; (i + 1) * 8 <= n; ++i)
+        {
+            std::uint64_t be;
+            std::memcpy(&be, &input[n - (i + 1) * 8], 8);
+            payload[i] = boost::endian::big_to_native(be);
+        }
+        // The bytes left over, below the type byte
+        std::uint64_t top = static_cast<std::uint8_t>(type);
+        for (std::size_t j = 0; j < n - i * 8; ++j)
+            top = top << 8 | input[j];
+        payload[i] = top;
+        // Make room for the checksum, which is zero until it is added
+        for (std::size_t j = limbs_.size(); j-- > 0;)
+            limbs_[j] = payload[j] << 32 | (j ? payload[j - 1] >> 32 : 0);
+        // The number of leading zero bytes depends on the checksum only if
+        // every other byte is zero
+        if (bit_width_limbs(limbs_) == 0)
+            addChecksum();
+    }
+
+    void
+    addChecksum()
+    {
+        std::array<std::uint8_t, 34> message;
+        message[0] = static_cast<std::uint8_t>(type_);
+        std::memcpy(&message[1], input_.data(), input_.size());
+        std::uint32_t be;
+        tokenChecksum<fast_sha256_hasher>(
+            &be, message.data(), input_.size() + 1);
+        limbs_[0] |= boost::endian::big_to_native(be);
+        hasChecksum_ = true;
+    }
+
+    [[nodiscard]] PrefixLimbs const&
+    limbs() const
+    {
+        return limbs_;
+    }
+
+    [[nodiscard]] std::size_t
+    leadingZeros() const
+    {
+        return input_.size() + 5 - (bit_width_limbs(limbs_) + 7) / 8;
+    }
+
+    // The checksum is the low 32 bits; adding it changes nothing if there
+    // is that much headroom
+    [[nodiscard]] bool
+    checksumCanChange(LeadingDigits const& digits) const
+    {
+        return !hasChecksum_ && digits.headroom < 0xffffffff;
+    }
+
+private:
+    TokenType const type_;
+    std::span<std::uint8_t const> const input_;
+    PrefixLimbs limbs_;
+    bool hasChecksum_ = false;
+};
+
+}  // namespace detail
+
+Result<std::span<std::uint8_t>>
+encodeBase58TokenPrefix(
+    TokenType token_type,
+    std::span<std::uint8_t const> input,
+    std::size_t k,
+    std::span<std::uint8_t> out)
+{
+    if (input.size() > 33)
+        return boost::outcome_v2::failure(TokenCodecErrc::InputTooLarge);
+    if (input.size() == 0)
+        return boost::outcome_v2::failure(TokenCodecErrc::InputTooSmall);
+
+    detail::LazyExpandedToken token(token_type, input);
+    for (;;)
+    {
+        std::size_t const zeros = token.leadingZeros();
+        if (zeros >= k)
+        {
+            if (out.size() < k)
+                return boost::outcome_v2::failure(
+                    TokenCodecErrc::OutputTooSmall);
+            std::fill_n(out.begin(), k, alphabetForward[0]);
+            return boost::outcome_v2::success(out.first(k));
+        }
+
+        if (k - zeros > 10)
+        {
+            // More than one base 58^10 coeff: encode all of it
+            std::array<std::uint8_t, 64> full;
+            auto const r = encodeBase58Token(token_type, input, full);
+            if (!r)
+                return r;
+            std::size_t const size = std::min(k, r.value().size());
+            if (out.size() < size)
+                return boost::outcome_v2::failure(
+                    TokenCodecErrc::OutputTooSmall);
+            std::copy_n(full.begin(), size, out.begin());
+            return boost::outcome_v2::success(out.first(size));
+        }
+
+        auto const digits =
+            detail::leading_b58_digits(token.limbs(), k - zeros);
+        if (token.checksumCanChange(digits))
+        {
+            token.addChecksum();
+            continue;
+        }
+
+        std::size_t const size = zeros + digits.count;
+        if (out.size() < size)
+            return boost::outcome_v2::failure(TokenCodecErrc::OutputTooSmall);
+        std::array<std::uint8_t, 10> chars;
+        detail::b58_10_to_alphabet_be(digits.value, chars.data());
+        auto const out_i = std::fill_n(out.begin(), zeros, alphabetForward[0]);
+        std::copy(chars.end() - digits.count, chars.end(), out_i);
+        return boost::outcome_v2::success(out.first(size));
+    }
+}
+
+Result<bool>
+base58TokenStartsWith(
+    TokenType token_type,
+    std::span<std::uint8_t const> input,
+    std::string_view prefix)
+{
+    if (input.size() > 33)
+        return boost::outcome_v2::failure(TokenCodecErrc::InputTooLarge);
+    if (input.size() == 0)
+        return boost::outcome_v2::failure(TokenCodecErrc::InputTooSmall);
+
+    detail::LazyExpandedToken token(token_type, input);
+    for (;;)
+    {
+        // Leading zero bytes are zero digits; the digit after them isn't
+        std::size_t const zeros = token.leadingZeros();
+        std::size_t const num_zeros = std::min(zeros, prefix.size());
+        if (prefix.find_first_not_of(alphabetForward[0]) < num_zeros)
+            return false;
+        if (prefix.size() <= zeros)
+            return true;
+        auto const rest = prefix.substr(zeros);
+        if (rest[0] == alphabetForward[0])
+            return false;
+
+        if (rest.size() > 10)
+        {
+            std::array<std::uint8_t, 64> full;
+            auto const r = encodeBase58TokenPrefix(
+                token_type, input, prefix.size(), full);
+            if (!r)
+                return boost::outcome_v2::failure(r.error());
+            return std::string_view(
+                       reinterpret_cast<char const*>(r.value().data()),
+                       r.value().size()) == prefix;
+        }
+
+        std::uint64_t expected = 0;
+        for (auto c : rest)
+        {
+            int const digit = alphabetReverse[static_cast<unsigned char>(c)];
+            if (digit < 0)
+                return false;
+            expected = expected * 58 + digit;
+        }
+
+        auto const digits =
+            detail::leading_b58_digits(token.limbs(), rest.size());
+        if (token.checksumCanChange(digits))
+        {
+            token.addChecksum();
+            continue;
+        }
+        return digits.count == rest.size() && digits.value == expected;
+    }
+}
+
+namespace detail {
+
+// Whether a < b
+static bool
+less_limbs(PrefixLimbs const& a, PrefixLimbs const& b)
+{
+    PrefixLimbs scratch = a;
+    return sub_limbs(scratch, b);
+}
+
+// v * 2^bits, for bits < 320
+static PrefixLimbs
+shifted_limbs(std::uint64_t v, std::size_t bits)
+{
+    PrefixLimbs result{};
+    std::size_t const i = bits / 64;
+    std::size_t const s = bits % 64;
+    result[i] = v << s;
+    if (s && i + 1 < result.size())
+        result[i + 1] = v >> (64 - s);
+    return result;
+}
+
+// 2^bits - 1
+static PrefixLimbs
+low_mask_limbs(std::size_t bits)
+{
+    PrefixLimbs result{};
+    for (std::size_t i = 0; i < result.size() && bits; ++i)
+    {
+        std::size_t const n = std::min<std::size_t>(bits, 64);
+        result[i] = n == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << n) - 1;
+        bits -= n;
+    }
+    return result;
+}
+
+Result<std::size_t>
+base58_prefix_ranges(
+    TokenType type,
+    std::size_t size,
+    std::string_view prefix,
+    std::span<std::uint8_t> lows,
+    std::span<std::uint8_t> highs)
+{
+    if (size > 33)
+        return boost::outcome_v2::failure(TokenCodecErrc::InputTooLarge);
+    if (size == 0)
+        return boost::outcome_v2::failure(TokenCodecErrc::InputTooSmall);
+    if (lows.size() < 3 * size || highs.size() < 3 * size)
+        return boost::outcome_v2::failure(TokenCodecErrc::OutputTooSmall);
+    for (auto c : prefix)
+    {
+        if (alphabetReverse[static_cast<unsigned char>(c)] < 0)
+            return boost::outcome_v2::failure(
+                TokenCodecErrc::InvalidEncodingChar);
+    }
+
+    // The values of the expanded tokens: `bytes` bytes, the first of which is
+    // the type
+    std::size_t const bytes = size + 5;
+    auto const type_byte = static_cast<std::uint64_t>(type);
+    PrefixLimbs lo = shifted_limbs(type_byte, 8 * (bytes - 1));
+    PrefixLimbs hi = shifted_limbs(type_byte + 1, 8 * (bytes - 1));
+    sub_limbs(hi, PrefixLimbs{}, 1);
+
+    // Leading zero bytes are the leading zero digits, and the digit after
+    // them is not zero
+    std::size_t const zeros =
+        std::min(prefix.find_first_not_of(alphabetForward[0]), prefix.size());
+    auto const rest = prefix.substr(zeros);
+    if (zeros > bytes || (!rest.empty() && zeros == bytes))
+        return 0;
+    auto const below = low_mask_limbs(8 * (bytes - zeros));
+    if (less_limbs(below, hi))
+        hi = below;
+    if (!rest.empty())
+    {
+        auto const above = shifted_limbs(1, 8 * (bytes - zeros - 1));
+        if (less_limbs(lo, above))
+            lo = above;
+    }
+
+    std::size_t count = 0;
+    auto const add_range = [&](PrefixLimbs const& low,
+                               PrefixLimbs const& high) {
+        // The payload is the bytes between the type and the checksum
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            std::size_t const bit = 32 + 8 * (size - 1 - i);
+            lows[count * size + i] =
+                static_cast<std::uint8_t>(low[bit / 64] >> (bit % 64));
+            highs[count * size + i] =
+                static_cast<std::uint8_t>(high[bit / 64] >> (bit % 64));
+        }
+        ++count;
+    };
+    if (less_limbs(hi, lo))
+        return 0;
+    if (rest.empty())
+    {
+        add_range(lo, hi);
+        return count;
+    }
+    // No token of a fixed size type has more than 52 digits
+    if (rest.size() > 52)
+        return 0;
+
+    // The tokens with `rest.size() + e` digits that start with the prefix
+    // are [p * 58^e, (p + 1) * 58^e). The bytes allowed above span a factor
+    // of at most 256, so at most three values of `e` give any.
+    PrefixLimbs p{};
+    for (auto c : rest)
+    {
+        auto const digit = alphabetReverse[static_cast<unsigned char>(c)];
+        [[maybe_unused]] auto const carry =
+            ::b58_fast::detail::inplace_bigint_mul_add(
+                std::span(p), 58, static_cast<std::uint64_t>(digit));
+        assert(carry == 0);
+    }
+    auto const& powers = ::b58_fast::detail::b58_powers;
+    for (std::size_t e = 0; e + rest.size() <= 52 && !less_limbs(hi, p); ++e)
+    {
+        PrefixLimbs end = p;
+        add_limbs_masked(end, powers[e], ~std::uint64_t{0});
+        sub_limbs(end, PrefixLimbs{}, 1);
+        if (!less_limbs(end, lo))
+        {
+            assert(count < 3);
+            add_range(
+                less_limbs(p, lo) ? lo : p, less_limbs(hi, end) ? hi : end);
+        }
+        [[maybe_unused]] auto const carry =
+            ::b58_fast::detail::inplace_bigint_mul_add(std::span(p), 58, 0);
+        assert(carry == 0);
+    }
+    return count;
+}
+
+}  // namespace detail
+// Convert from base 58 to base 256, largest coefficients first
+// The input is encoded in XPRL format, with the token in the first
+// byte and the checksum in the last four bytes.
+// The decoded base 256 value does not include the token type or checksum.
+// It is an error if the token type or checksum (unless `Check` is
+// `trusted`) does not match.
+namespace detail {
+template <ChecksumCheck Check>
+static Result<std::span<std::uint8_t>>
+decode_token(TokenType type, std::string_view s, std::span<std::uint8_t> outBuf)
+{
+    // Types with a fixed payload size take the fully unrolled path. It
+    // checks the size first, and decodes exactly what the general path
+    // decodes for tokens of the fixed size, so its other errors (characters,
+    // type, checksum) are final. Only tokens with an unusual size (or types
+    // without a fixed size) take the general path below.
+    auto const fixed = [&]() -> Result<std::span<std::uint8_t>> {
+        auto const size = tokenPayloadSize(type);
+        switch (outBuf.size() < size ? 0 : size)
+        {
+            case 16:
+                return decode_token_fixed<fast_sha256_hasher, Check>(
+                    type, s, outBuf.first<16>());
+            case 20:
+                return decode_token_fixed<fast_sha256_hasher, Check>(
+                    type, s, outBuf.first<20>());
+            case 32:
+                return decode_token_fixed<fast_sha256_hasher, Check>(
+                    type, s, outBuf.first<32>());
+            case 33:
+                return decode_token_fixed<fast_sha256_hasher, Check>(
+                    type, s, outBuf.first<33>());
+            default:
+                // No fixed path for the type (or the buffer is too small)
+                return boost::outcome_v2::failure(TokenCodecErrc::Unknown);
+        }
+    }();
+    if (fixed || (fixed.error() != TokenCodecErrc::InputTooSmall &&
+                  fixed.error() != TokenCodecErrc::InputTooLarge &&
+                  fixed.error() != TokenCodecErrc::Unknown))
+    {
+        return fixed;
+    }
+
+    // Every digit decodes to at most one byte, plus one for a zero value
+    std::array<std::uint8_t, maxEncodedTokenChars + 1> tmpBuf;
+    auto const decodeResult =
+        b58_to_b256(s, std::span(tmpBuf.data(), tmpBuf.size()));
+
+    if (!decodeResult)
+        return decodeResult;
+
+    auto const ret = decodeResult.value();
+
+    // Reject zero length tokens
+    if (ret.size() < 6)
+        return boost::outcome_v2::failure(TokenCodecErrc::InputTooSmall);
+
+    // The type must match.
+    if (type != static_cast<TokenType>(static_cast<std::uint8_t>(ret[0])))
+        return boost::outcome_v2::failure(TokenCodecErrc::MismatchedTokenType);
+
+    // And the checksum must as well.
+    constexpr std::size_t guardSize = 4;
+    if constexpr (Check == ChecksumCheck::verify)
+    {
+        std::array<std::uint8_t, guardSize> guard;
+        tokenChecksum<fast_sha256_hasher>(
+            guard.data(), ret.data(), ret.size() - guard.size());
+        if (!std::equal(guard.rbegin(), guard.rend(), ret.rbegin()))
+        {
+            return boost::outcome_v2::failure(
+                TokenCodecErrc::MismatchedChecksum);
+        }
+    }
+
+    std::size_t const outSize = ret.size() - 1 - guardSize;
+    if (outBuf.size() < outSize)
+        return boost::outcome_v2::failure(TokenCodecErrc::OutputTooSmall);
+    // Skip the leading type byte and the trailing checksum.
+    std::copy(ret.begin() + 1, ret.begin() + outSize + 1, outBuf.begin());
+    return boost::outcome_v2::success(outBuf.subspan(0, outSize));
+}
+}  // namespace detail
+
+Result<std::span<std::uint8_t>>
+decodeBase58Token(
+    TokenType type,
+    std::string_view s,
+    std::span<std::uint8_t> outBuf)
+{
+    return detail::decode_token<ChecksumCheck::verify>(type, s, outBuf);
+}
+
+Result<std::span<std::uint8_t>>
+decodeTrustedBase58Token(
+    TokenType type,
+    std::string_view s,
+    std::span<std::uint8_t> outBuf)
+{
+    return detail::decode_token<ChecksumCheck::trusted>(type, s, outBuf);
+}
+
+namespace detail {
+
+// What every token of a type with a fixed payload size looks like, before it
+// is converted
+struct TokenShape
+{
+    // Sizes of the shortest and the longest token; 0 if the type has no
+    // fixed payload size
+    std::size_t min_size = 0;
+    std::size_t max_size = 0;
+    // The characters a token can start with
+    std::array<bool, 256> first{};
+};
+
+// The number of base 58 digits of `v`
+static std::size_t
+b58_digit_count(PrefixLimbs const& v)
+{
+    auto const& powers = ::b58_fast::detail::b58_powers;
+    std::size_t count = 0;
+    while (count + 1 < powers.size() && !less_limbs(v, powers[count]))
+        ++count;
+    return count;
+}
+
+static TokenShape
+token_shape(TokenType type)
+{
+    TokenShape shape;
+    std::size_t const payload_size = tokenPayloadSize(type);
+    if (!payload_size)
+        return shape;
+
+    // The expanded tokens are the values [lo, hi]: the type is the top byte
+    std::size_t const bytes = payload_size + 5;
+    auto const type_byte = static_cast<std::uint64_t>(type);
+    PrefixLimbs const lo = shifted_limbs(type_byte, 8 * (bytes - 1));
+    PrefixLimbs hi = shifted_limbs(type_byte + 1, 8 * (bytes - 1));
+    sub_limbs(hi, PrefixLimbs{}, 1);
+    if (!type_byte)
+    {
+        // One zero digit for the type byte, then any value of the other
+        // bytes (all of them zero digits if they are zero)
+        shape.min_size = bytes;
+        shape.max_size = 1 + b58_digit_count(hi);
+        shape.first[static_cast<unsigned char>(alphabetForward[0])] = true;
+        return shape;
+    }
+
+    // No leading zero bytes, so the size is the number of digits, and the
+    // first digit of the tokens of each size is a range
+    shape.min_size = b58_digit_count(lo);
+    shape.max_size = b58_digit_count(hi);
+    auto const& powers = ::b58_fast::detail::b58_powers;
+    for (std::size_t size = shape.min_size; size <= shape.max_size; ++size)
+    {
+        for (std::uint64_t digit = 1; digit < 58; ++digit)
+        {
+            // [digit * 58^(size - 1), (digit + 1) * 58^(size - 1) - 1]
+            PrefixLimbs start = powers[size - 1];
+            [[maybe_unused]] auto const carry =
+                ::b58_fast::detail::inplace_bigint_mul_add(
+                    std::span(start), digit, 0);
+            assert(carry == 0);
+            PrefixLimbs end = start;
+            add_limbs_masked(end, powers[size - 1], ~std::uint64_t{0});
+            sub_limbs(end, PrefixLimbs{}, 1);
+            if (!less_limbs(hi, start) && !less_limbs(end, lo))
+                shape.first[static_cast<unsigned char>(
+                    alphabetForward[digit])] = true;
+        }
+    }
+    return shape;
+}
+
+static std::array<TokenShape, 256> const&
+token_shapes()
+{
+    static std::array<TokenShape, 256> const shapes = [] {
+        std::array<TokenShape, 256> result;
+        for (std::size_t i = 0; i < result.size(); ++i)
+            result[i] = token_shape(static_cast<TokenType>(i));
+        return result;
+    }();
+    return shapes;
+}
+
+// The cheap checks: the size and the first character
+static bool
+has_token_shape(TokenShape const& shape, std::string_view s)
+{
+    return s.size() >= shape.min_size && s.size() <= shape.max_size &&
+        shape.first[static_cast<unsigned char>(s[0])];
+}
+
+// Convert a token of the right shape into its expanded form (type + payload
+// + checksum) of `Size` bytes, and check the type and the checksum there
+template <std::size_t Size>
+static bool
+is_valid_fixed(TokenType type, std::string_view s, ChecksumCheck check)
+{
+    std::array<std::uint8_t, Size> buf;
+    if (!b58_to_b256_fixed<Size>(s, buf))
+        return false;
+    if (type != static_cast<TokenType>(buf[0]))
+        return false;
+    if (check == ChecksumCheck::trusted)
+        return true;
+    std::array<std::uint8_t, 4> guard;
+    tokenChecksum<fast_sha256_hasher>(guard.data(), buf.data(), Size - 4);
+    return std::equal(guard.begin(), guard.end(), buf.end() - 4);
+}
+
+static bool
+is_valid_shaped(TokenType type, std::string_view s, ChecksumCheck check)
+{
+    switch (tokenPayloadSize(type))
+    {
+        case 16:
+            return is_valid_fixed<21>(type, s, check);
+        case 20:
+            return is_valid_fixed<25>(type, s, check);
+        case 32:
+            return is_valid_fixed<37>(type, s, check);
+        case 33:
+            return is_valid_fixed<38>(type, s, check);
+        default: {
+            // No fixed size: decode into scratch
+            std::array<
+                std::uint8_t,
+                decodedSizeUpperBound(maxBase58TokenChars)>
+                buf;
+            if (check == ChecksumCheck::trusted)
+                return !!decodeTrustedBase58Token(type, s, buf);
+            return !!decodeBase58Token(type, s, buf);
+        }
+    }
+}
+
+}  // namespace detail
+
+bool
+isValidBase58Token(TokenType type, std::string_view s, ChecksumCheck check)
+{
+    auto const& shape = detail::token_shapes()[static_cast<std::uint8_t>(type)];
+    if (shape.max_size && !detail::has_token_shape(shape, s))
+        return false;
+    return detail::is_valid_shaped(type, s, check);
+}
+
+Result<std::size_t>
+isValidBase58TokenBatch(
+    TokenType type,
+    std::span<std::string_view const> inputs,
+    std::span<bool> valid,
+    ChecksumCheck check)
+{
+    if (valid.size() < inputs.size())
+        return boost::outcome_v2::failure(TokenCodecErrc::OutputTooSmall);
+
+    auto const& shape = detail::token_shapes()[static_cast<std::uint8_t>(type)];
+    for (std::size_t i = 0; i < inputs.size(); ++i)
+        valid[i] = !shape.max_size || detail::has_token_shape(shape, inputs[i]);
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < inputs.size(); ++i)
+    {
+        if (valid[i])
+            valid[i] = detail::is_valid_shaped(type, inputs[i], check);
+        count += valid[i];
+    }
+    return boost::outcome_v2::success(count);
+}
+
+namespace detail {
+// Encode up to `Lanes` tokens that all need `NumLimbs` base 2^64 coeffs. The
+// division chains of all the lanes are advanced together.
+template <std::size_t NumLimbs, std::size_t Lanes>
+static Result<std::span<std::uint8_t>>
+b256_to_b58_lanes(
+    TokenType token_type,
+    std::span<std::size_t const> indexes,
+    std::span<std::span<std::uint8_t const> const> inputs,
+    std::span<std::span<std::uint8_t>> outTokens)
+{
+    static_assert(NumLimbs > 0 && NumLimbs <= 5);
+    assert(indexes.size() <= Lanes);
+
+    // coeffs are stored structure-of-arrays: limbs[coeff][lane]
+    std::array<std::array<std::uint64_t, Lanes>, NumLimbs> limbs{};
+    std::array<std::size_t, Lanes> input_zeros{};
+    std::array<std::array<std::uint8_t, NumLimbs * 8>, Lanes> bufs{};
+    std::array<std::span<std::uint8_t const>, Lanes> group;
+    std::array<std::span<std::uint8_t>, Lanes> expanded;
+    for (std::size_t lane = 0; lane < indexes.size(); ++lane)
+    {
+        group[lane] = inputs[indexes[lane]];
+        expanded[lane] = std::span(bufs[lane]).subspan(
+            bufs[lane].size() - (group[lane].size() + 5));
+    }
+    expand_tokens(
+        token_type,
+        std::span(group.data(), indexes.size()),
+        std::span(expanded.data(), indexes.size()));
+    for (std::size_t lane = 0; lane < indexes.size(); ++lane)
+    {
+        auto const& buf = bufs[lane];
+        input_zeros[lane] =
+            std::find_if(
+                expanded[lane].begin(),
+                expanded[lane].end(),
+                [](std::uint8_t c) { return c != 0; }) -
+            expanded[lane].begin();
+
+        // convert from big endian to native u64, lowest coeff first. The
+        // expanded token is right aligned in `buf`, so the unused high bytes
+        // are zero.
+        for (std::size_t i = 0; i < NumLimbs; ++i)
+        {
+            std::uint64_t be;
+            std::memcpy(&be, &buf[buf.size() - (i + 1) * 8], 8);
+            limbs[i][lane] = boost::endian::big_to_native(be);
+        }
+    }
+
+    constexpr std::uint64_t B_58_10 = 430804206899405824;  // 58^10;
+    constexpr std::size_t num_58_10_coeffs = b58_10_coeffs_for_limbs(NumLimbs);
+    std::array<std::array<std::uint64_t, Lanes>, num_58_10_coeffs>
+        base_58_10_coeff;
+    std::size_t cur_2_64_end = NumLimbs;
+    for (auto& coeff : base_58_10_coeff)
+    {
+        if (cur_2_64_end == 0)
+        {
+            coeff = {};
+            continue;
+        }
+        coeff =
+            ::b58_fast::detail::inplace_bigint_div_rem_lanes<B_58_10, Lanes>(
+                std::span(limbs.data(), cur_2_64_end));
+        auto const& top = limbs[cur_2_64_end - 1];
+        if (std::all_of(
+                top.begin(), top.end(), [](std::uint64_t c) { return c == 0; }))
+        {
+            cur_2_64_end -= 1;
+        }
+    }
+
+    for (std::size_t lane = 0; lane < indexes.size(); ++lane)
+    {
+        std::array<std::uint64_t, num_58_10_coeffs> coeffs;
+        for (std::size_t i = 0; i < num_58_10_coeffs; ++i)
+        {
+            coeffs[i] = base_58_10_coeff[i][lane];
+        }
+        auto& out = outTokens[indexes[lane]];
+        auto const r = b58_10_to_alphabet(coeffs, input_zeros[lane], out);
+        if (!r)
+            return r;
+        out = r.value();
+    }
+    return boost::outcome_v2::success(std::span<std::uint8_t>{});
+}
+
+// Encode up to `kernelLanes` tokens with one of the vector kernels
+static Result<std::span<std::uint8_t>>
+b256_to_b58_vector(
+    CodecKernel kernel,
+    TokenType token_type,
+    std::span<std::size_t const> indexes,
+    std::span<std::span<std::uint8_t const> const> inputs,
+    std::span<std::span<std::uint8_t>> outTokens)
+{
+    assert(indexes.size() <= kernelLanes);
+    std::array<std::array<std::uint8_t, 38>, kernelLanes> bufs;
+    std::array<std::span<std::uint8_t const>, kernelLanes> group;
+    std::array<std::span<std::uint8_t>, kernelLanes> expanded;
+    std::array<std::span<std::uint8_t>, kernelLanes> outs;
+    std::array<TokenCodecErrc, kernelLanes> status;
+    std::size_t const n = indexes.size();
+    for (std::size_t lane = 0; lane < n; ++lane)
+    {
+        group[lane] = inputs[indexes[lane]];
+        expanded[lane] = bufs[lane];
+        outs[lane] = outTokens[indexes[lane]];
+    }
+    expand_tokens(
+        token_type, std::span(group.data(), n), std::span(expanded.data(), n));
+    std::array<std::span<std::uint8_t const>, kernelLanes> in;
+    std::copy_n(expanded.begin(), n, in.begin());
+    b256_to_b58_kernel(
+        kernel,
+        std::span(in.data(), n),
+        std::span(outs.data(), n),
+        std::span(status.data(), n));
+    for (std::size_t lane = 0; lane < n; ++lane)
+    {
+        if (status[lane] != TokenCodecErrc::Success)
+            return boost::outcome_v2::failure(status[lane]);
+        outTokens[indexes[lane]] = outs[lane];
+    }
+    return boost::outcome_v2::success(std::span<std::uint8_t>{});
+}
+
+// Decode a token of a type with a fixed payload size into an expanded token
+// (type + payload + checksum) with the fully unrolled conversion. Returns
+// false if the type has no fixed payload size or the token doesn't decode to
+// that size; those tokens need `b58_to_b256`.
+static bool
+b58_to_b256_typed(
+    TokenType type,
+    std::string_view input,
+    std::span<std::uint8_t, 64> buf,
+    std::span<std::uint8_t>& out)
+{
+    auto const r = [&]() -> Result<std::span<std::uint8_t>> {
+        switch (tokenPayloadSize(type))
+        {
+            case 16:
+                return b58_to_b256_fixed<21>(input, buf.first<21>());
+            case 20:
+                return b58_to_b256_fixed<25>(input, buf.first<25>());
+            case 32:
+                return b58_to_b256_fixed<37>(input, buf.first<37>());
+            case 33:
+                return b58_to_b256_fixed<38>(input, buf.first<38>());
+            default:
+                return boost::outcome_v2::failure(TokenCodecErrc::Unknown);
+        }
+    }();
+    if (!r)
+        return false;
+    out = r.value();
+    return true;
+}
+}  // namespace detail
+
+Result<std::span<std::uint8_t>>
+encodeBase58TokenBatch(
+    TokenType token_type,
+    std::span<std::span<std::uint8_t const> const> inputs,
+    std::span<std::uint8_t> outArena,
+    std::span<std::span<std::uint8_t>> outTokens)
+{
+    if (outTokens.size() < inputs.size())
+    {
+        return boost::outcome_v2::failure(TokenCodecErrc::OutputTooSmall);
+    }
+
+    // Give every token a slot in the arena large enough for its worst case
+    // encoding. The slots are compacted once all the tokens are encoded.
+    std::size_t arena_i = 0;
+    for (std::size_t i = 0; i < inputs.size(); ++i)
+    {
+        auto const size = inputs[i].size();
+        if (size > maxBase58TokenPayload)
+        {
+            return boost::outcome_v2::failure(TokenCodecErrc::InputTooLarge);
+        }
+        if (size == 0)
+        {
+            return boost::outcome_v2::failure(TokenCodecErrc::InputTooSmall);
+        }
+        auto const slot_size = encodedSizeUpperBound(size);
+        if (outArena.size() - arena_i < slot_size)
+        {
+            return boost::outcome_v2::failure(TokenCodecErrc::OutputTooSmall);
+        }
+        outTokens[i] = outArena.subspan(arena_i, slot_size);
+        arena_i += slot_size;
+    }
+
+    // Bucket the tokens by the number of base 2^64 coeffs they need so every
+    // lane in a group runs the same number of divides.
+    auto const kernel = activeKernel();
+    constexpr std::size_t lanes = 8;
+    std::size_t const group_size =
+        kernel == CodecKernel::scalar ? lanes : detail::kernelLanes;
+    auto encode_bucket =
+        [&]<std::size_t NumLimbs>() -> Result<std::span<std::uint8_t>> {
+        std::array<std::size_t, std::max(lanes, detail::kernelLanes)> indexes;
+        std::size_t num_indexes = 0;
+        auto flush = [&]() -> Result<std::span<std::uint8_t>> {
+            std::span<std::size_t const> const s(indexes.data(), num_indexes);
+            num_indexes = 0;
+            if (kernel != CodecKernel::scalar)
+                return detail::b256_to_b58_vector(
+                    kernel, token_type, s, inputs, outTokens);
+            // Don't pay for idle lanes on the last, partially filled, group
+            if (s.size() == 1)
+                return detail::b256_to_b58_lanes<NumLimbs, 1>(
+                    token_type, s, inputs, outTokens);
+            if (s.size() <= 4)
+                return detail::b256_to_b58_lanes<NumLimbs, 4>(
+                    token_type, s, inputs, outTokens);
+            return detail::b256_to_b58_lanes<NumLimbs, lanes>(
+                token_type, s, inputs, outTokens);
+        };
+        for (std::size_t i = 0; i < inputs.size(); ++i)
+        {
+            if (inputs[i].size() > 33 ||
+                detail::b256_limbs_for_size(inputs[i].size() + 5) != NumLimbs)
+                continue;
+            indexes[num_indexes++] = i;
+            if (num_indexes == group_size)
+            {
+                if (auto r = flush(); !r)
+                    return r;
+            }
+        }
+        if (num_indexes)
+            return flush();
+        return boost::outcome_v2::success(std::span<std::uint8_t>{});
+    };
+    Result<std::span<std::uint8_t>> r =
+        boost::outcome_v2::success(std::span<std::uint8_t>{});
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+        ((r = encode_bucket.template operator()<I + 1>()) && ...);
+    }(std::make_index_sequence<5>{});
+    if (!r)
+        return r;
+
+    // Tokens larger than any type's take the fixed width scalar conversion
+    for (std::size_t i = 0; i < inputs.size(); ++i)
+    {
+        if (inputs[i].size() <= 33)
+            continue;
+        auto const token =
+            encodeBase58Token(token_type, inputs[i], outTokens[i]);
+        if (!token)
+            return boost::outcome_v2::failure(token.error());
+        outTokens[i] = token.value();
+    }
+
+    // Compact the slots so the tokens are contiguous and in input order.
+    arena_i = 0;
+    for (std::size_t i = 0; i < inputs.size(); ++i)
+    {
+        auto const size = outTokens[i].size();
+        std::memmove(&outArena[arena_i], outTokens[i].data(), size);
+        outTokens[i] = outArena.subspan(arena_i, size);
+        arena_i += size;
+    }
+    return boost::outcome_v2::success(outArena.subspan(0, arena_i));
+}
+
+Result<std::span<std::uint8_t>>
+decodeBase58TokenBatch(
+    std::span<TokenType const> types,
+    std::span<std::string_view const> inputs,
+    std::span<std::uint8_t> outArena,
+    std::span<std::span<std::uint8_t>> outTokens,
+    std::span<TokenCodecErrc> statuses)
+{
+    if (types.size() < inputs.size())
+    {
+        return boost::outcome_v2::failure(TokenCodecErrc::InputTooSmall);
+    }
+    if (outTokens.size() < inputs.size() || statuses.size() < inputs.size())
+    {
+        return boost::outcome_v2::failure(TokenCodecErrc::OutputTooSmall);
+    }
+
+    // Give every token a slot in the arena large enough for its worst case
+    // decoding. The slots are compacted once all the tokens are decoded.
+    std::size_t arena_i = 0;
+    for (std::size_t i = 0; i < inputs.size(); ++i)
+    {
+        auto const slot_size = decodedSizeUpperBound(inputs[i].size());
+        if (outArena.size() - arena_i < slot_size)
+        {
+            return boost::outcome_v2::failure(TokenCodecErrc::OutputTooSmall);
+        }
+        outTokens[i] = outArena.subspan(arena_i, slot_size);
+        arena_i += slot_size;
+    }
+
+    auto const kernel = activeKernel();
+    constexpr std::size_t group_size = detail::kernelLanes;
+    std::array<std::array<std::uint8_t, detail::maxEncodedTokenChars + 1>,
+               group_size>
+        bufs;
+    std::array<std::span<std::uint8_t>, group_size> expanded;
+    std::array<std::array<std::uint8_t, 4>, group_size> guards;
+    for (std::size_t first = 0; first < inputs.size(); first += group_size)
+    {
+        std::size_t const n = std::min(group_size, inputs.size() - first);
+        auto const status = statuses.subspan(first, n);
+
+        // Tokens of types with a fixed payload size take the fully unrolled
+        // conversion. The others, and the tokens it rejects, go through the
+        // kernel, which reports the same errors as `decodeBase58Token`.
+        std::array<std::size_t, group_size> rest;
+        std::size_t num_rest = 0;
+        for (std::size_t lane = 0; lane < n; ++lane)
+        {
+            status[lane] = TokenCodecErrc::Success;
+            if (!detail::b58_to_b256_typed(
+                    types[first + lane],
+                    inputs[first + lane],
+                    std::span(bufs[lane]).first<64>(),
+                    expanded[lane]))
+                rest[num_rest++] = lane;
+        }
+        if (num_rest)
+        {
+            std::array<std::string_view, group_size> rest_in;
+            std::array<std::span<std::uint8_t>, group_size> rest_out;
+            std::array<TokenCodecErrc, group_size> rest_status;
+            for (std::size_t i = 0; i < num_rest; ++i)
+            {
+                rest_in[i] = inputs[first + rest[i]];
+                rest_out[i] = bufs[rest[i]];
+            }
+            detail::b58_to_b256_kernel(
+                kernel,
+                std::span(rest_in.data(), num_rest),
+                std::span(rest_out.data(), num_rest),
+                std::span(rest_status.data(), num_rest));
+            for (std::size_t i = 0; i < num_rest; ++i)
+            {
+                expanded[rest[i]] = rest_out[i];
+                status[rest[i]] = rest_status[i];
+            }
+        }
+
+        // Reject zero length tokens and tokens of the wrong type before
+        // paying for their hashes.
+        for (std::size_t lane = 0; lane < n; ++lane)
+        {
+            if (status[lane] != TokenCodecErrc::Success)
+                continue;
+            auto const e = expanded[lane];
+            if (e.size() < 6)
+                status[lane] = TokenCodecErrc::InputTooSmall;
+            else if (
+                types[first + lane] !=
+                static_cast<TokenType>(static_cast<std::uint8_t>(e[0])))
+                status[lane] = TokenCodecErrc::MismatchedTokenType;
+        }
+
+        // Hash all the remaining tokens in one pass
+        std::array<std::span<std::uint8_t const>, group_size> messages;
+        std::array<std::size_t, group_size> message_lanes;
+        std::array<std::array<std::uint8_t, 4>, group_size> sums;
+        std::size_t num_messages = 0;
+        for (std::size_t lane = 0; lane < n; ++lane)
+        {
+            if (status[lane] != TokenCodecErrc::Success)
+                continue;
+            auto const e = expanded[lane];
+            messages[num_messages] = e.first(e.size() - 4);
+            message_lanes[num_messages++] = lane;
+        }
+        checksumBatch(
+            std::span(sums.data(), num_messages),
+            std::span(messages.data(), num_messages));
+        for (std::size_t i = 0; i < num_messages; ++i)
+            guards[message_lanes[i]] = sums[i];
+
+        // Check the checksums and copy out the data, skipping the leading
+        // type byte and the trailing checksum
+        for (std::size_t lane = 0; lane < n; ++lane)
+        {
+            auto& o = outTokens[first + lane];
+            auto const e = expanded[lane];
+            if (status[lane] == TokenCodecErrc::Success)
+            {
+                if (!std::equal(
+                        guards[lane].begin(), guards[lane].end(), e.end() - 4))
+                    status[lane] = TokenCodecErrc::MismatchedChecksum;
+                else if (o.size() < e.size() - 5)
+                    status[lane] = TokenCodecErrc::OutputTooSmall;
+            }
+            if (status[lane] != TokenCodecErrc::Success)
+            {
+                o = o.subspan(0, 0);
+                continue;
+            }
+            o = o.subspan(0, e.size() - 5);
+            std::copy(e.begin() + 1, e.end() - 4, o.begin());
+        }
+    }
+
+    // Compact the slots so the tokens are contiguous and in input order.
+    arena_i = 0;
+    for (std::size_t i = 0; i < inputs.size(); ++i)
+    {
+        auto const size = outTokens[i].size();
+        std::memmove(outArena.data() + arena_i, outTokens[i].data(), size);
+        outTokens[i] = outArena.subspan(arena_i, size);
+        arena_i += size;
+    }
+    return boost::outcome_v2::success(outArena.subspan(0, arena_i));
+}
+
+Result<std::size_t>
+verifyBase58TokenBatch(
+    std::span<TokenType const> types,
+    std::span<std::string_view const> inputs,
+    std::span<TokenCodecErrc> statuses)
+{
+    if (types.size() < inputs.size())
+    {
+        return boost::outcome_v2::failure(TokenCodecErrc::InputTooSmall);
+    }
+    if (statuses.size() < inputs.size())
+    {
+        return boost::outcome_v2::failure(TokenCodecErrc::OutputTooSmall);
+    }
+
+    // Decode in chunks that fit in a fixed arena; only the statuses are kept
+    constexpr std::size_t chunk_size = 2 * detail::kernelLanes;
+    std::array<
+        std::uint8_t,
+        chunk_size * decodedSizeUpperBound(maxBase58TokenChars)>
+        arena;
+    std::array<std::span<std::uint8_t>, chunk_size> outTokens;
+    std::size_t failed = 0;
+    for (std::size_t first = 0; first < inputs.size(); first += chunk_size)
+    {
+        std::size_t const n = std::min(chunk_size, inputs.size() - first);
+        auto const r = decodeBase58TokenBatch(
+            types.subspan(first, n),
+            inputs.subspan(first, n),
+            arena,
+            std::span(outTokens).first(n),
+            statuses.subspan(first, n));
+        if (!r)
+            return boost::outcome_v2::failure(r.error());
+        failed += std::count_if(
+            statuses.begin() + first,
+            statuses.begin() + first + n,
+            [](TokenCodecErrc e) { return e != TokenCodecErrc::Success; });
+    }
+    return boost::outcome_v2::success(failed);
+}
+
+[[nodiscard]] std::string
+encodeBase58Token(TokenType type, void const* token, std::size_t size)
+{
+    std::string sr;
+    sr.resize(encodedSizeUpperBound(size));
+    std::span<std::uint8_t> outSp(
+        reinterpret_cast<std::uint8_t*>(sr.data()), sr.size());
+    std::span<std::uint8_t const> inSp(
+        reinterpret_cast<std::uint8_t const*>(token), size);
+    auto r = b58_fast::encodeBase58Token(type, inSp, outSp);
+    if (!r)
+        return {};
+    sr.resize(r.value().size());
+    return sr;
+}
+
+[[nodiscard]] std::string
+decodeBase58Token(std::string const& s, TokenType type)
+{
+    std::string sr;
+    sr.resize(decodedSizeUpperBound(s.size()));
+    std::span<std::uint8_t> outSp(
+        reinterpret_cast<std::uint8_t*>(sr.data()), sr.size());
+    auto r = b58_fast::decodeBase58Token(type, s, outSp);
+    if (!r)
+        return {};
+    sr.resize(r.value().size());
+    return sr;
+}
+
+[[nodiscard]] Base58String
+encodeBase58TokenInline(TokenType type, void const* token, std::size_t size)
+{
+    // The largest object encoded as base58 is 33 bytes, which is encoded in
+    // at most encodedSizeUpperBound(33) = 53 characters.
+    static_assert(encodedSizeUpperBound(33) <= Base58String::capacity);
+    std::array<std::uint8_t, Base58String::capacity> buf;
+    std::span<std::uint8_t const> inSp(
+        reinterpret_cast<std::uint8_t const*>(token), size);
+    auto r = b58_fast::encodeBase58Token(type, inSp, buf);
+    if (!r)
+        return {};
+    return Base58String(std::string_view(
+        reinterpret_cast<char const*>(r.value().data()), r.value().size()));
+}
+
+[[nodiscard]] Base58String
+decodeBase58TokenInline(std::string_view s, TokenType type)
+{
+    // The payload of a token of up to 60 characters always fits; a longer
+    // one fits if it is at most `capacity` bytes, and fails with
+    // OutputTooSmall otherwise.
+    static_assert(decodedSizeUpperBound(60) <= Base58String::capacity);
+    static_assert(decodedSizeUpperBound(61) > Base58String::capacity);
+    std::array<std::uint8_t, Base58String::capacity> buf;
+    auto r = b58_fast::decodeBase58Token(type, s, buf);
+    if (!r)
+        return {};
+    return Base58String(std::string_view(
+        reinterpret_cast<char const*>(r.value().data()), r.value().size()));
 }
 
 }  // namespace b58_fast
@@ -20,16 +20,25 @@
 #ifndef RIPPLE_PROTOCOL_TOKENS_H_INCLUDED
 #define RIPPLE_PROTOCOL_TOKENS_H_INCLUDED
 
+#include <b58_portable.h>
+#include <b58_string.h>
+#include <digest.h>
 #include <token_errors.h>
 
+#include <boost/container/static_vector.hpp>
 #include <boost/outcome.hpp>
 #include <boost/outcome/result.hpp>
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
 #include <cstdint>
 #include <optional>
 #include <span>
 #include <string>
 #include <string_view>
+#include <type_traits>
 
 namespace ripple {
 
@@ -47,13 +56,47 @@ enum class TokenType : std::uint8_t {
     FamilySeed = 33
 };
 
+/** A type that holds a token payload as raw bytes
+
+    Any trivially copyable type without padding the size of a fixed payload
+    (16, 20, 32 or 33 bytes), like `std::array<std::uint8_t, 20>` or a
+    `uint160`. Its bytes are the payload.
+*/
 template <class T>
-[[nodiscard]] std::optional<T>
-parseBase58(std::string const& s);
+concept Base58Payload = std::is_trivially_copyable_v<T> &&
+    std::is_default_constructible_v<T> &&
+    std::has_unique_object_representations_v<T> &&
+    (sizeof(T) == 16 || sizeof(T) == 20 || sizeof(T) == 32 ||
+     sizeof(T) == 33);
+
+/** The type of the tokens `parseBase58<T>(s)` decodes
 
+    AccountID for 20 byte types and FamilySeed for 16 byte types; other types
+    must name the token type. Specialize it to change the default for a type.
+*/
 template <class T>
-[[nodiscard]] std::optional<T>
-parseBase58(TokenType type, std::string const& s);
+constexpr std::optional<TokenType> base58TokenType = sizeof(T) == 20
+    ? std::optional(TokenType::AccountID)
+    : sizeof(T) == 16 ? std::optional(TokenType::FamilySeed) : std::nullopt;
+
+/** Decode a token straight into a `T`
+
+    The size of `T` is the size of the payload; a token with any other size
+    is rejected before the base conversion. Takes a `std::string_view`, so
+    tokens can be parsed in place (in a JSON buffer, for example). In
+    constant evaluation it decodes with `b58_portable::decodeBase58Token<N>`,
+    so a `constexpr` variable can hold a token known at compile time.
+
+    @return the payload, or nothing if `s` is not a valid token of the type.
+*/
+template <Base58Payload T>
+[[nodiscard]] constexpr std::optional<T>
+parseBase58(TokenType type, std::string_view s);
+
+template <Base58Payload T>
+    requires(base58TokenType<T>.has_value())
+[[nodiscard]] constexpr std::optional<T>
+parseBase58(std::string_view s);
 
 /** Encode data in Base58Check format using XRPL alphabet
 
@@ -81,7 +124,87 @@ encodeBase58Token(TokenType type, void const* token, std::size_t size);
 decodeBase58Token(std::string const& s, TokenType type);
 }  // namespace b58_ref
 
-#ifndef _MSC_VER
+/** Codecs that don't need `unsigned __int128`
+
+    Same results and errors as the `b58_fast` codecs of the same name, for
+    the same sizes, but the values are base 2^32 coeffs and the intermediate
+    values are base 58^5 coeffs (less than 2^30): a coeff times 58^5 plus a
+    carry fits in a `std::uint64_t`. `encodeBase58Token` and
+    `decodeBase58Token` use these where `b58_fast` isn't available, which
+    includes builds with `XRPL_B58_PORTABLE`.
+*/
+namespace b58_portable {
+[[nodiscard]] Result<std::span<std::uint8_t>>
+encodeBase58Token(
+    TokenType token_type,
+    std::span<std::uint8_t const> input,
+    std::span<std::uint8_t> out);
+
+[[nodiscard]] Result<std::span<std::uint8_t>>
+decodeBase58Token(
+    TokenType type,
+    std::string_view s,
+    std::span<std::uint8_t> outBuf);
+
+[[nodiscard]] std::string
+encodeBase58Token(TokenType type, void const* token, std::size_t size);
+
+[[nodiscard]] std::string
+decodeBase58Token(std::string const& s, TokenType type);
+
+/** Encode a token, in constant evaluation too
+
+    Same as `encodeBase58Token`, with the checksum computed by
+    `constexprTokenChecksum`, so tables of tokens can be built at compile
+    time. At run time use `encodeBase58Token`, which is much faster.
+*/
+template <std::size_t N>
+    requires(N > 0 && N <= 33)
+[[nodiscard]] constexpr Base58String
+encodeBase58Token(TokenType type, std::array<std::uint8_t, N> const& payload)
+{
+    std::array<std::uint8_t, Base58String::capacity> buf{};
+    std::size_t size = 0;
+    [[maybe_unused]] auto const ec = detail::encode_token(
+        static_cast<std::uint8_t>(type),
+        payload,
+        buf,
+        size,
+        constexprTokenChecksum);
+    // A payload of up to 33 bytes always fits
+    assert(ec == TokenCodecErrc::Success);
+    std::array<char, Base58String::capacity> chars{};
+    std::copy(buf.begin(), buf.begin() + size, chars.begin());
+    return Base58String(std::string_view(chars.data(), size));
+}
+
+/** Decode a token with a payload of `N` bytes, in constant evaluation too
+
+    Same as `decodeBase58Token`, with the checksum computed by
+    `constexprTokenChecksum`.
+
+    @return the payload, or nothing if `s` is not a valid token of the type
+            with an `N` byte payload.
+*/
+template <std::size_t N>
+[[nodiscard]] constexpr std::optional<std::array<std::uint8_t, N>>
+decodeBase58Token(TokenType type, std::string_view s)
+{
+    std::array<std::uint8_t, N> payload{};
+    std::size_t size = 0;
+    auto const ec = detail::decode_token(
+        static_cast<std::uint8_t>(type),
+        s,
+        payload,
+        size,
+        constexprTokenChecksum);
+    if (ec != TokenCodecErrc::Success || size != N)
+        return std::nullopt;
+    return payload;
+}
+}  // namespace b58_portable
+
+#if !defined(_MSC_VER) && !defined(XRPL_B58_PORTABLE)
 namespace b58_fast {
 // Use the fast version (10-15x faster) is using gcc extensions (int128 in
 // particular)
@@ -97,16 +220,550 @@ decodeBase58Token(
     std::string_view s,
     std::span<std::uint8_t> outBuf);
 
-// This interface matches the old interface, but requires additional allocation
+/** Whether decoding recomputes the checksum of a token
+
+    With `trusted` the characters, the size and the type byte are still
+    checked, but the checksum is not, so a corrupted token may decode to the
+    wrong data. Only use it for tokens this software wrote itself, and audit
+    them with `verifyBase58TokenBatch` off the hot path.
+*/
+enum class ChecksumCheck : std::uint8_t { verify, trusted };
+
+/** Decode a token without verifying its checksum
+
+    Same as `decodeBase58Token`, except that a token with a wrong checksum is
+    not rejected (see `ChecksumCheck::trusted`).
+*/
+[[nodiscard]] Result<std::span<std::uint8_t>>
+decodeTrustedBase58Token(
+    TokenType type,
+    std::string_view s,
+    std::span<std::uint8_t> outBuf);
+
+/** Return true if `s` is a token of the given type
+
+    Same as whether `decodeBase58Token` (or `decodeTrustedBase58Token`, with
+    `ChecksumCheck::trusted`) succeeds, but nothing is written out. For the
+    types with a fixed payload size the token must also have that size, as
+    with `decode<Type>`.
+
+    For those types, a token with a length or a first character that no
+    token of the type has is rejected before anything else, and the alphabet
+    is checked in the pass that reads the digits, before any base
+    conversion. The checksum is compared in place.
+*/
+[[nodiscard]] bool
+isValidBase58Token(
+    TokenType type,
+    std::string_view s,
+    ChecksumCheck check = ChecksumCheck::verify);
+
+/** Check a batch of tokens of the same type
+
+    Same as `isValidBase58Token` for each input. The cheap checks are done
+    for the whole batch first, so only the tokens that pass them are
+    converted.
+
+    @param valid Receives whether each input is a token of the type.
+
+    @return the number of valid tokens. Fails only if `valid` is too small
+            for the batch.
+*/
+[[nodiscard]] Result<std::size_t>
+isValidBase58TokenBatch(
+    TokenType type,
+    std::span<std::string_view const> inputs,
+    std::span<bool> valid,
+    ChecksumCheck check = ChecksumCheck::verify);
+
+/** Encode only the first `k` characters of a token
+
+    Gives the first `k` characters `encodeBase58Token` gives (all of them if
+    the token is shorter), for prefix filters, vanity matching and sharding.
+    Only the leading base 58 digits are computed: up to ten of them are the
+    quotient of the token by a power of 58, which is estimated from the top
+    bits of both. The checksum is computed only when it can change those
+    digits, which for short prefixes is almost never.
+
+    @return the prefix, at the start of `out`.
+*/
+[[nodiscard]] Result<std::span<std::uint8_t>>
+encodeBase58TokenPrefix(
+    TokenType token_type,
+    std::span<std::uint8_t const> input,
+    std::size_t k,
+    std::span<std::uint8_t> out);
+
+/** Return true if the encoded token starts with `prefix`
+
+    Same as comparing `prefix` with the result of `encodeBase58TokenPrefix`,
+    but it returns as soon as the answer is known: a character that can't
+    match stops it before any conversion.
+*/
+[[nodiscard]] Result<bool>
+base58TokenStartsWith(
+    TokenType token_type,
+    std::span<std::uint8_t const> input,
+    std::string_view prefix);
+
+/** Upper bound on the size of an encoded token
+
+    @param size The size of the data to encode (not including the type byte
+                or the checksum).
+*/
+[[nodiscard]] constexpr std::size_t
+encodedSizeUpperBound(std::size_t size)
+{
+    // expanded token includes type + 4 byte checksum; log(256) / log(58) is
+    // bounded by 138 / 100
+    return (1 + size + 4) * 138 / 100 + 1;
+}
+
+/** The largest data `encodeBase58Token` encodes
+
+    With the type and the checksum it makes a 128 byte token.
+*/
+constexpr std::size_t maxBase58TokenPayload = 123;
+
+/** The longest token `decodeBase58Token` decodes
+
+    It is the longest encoding of `maxBase58TokenPayload` bytes.
+*/
+constexpr std::size_t maxBase58TokenChars = 175;
+
+/** Upper bound on the size of the data in a decoded token
+
+    @param size The size of the encoded token.
+*/
+[[nodiscard]] constexpr std::size_t
+decodedSizeUpperBound(std::size_t size)
+{
+    // every character decodes to at most one byte of the expanded token (plus
+    // one for a zero value), which includes the type + 4 byte checksum.
+    return size < 5 || size > maxBase58TokenChars ? 0 : size - 4;
+}
+
+/** The size of the data encoded in tokens of the given type
+
+    @return the size, or 0 if tokens of the type don't have a fixed size.
+*/
+[[nodiscard]] constexpr std::size_t
+tokenPayloadSize(TokenType type)
+{
+    switch (type)
+    {
+        case TokenType::FamilySeed:
+            return 16;
+        case TokenType::AccountID:
+            return 20;
+        case TokenType::NodePrivate:
+        case TokenType::AccountSecret:
+            return 32;
+        case TokenType::NodePublic:
+        case TokenType::AccountPublic:
+            return 33;
+        default:
+            return 0;
+    }
+}
+
+template <TokenType Type>
+using TokenPayload = std::array<std::uint8_t, tokenPayloadSize(Type)>;
+
+namespace detail {
+
+// Base conversions of an expanded token (type + payload + checksum) of
+// exactly `Size` bytes, fully unrolled (see tokens.cpp). Available for the
+// expanded tokens of the fixed size payloads: 21, 25, 37 and 38 bytes.
+template <std::size_t Size>
+[[nodiscard]] Result<std::span<std::uint8_t>>
+b256_to_b58_fixed(
+    std::span<std::uint8_t const, Size> input,
+    std::span<std::uint8_t> out);
+
+template <std::size_t Size>
+[[nodiscard]] Result<std::span<std::uint8_t>>
+b58_to_b256_fixed(std::string_view input, std::span<std::uint8_t, Size> out);
+
+extern template Result<std::span<std::uint8_t>>
+b256_to_b58_fixed<21>(
+    std::span<std::uint8_t const, 21>,
+    std::span<std::uint8_t>);
+extern template Result<std::span<std::uint8_t>>
+b256_to_b58_fixed<25>(
+    std::span<std::uint8_t const, 25>,
+    std::span<std::uint8_t>);
+extern template Result<std::span<std::uint8_t>>
+b256_to_b58_fixed<37>(
+    std::span<std::uint8_t const, 37>,
+    std::span<std::uint8_t>);
+extern template Result<std::span<std::uint8_t>>
+b256_to_b58_fixed<38>(
+    std::span<std::uint8_t const, 38>,
+    std::span<std::uint8_t>);
+extern template Result<std::span<std::uint8_t>>
+b58_to_b256_fixed<21>(std::string_view, std::span<std::uint8_t, 21>);
+extern template Result<std::span<std::uint8_t>>
+b58_to_b256_fixed<25>(std::string_view, std::span<std::uint8_t, 25>);
+extern template Result<std::span<std::uint8_t>>
+b58_to_b256_fixed<37>(std::string_view, std::span<std::uint8_t, 37>);
+extern template Result<std::span<std::uint8_t>>
+b58_to_b256_fixed<38>(std::string_view, std::span<std::uint8_t, 38>);
+
+// Encode a token with a payload of exactly `N` bytes
+template <class Hasher, std::size_t N>
+[[nodiscard]] Result<std::span<std::uint8_t>>
+encode_token_fixed(
+    TokenType token_type,
+    std::span<std::uint8_t const, N> input,
+    std::span<std::uint8_t> out)
+{
+    // <type (1 byte)><token (N bytes)><checksum (4 bytes)>
+    std::array<std::uint8_t, N + 5> buf;
+    buf[0] = static_cast<std::uint8_t>(token_type);
+    std::copy(input.begin(), input.end(), buf.begin() + 1);
+    tokenChecksum<Hasher>(&buf[N + 1], buf.data(), N + 1);
+    return b256_to_b58_fixed<N + 5>(buf, out);
+}
+
+// Decode a token with a payload of exactly `N` bytes
+template <
+    class Hasher,
+    ChecksumCheck Check = ChecksumCheck::verify,
+    std::size_t N>
+[[nodiscard]] Result<std::span<std::uint8_t>>
+decode_token_fixed(
+    TokenType type,
+    std::string_view s,
+    std::span<std::uint8_t, N> out)
+{
+    std::array<std::uint8_t, N + 5> buf;
+    if (auto const r = b58_to_b256_fixed<N + 5>(s, buf); !r)
+        return r;
+
+    // The type must match.
+    if (type != static_cast<TokenType>(buf[0]))
+        return boost::outcome_v2::failure(TokenCodecErrc::MismatchedTokenType);
+
+    // And the checksum must as well.
+    if constexpr (Check == ChecksumCheck::verify)
+    {
+        std::array<std::uint8_t, 4> guard;
+        tokenChecksum<Hasher>(guard.data(), buf.data(), N + 1);
+        if (!std::equal(guard.begin(), guard.end(), buf.begin() + N + 1))
+        {
+            return boost::outcome_v2::failure(
+                TokenCodecErrc::MismatchedChecksum);
+        }
+    }
+
+    // Skip the leading type byte and the trailing checksum.
+    std::copy(buf.begin() + 1, buf.begin() + N + 1, out.begin());
+    return boost::outcome_v2::success(std::span<std::uint8_t>(out));
+}
+
+}  // namespace detail
+
+/** Encode a token with a payload of `N` bytes
+
+    The sizes of the base conversions are known at compile time, so they are
+    fully unrolled. Available for payloads of 16, 20, 32 and 33 bytes. The
+    span overload forwards here when the input has one of those sizes.
+
+    `Hasher` computes the checksum (see `tokenChecksum`), for example
+    `encodeBase58Token<openssl_sha256_hasher>(type, payload, out)`.
+*/
+template <class Hasher = fast_sha256_hasher, std::size_t N>
+[[nodiscard]] Result<std::span<std::uint8_t>>
+encodeBase58Token(
+    TokenType token_type,
+    std::array<std::uint8_t, N> const& input,
+    std::span<std::uint8_t> out)
+{
+    return detail::encode_token_fixed<Hasher>(
+        token_type, std::span<std::uint8_t const, N>(input), out);
+}
+
+/** Decode a token with a payload of `N` bytes
+
+    It is an error if the token doesn't decode to exactly `N` bytes. Available
+    for payloads of 16, 20, 32 and 33 bytes. `Hasher` computes the checksum
+    (see `tokenChecksum`).
+*/
+template <std::size_t N, class Hasher = fast_sha256_hasher>
+[[nodiscard]] Result<std::array<std::uint8_t, N>>
+decodeBase58Token(TokenType type, std::string_view s)
+{
+    std::array<std::uint8_t, N> out;
+    auto const r = detail::decode_token_fixed<Hasher>(type, s, std::span(out));
+    if (!r)
+        return boost::outcome_v2::failure(r.error());
+    return boost::outcome_v2::success(out);
+}
+
+/** Encode a token of a type with a fixed payload size
+
+    For example: `encode<TokenType::AccountID>(accountID, out)`
+*/
+template <TokenType Type, class Hasher = fast_sha256_hasher>
+    requires(tokenPayloadSize(Type) != 0)
+[[nodiscard]] Result<std::span<std::uint8_t>>
+encode(TokenPayload<Type> const& payload, std::span<std::uint8_t> out)
+{
+    return encodeBase58Token<Hasher>(Type, payload, out);
+}
+
+/** Decode a token of a type with a fixed payload size
+
+    For example: `decode<TokenType::AccountID>(s)`
+*/
+template <TokenType Type, class Hasher = fast_sha256_hasher>
+    requires(tokenPayloadSize(Type) != 0)
+[[nodiscard]] Result<TokenPayload<Type>>
+decode(std::string_view s)
+{
+    return decodeBase58Token<tokenPayloadSize(Type), Hasher>(Type, s);
+}
+
+/** Decode a token of a type with a fixed payload size, without verifying its
+    checksum (see `ChecksumCheck::trusted`)
+
+    For example: `decodeTrusted<TokenType::AccountID>(s)`
+*/
+template <TokenType Type>
+    requires(tokenPayloadSize(Type) != 0)
+[[nodiscard]] Result<TokenPayload<Type>>
+decodeTrusted(std::string_view s)
+{
+    TokenPayload<Type> out;
+    auto const r =
+        detail::decode_token_fixed<fast_sha256_hasher, ChecksumCheck::trusted>(
+            Type, s, std::span(out));
+    if (!r)
+        return boost::outcome_v2::failure(r.error());
+    return boost::outcome_v2::success(out);
+}
+
+namespace detail {
+
+// Writes the ranges `base58PrefixRanges` gives for payloads of `size` bytes:
+// the low and high payload of range i go at offset i * size of `lows` and
+// `highs` (which hold three ranges). Returns the number of ranges.
+[[nodiscard]] Result<std::size_t>
+base58_prefix_ranges(
+    TokenType type,
+    std::size_t size,
+    std::string_view prefix,
+    std::span<std::uint8_t> lows,
+    std::span<std::uint8_t> highs);
+
+}  // namespace detail
+
+/** A range of payloads, with both ends included
+
+    Payloads compare as big endian numbers, which is how `std::array`
+    compares them.
+*/
+template <TokenType Type>
+struct Base58PayloadRange
+{
+    TokenPayload<Type> low;
+    TokenPayload<Type> high;
+};
+
+template <TokenType Type>
+using Base58PrefixRanges =
+    boost::container::static_vector<Base58PayloadRange<Type>, 3>;
+
+/** The payloads whose tokens start with `prefix`
+
+    A token of a given length starts with the prefix if its value (type +
+    payload + checksum) lies in one interval, so the matching payloads are
+    one range per length the tokens can have: at most three, in increasing
+    order. The checksum is the low bytes of the value, so the payloads at the
+    ends of a range may or may not match; every payload strictly inside does.
+    Check the ends with `base58TokenStartsWith`.
+
+    For example: `base58PrefixRanges<TokenType::AccountID>("rPEPPER")`
+
+    @return no ranges if no token of the type starts with the prefix.
+*/
+template <TokenType Type>
+    requires(tokenPayloadSize(Type) != 0)
+[[nodiscard]] Result<Base58PrefixRanges<Type>>
+base58PrefixRanges(std::string_view prefix)
+{
+    constexpr std::size_t size = tokenPayloadSize(Type);
+    std::array<std::uint8_t, 3 * size> lows;
+    std::array<std::uint8_t, 3 * size> highs;
+    auto const r =
+        detail::base58_prefix_ranges(Type, size, prefix, lows, highs);
+    if (!r)
+        return boost::outcome_v2::failure(r.error());
+    Base58PrefixRanges<Type> ranges(r.value());
+    for (std::size_t i = 0; i < ranges.size(); ++i)
+    {
+        std::copy_n(&lows[i * size], size, ranges[i].low.begin());
+        std::copy_n(&highs[i * size], size, ranges[i].high.begin());
+    }
+    return boost::outcome_v2::success(ranges);
+}
+
+/** Encode a batch of tokens of the same type
+
+    The tokens are grouped by size and encoded together, so the base
+    conversions of different tokens can overlap. Inputs larger than 33 bytes
+    (the largest token type) are encoded one at a time, as by
+    `encodeBase58Token`; any size up to `maxBase58TokenPayload` is accepted.
+
+    @param token_type The type of the tokens to encode.
+    @param inputs The data to encode for each token.
+    @param outArena Storage for the encoded tokens. It must hold at least
+                    the sum of `encodedSizeUpperBound` for every input.
+    @param outTokens Receives the encoded token for each input. The spans
+                     point into `outArena`, in input order.
+
+    @return the part of `outArena` holding all the encoded tokens.
+*/
+[[nodiscard]] Result<std::span<std::uint8_t>>
+encodeBase58TokenBatch(
+    TokenType token_type,
+    std::span<std::span<std::uint8_t const> const> inputs,
+    std::span<std::uint8_t> outArena,
+    std::span<std::span<std::uint8_t>> outTokens);
+
+/** Decode a batch of tokens
+
+    All the tokens are converted to base 256 first, then all the checksums
+    are verified in one pass, so the hashes don't wait on the conversions. A
+    token that fails to decode doesn't fail the batch; its status says why.
+
+    @param types The expected type of each token.
+    @param inputs The tokens to decode.
+    @param outArena Storage for the decoded tokens. It must hold at least
+                    the sum of `decodedSizeUpperBound` for every input.
+    @param outTokens Receives the decoded data for each input. The spans
+                     point into `outArena`, in input order. The span of a
+                     token that failed to decode is empty.
+    @param statuses Receives the result of decoding each input.
+
+    @return the part of `outArena` holding all the decoded tokens. Fails only
+            if the arguments are too small for the batch.
+*/
+[[nodiscard]] Result<std::span<std::uint8_t>>
+decodeBase58TokenBatch(
+    std::span<TokenType const> types,
+    std::span<std::string_view const> inputs,
+    std::span<std::uint8_t> outArena,
+    std::span<std::span<std::uint8_t>> outTokens,
+    std::span<TokenCodecErrc> statuses);
+
+/** Verify a batch of tokens that were decoded without their checksums
+
+    Decodes every token in full, with the checksum, and keeps only the
+    results: use it to audit tokens decoded with `decodeTrustedBase58Token`
+    or `decodeTrusted` off the hot path.
+
+    @param types The expected type of each token.
+    @param inputs The tokens to verify.
+    @param statuses Receives the result `decodeBase58Token` gives for each
+                    input.
+
+    @return the number of tokens that failed. Fails only if the arguments are
+            too small for the batch.
+*/
+[[nodiscard]] Result<std::size_t>
+verifyBase58TokenBatch(
+    std::span<TokenType const> types,
+    std::span<std::string_view const> inputs,
+    std::span<TokenCodecErrc> statuses);
+
+// This interface matches the old interface, but requires additional
+// allocation. `encodeBase58TokenInline` doesn't.
 [[nodiscard]] std::string
 encodeBase58Token(TokenType type, void const* token, std::size_t size);
 
-// This interface matches the old interface, but requires additional allocation
+// This interface matches the old interface, but requires additional
+// allocation. `decodeBase58TokenInline` doesn't.
 [[nodiscard]] std::string
 decodeBase58Token(std::string const& s, TokenType type);
 
+/** The old interface, with the result stored inline instead of allocated
+
+    Only for payloads of up to 33 bytes (all the token types); use
+    `encodeBase58Token` for larger ones.
+
+    @return the encoded token, or an empty string if it can't be encoded
+            (including if it doesn't fit in a `Base58String`).
+*/
+[[nodiscard]] Base58String
+encodeBase58TokenInline(TokenType type, void const* token, std::size_t size);
+
+/** The old interface, with the result stored inline instead of allocated
+
+    Only for tokens whose payload fits in a `Base58String`, which is every
+    token of up to 60 characters (all the token types); use
+    `decodeBase58Token` for longer ones.
+
+    @return the decoded token, or an empty string if it doesn't decode
+            (including if its payload is more than `Base58String::capacity`
+            bytes).
+*/
+[[nodiscard]] Base58String
+decodeBase58TokenInline(std::string_view s, TokenType type);
+
 }  // namespace b58_fast
 #endif
+
+namespace detail {
+
+// `parseBase58` at run time. Apart so `parseBase58` stays constexpr: it
+// declares a `Result`, which isn't a literal type.
+template <Base58Payload T>
+std::optional<T>
+parse_base58(TokenType type, std::string_view s)
+{
+    T result;
+    std::span<std::uint8_t, sizeof(T)> const out(
+        reinterpret_cast<std::uint8_t*>(&result), sizeof(T));
+#if defined(_MSC_VER) || defined(XRPL_B58_PORTABLE)
+    auto const decoded = b58_portable::decodeBase58Token(type, s, out);
+    if (!decoded || decoded.value().size() != sizeof(T))
+        return std::nullopt;
+#else
+    if (!b58_fast::detail::decode_token_fixed<fast_sha256_hasher>(type, s, out))
+        return std::nullopt;
+#endif
+    return result;
+}
+
+}  // namespace detail
+
+template <Base58Payload T>
+constexpr std::optional<T>
+parseBase58(TokenType type, std::string_view s)
+{
+    // Constant evaluation can't run the fast codecs (or reinterpret the
+    // bytes of `T`)
+    if (std::is_constant_evaluated())
+    {
+        auto const payload =
+            b58_portable::decodeBase58Token<sizeof(T)>(type, s);
+        if (!payload)
+            return std::nullopt;
+        return std::bit_cast<T>(*payload);
+    }
+    return detail::parse_base58<T>(type, s);
+}
+
+template <Base58Payload T>
+    requires(base58TokenType<T>.has_value())
+constexpr std::optional<T>
+parseBase58(std::string_view s)
+{
+    return parseBase58<T>(*base58TokenType<T>, s);
+}
+
 }  // namespace ripple
 
 #endif
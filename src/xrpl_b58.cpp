@@ -0,0 +1,307 @@
+// xrpl-b58: bulk encode, decode and validate of base 58 tokens
+//
+// The input is read in chunks of whole records, the chunks are converted on
+// a pool of threads with the batch codecs, and the results are written in
+// input order (see `convertBulk` in b58_bulk.h). A summary of the throughput
+// and the failures by error code is printed to stderr at exit.
+
+#include "b58_bulk.h"
+#include "token_errors.h"
+#include "tokens.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char usage[] =
+    R"(usage: xrpl-b58 <encode|decode|validate> [options] [input]
+
+Reads `input`, or stdin if it is missing or "-".
+
+  encode    payloads (raw or hex) to base 58 lines
+  decode    base 58 lines to payloads (hex lines or raw)
+  validate  base 58 lines; writes "<line>\t<error>" for every bad token
+
+options:
+  -t, --type TYPE       account (default), node-public, node-private,
+                        account-public, account-secret or seed
+  -i, --input-format F  raw or hex for encode (default raw); b58 otherwise
+  -f, --output-format F b58 for encode; hex (default) or raw for decode
+  -s, --stride N        payload size in bytes (default: the size of TYPE)
+  -j, --threads N       worker threads (default: number of cores)
+  -c, --chunk N         tokens per chunk (default 16384)
+  -o, --output PATH     output file (default stdout)
+
+Every payload must be `stride` bytes. A record that fails converts to an
+empty line (hex and b58 output) or `stride` zero bytes (raw output), so the
+output keeps one record per input record. Exits with 1 if any record failed
+and 2 on errors.
+)";
+
+using ripple::b58_fast::BulkCommand;
+using ripple::b58_fast::BulkFormat;
+using ripple::b58_fast::numTokenCodecErrc;
+
+struct Options
+{
+    ripple::b58_fast::BulkOptions bulk;
+    std::optional<BulkFormat> inFormat;
+    std::optional<BulkFormat> outFormat;
+    std::size_t stride = 0;
+    unsigned threads = 0;
+    std::string input = "-";
+    std::string output = "-";
+};
+
+[[noreturn]] void
+fatal(std::string_view what)
+{
+    std::fprintf(
+        stderr,
+        "xrpl-b58: %.*s\n",
+        static_cast<int>(what.size()),
+        what.data());
+    std::exit(2);
+}
+
+ripple::TokenType
+parse_type(std::string_view s)
+{
+    using ripple::TokenType;
+    if (s == "account")
+        return TokenType::AccountID;
+    if (s == "node-public")
+        return TokenType::NodePublic;
+    if (s == "node-private")
+        return TokenType::NodePrivate;
+    if (s == "account-public")
+        return TokenType::AccountPublic;
+    if (s == "account-secret")
+        return TokenType::AccountSecret;
+    if (s == "seed")
+        return TokenType::FamilySeed;
+    fatal("unknown token type " + std::string(s));
+}
+
+BulkFormat
+parse_format(std::string_view s)
+{
+    if (s == "raw")
+        return BulkFormat::raw;
+    if (s == "hex")
+        return BulkFormat::hex;
+    if (s == "b58")
+        return BulkFormat::b58;
+    fatal("unknown format " + std::string(s));
+}
+
+std::size_t
+parse_count(std::string_view s, std::string_view option)
+{
+    std::size_t n = 0;
+    auto const [end, ec] = std::from_chars(s.data(), s.data() + s.size(), n);
+    if (ec != std::errc() || end != s.data() + s.size() || n == 0)
+        fatal(std::string(option) + " needs a positive number");
+    return n;
+}
+
+Options
+parse_options(int argc, char** argv)
+{
+    if (argc < 2)
+        fatal(std::string("missing command\n\n") + usage);
+    Options o;
+    std::string_view const command = argv[1];
+    if (command == "encode")
+        o.bulk.command = BulkCommand::encode;
+    else if (command == "decode")
+        o.bulk.command = BulkCommand::decode;
+    else if (command == "validate")
+        o.bulk.command = BulkCommand::validate;
+    else if (command == "-h" || command == "--help")
+    {
+        std::fputs(usage, stdout);
+        std::exit(0);
+    }
+    else
+        fatal("unknown command " + std::string(command) + "\n\n" + usage);
+
+    bool haveInput = false;
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string_view const arg = argv[i];
+        auto value = [&]() -> std::string_view {
+            if (i + 1 >= argc)
+                fatal(std::string(arg) + " needs a value");
+            return argv[++i];
+        };
+        if (arg == "-t" || arg == "--type")
+            o.bulk.type = parse_type(value());
+        else if (arg == "-i" || arg == "--input-format")
+            o.inFormat = parse_format(value());
+        else if (arg == "-f" || arg == "--output-format")
+            o.outFormat = parse_format(value());
+        else if (arg == "-s" || arg == "--stride")
+            o.stride = parse_count(value(), arg);
+        else if (arg == "-j" || arg == "--threads")
+            o.threads = parse_count(value(), arg);
+        else if (arg == "-c" || arg == "--chunk")
+            o.bulk.chunkTokens = parse_count(value(), arg);
+        else if (arg == "-o" || arg == "--output")
+            o.output = value();
+        else if (arg.size() > 1 && arg[0] == '-')
+            fatal("unknown option " + std::string(arg) + "\n\n" + usage);
+        else if (!std::exchange(haveInput, true))
+            o.input = arg;
+        else
+            fatal("more than one input");
+    }
+
+    bool const encode = o.bulk.command == BulkCommand::encode;
+    if (!o.inFormat)
+        o.inFormat = encode ? BulkFormat::raw : BulkFormat::b58;
+    if (!o.outFormat)
+        o.outFormat = encode ? BulkFormat::b58 : BulkFormat::hex;
+    if (encode
+            ? *o.inFormat == BulkFormat::b58 || *o.outFormat != BulkFormat::b58
+            : *o.inFormat != BulkFormat::b58 || *o.outFormat == BulkFormat::b58)
+        fatal("the formats don't fit the command");
+    o.bulk.inFormat = *o.inFormat;
+    o.bulk.outFormat = *o.outFormat;
+    o.bulk.stride = o.stride
+        ? o.stride
+        : ripple::b58_fast::tokenPayloadSize(o.bulk.type);
+    if (o.bulk.stride > 33)
+        fatal("payloads are at most 33 bytes");
+    if (!o.threads)
+        o.threads = std::max(1u, std::thread::hardware_concurrency());
+    return o;
+}
+
+std::error_code
+last_error()
+{
+    return {errno, std::generic_category()};
+}
+
+// Read up to `size` bytes; fewer only at the end of the input
+std::size_t
+read_full(int fd, char* data, std::size_t size)
+{
+    std::size_t done = 0;
+    while (done < size)
+    {
+        auto const n = ::read(fd, data + done, size - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            fatal("read: " + last_error().message());
+        if (n == 0)
+            break;
+        done += n;
+    }
+    return done;
+}
+
+void
+write_full(int fd, std::string_view data)
+{
+    while (!data.empty())
+    {
+        auto const n = ::write(fd, data.data(), data.size());
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            fatal("write: " + last_error().message());
+        data.remove_prefix(n);
+    }
+}
+
+}  // namespace
+
+int
+main(int argc, char** argv)
+{
+    auto const o = parse_options(argc, argv);
+    auto const start = std::chrono::steady_clock::now();
+
+    int const in = o.input == "-" ? STDIN_FILENO
+                                  : ::open(o.input.c_str(), O_RDONLY);
+    if (in < 0)
+        fatal(o.input + ": " + last_error().message());
+    int const out = o.output == "-"
+        ? STDOUT_FILENO
+        : ::open(o.output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0)
+        fatal(o.output + ": " + last_error().message());
+
+    ripple::b58_fast::BulkChunkReader reader(
+        [in](char* data, std::size_t size) {
+            return read_full(in, data, size);
+        },
+        o.bulk);
+    std::uint64_t bytesIn = 0;
+    std::uint64_t records = 0;
+    std::array<std::uint64_t, numTokenCodecErrc> failures{};
+    auto const r = ripple::b58_fast::convertBulk(
+        reader,
+        o.bulk,
+        o.threads,
+        [&](ripple::b58_fast::BulkChunkResult const& result) {
+            write_full(out, result.out);
+            bytesIn += result.bytesIn;
+            records += result.records;
+            for (std::size_t e = 0; e < numTokenCodecErrc; ++e)
+                failures[e] += result.failures[e];
+        });
+    if (!r && r.error() == TokenCodecErrc::InputTooSmall)
+        fatal("the input ends in a partial record");
+    if (!r)
+        fatal("convert: " + r.error().message());
+    if (out != STDOUT_FILENO && ::close(out) != 0)
+        fatal(o.output + ": " + last_error().message());
+
+    double const seconds = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+    std::uint64_t failed = 0;
+    for (auto f : failures)
+        failed += f;
+    std::fprintf(
+        stderr,
+        "xrpl-b58: %llu records, %llu failed, %.3f s, %.0f records/s, "
+        "%.1f MB/s in, %u threads\n",
+        static_cast<unsigned long long>(records),
+        static_cast<unsigned long long>(failed),
+        seconds,
+        seconds > 0 ? records / seconds : 0.0,
+        seconds > 0 ? bytesIn / seconds / 1e6 : 0.0,
+        o.threads);
+    for (std::size_t e = 0; e < numTokenCodecErrc; ++e)
+    {
+        if (!failures[e])
+            continue;
+        std::fprintf(
+            stderr,
+            "  %s: %llu\n",
+            make_error_code(static_cast<TokenCodecErrc>(e)).message().c_str(),
+            static_cast<unsigned long long>(failures[e]));
+    }
+    return failed ? 1 : 0;
+}